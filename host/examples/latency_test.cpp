@@ -22,9 +22,26 @@
 #include <boost/format.hpp>
 #include <iostream>
 #include <complex>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 namespace po = boost::program_options;
 
+/***********************************************************************
+ * Print the min, mean, 99th percentile, and max of the times
+ * (in microseconds), relative to the minimum when requested
+ **********************************************************************/
+static void print_times(const std::string &name, std::vector<double> times, const bool relative){
+    if (times.empty()) return;
+    std::sort(times.begin(), times.end());
+    const double base = relative? times.front() : 0.0;
+    const double mean = std::accumulate(times.begin(), times.end(), 0.0)/times.size();
+    std::cout << boost::format("%s (us): min %.1f, mean %.1f, 99%% %.1f, max %.1f")
+        % name % (times.front() - base) % (mean - base)
+        % (times[(times.size() - 1)*99/100] - base) % (times.back() - base) << std::endl;
+}
+
 int UHD_SAFE_MAIN(int argc, char *argv[]){
     uhd::set_thread_priority_safe();
 
@@ -58,6 +75,12 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         "    and tries to send a packet at time t + rtt,\n"
         "    where rtt is the round trip time sample time\n"
         "    from device to host and back to the device.\n"
+        "\n"
+        "    The summary shows how long recv() takes to return after\n"
+        "    the last sample arrived (relative to the fastest run), and the\n"
+        "    time from the return of recv() to the return of send().\n"
+        "    Compare runs with different transport args, ex:\n"
+        "    --args \"addr=192.168.10.2,recv_spin_us=50\"\n"
         << std::endl;
         return ~0;
     }
@@ -94,6 +117,10 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
     int underflow = 0;
     int other = 0;
 
+    //host timing of the runs in microseconds
+    const double rx_rate = usrp->get_rx_rate();
+    std::vector<double> recv_latencies, turnarounds;
+
     for(size_t nrun = 0; nrun < nruns; nrun++){
 
         /***************************************************************
@@ -112,6 +139,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         size_t num_rx_samps = rx_stream->recv(
             &buffer.front(), buffer.size(), rx_md
         );
+        const uhd::time_spec_t recv_time = uhd::time_spec_t::get_system_time();
 
         if(verbose) std::cout << boost::format("Got packet: %u samples, %u full secs, %f frac secs")
             % num_rx_samps % rx_md.time_spec.get_full_secs() % rx_md.time_spec.get_frac_secs() << std::endl;
@@ -129,6 +157,14 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
         );
         if(verbose) std::cout << boost::format("Sent %d samples") % num_tx_samps << std::endl;
 
+        //the device time of the last sample is compared to the host time,
+        //the clocks have a constant offset, so only the variation is meaningful
+        if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE and num_rx_samps != 0){
+            const uhd::time_spec_t last_sample_time = rx_md.time_spec + uhd::time_spec_t(num_rx_samps/rx_rate);
+            recv_latencies.push_back((recv_time - last_sample_time).get_real_secs()*1e6);
+            turnarounds.push_back((uhd::time_spec_t::get_system_time() - recv_time).get_real_secs()*1e6);
+        }
+
         /***************************************************************
          * Check the async messages for result
          **************************************************************/
@@ -164,5 +200,7 @@ int UHD_SAFE_MAIN(int argc, char *argv[]){
      **************************************************************/
     std::cout << boost::format("\nACK %d, UNDERFLOW %d, TIME_ERR %d, other %d")
         % ack % underflow % time_error % other << std::endl;
+    print_times("Receive latency", recv_latencies, true);
+    print_times("Turnaround", turnarounds, false);
     return EXIT_SUCCESS;
 }
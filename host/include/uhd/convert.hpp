@@ -20,10 +20,13 @@
 
 #include <uhd/config.hpp>
 #include <uhd/types/ref_vector.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
 #include <boost/operators.hpp>
+#include <complex>
 #include <string>
+#include <vector>
 
 namespace uhd{ namespace convert{
 
@@ -56,12 +59,67 @@ namespace uhd{ namespace convert{
         virtual void operator()(const input_type& in, const output_type& out, const size_t num) = 0;
     };
 
+    /*!
+     * An IQ imbalance and DC offset correction of complex samples,
+     * in normalized units (1.0 is full scale):
+     * out = matrix*in + offset, where in and out are [I, Q] vectors.
+     */
+    struct UHD_API correction_type{
+        //! The 2x2 correction matrix, row major
+        double matrix[4];
+
+        //! The complex offset, added after the matrix
+        std::complex<double> offset;
+
+        //! Make a correction that leaves the samples unchanged
+        correction_type(void);
+
+        //! Is this the correction that leaves the samples unchanged?
+        bool is_identity(void) const;
+
+        /*!
+         * Make the correction of one channel from stream args:
+         * - iq_matrix=a:b:c:d sets the matrix
+         * - dc_offset=i:q sets the offset
+         * A key with the channel index appended (ex: dc_offset1)
+         * overrides the key without it for that channel.
+         * \param args the stream args
+         * \param chan the channel index within the streamer
+         * \return the correction
+         * \throw uhd::value_error if a value can not be parsed
+         */
+        static correction_type from_args(const device_addr_t &args, const size_t chan);
+    };
+
+    //! A converter that applies a correction_type during the conversion
+    class correcting_converter : public converter{
+    public:
+        typedef boost::shared_ptr<correcting_converter> sptr;
+
+        //! Set the correction, with the samples in normalized units
+        virtual void set_correction(const correction_type &correction) = 0;
+    };
+
     //! Conversion factory function typedef
     typedef boost::function<converter::sptr(void)> function_type;
 
     //! Priority of conversion routines
     typedef int priority_type;
 
+    /*!
+     * Priority of converters that write their output with non-temporal
+     * (streaming) stores, so that large outputs bypass the cache.
+     * They are never chosen as the best converter; request them by
+     * passing this priority to get_converter().
+     */
+    static const priority_type PRIORITY_NON_TEMPORAL = -2;
+
+    /*!
+     * Priority of the correcting_converter implementations.
+     * Like the non-temporal converters, they must be requested explicitly.
+     */
+    static const priority_type PRIORITY_CORRECTION = -3;
+
     //! Identify a conversion routine in the registry
     struct UHD_API id_type : boost::equality_comparable<id_type>{
         std::string input_format;
@@ -101,6 +159,35 @@ namespace uhd{ namespace convert{
         const priority_type prio = -1
     );
 
+    /*!
+     * Get the IDs of all registered converters.
+     * \return a list of conversion IDs
+     */
+    UHD_API std::vector<id_type> get_converter_ids(void);
+
+    /*!
+     * Get the priorities registered for a conversion ID.
+     * \param id identify the conversion
+     * \return a list of priorities
+     * \throw uhd::key_error if no converter is registered for id
+     */
+    UHD_API std::vector<priority_type> get_converter_priorities(
+        const id_type &id
+    );
+
+    /*!
+     * Make the correcting converters for a streamer with the corrections
+     * in its stream args (see correction_type::from_args).
+     * \param id identify the conversion
+     * \param args the stream args
+     * \param nchan the number of channels of the streamer
+     * \return one converter per channel, none if there are no corrections
+     * \throw uhd::value_error if the conversion has no correcting converter
+     */
+    UHD_API std::vector<converter::sptr> make_correcting_converters(
+        const id_type &id, const device_addr_t &args, const size_t nchan
+    );
+
     /*!
      * Register the size of a particular item.
      * \param format the item format
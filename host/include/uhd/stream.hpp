@@ -130,6 +130,12 @@ struct UHD_API stream_args_t{
      *
      * - noclear: Used by tx_dsp_core_200 and rx_dsp_core_200
      *
+     * - nt_stores, nt_stores_nsamps: control when the RX streamer writes
+     * the samples with non-temporal stores (see \ref converters_accel_nt).
+     *
+     * - iq_matrix, dc_offset: an IQ and DC correction that is applied
+     * during the conversion (see \ref converters_accel_correction).
+     *
      * The following are not implemented, but are listed for conceptual purposes:
      * - function: magnitude or phase/magnitude
      * - units: numeric units like counts or dBm
@@ -174,6 +180,35 @@ struct UHD_API stream_args_t{
     std::vector<size_t> channels;
 };
 
+/*!
+ * Samples lent out of the transport by rx_streamer::recv_zero_copy():
+ * The payload of one packet per channel, without copy or conversion.
+ * The samples are in the over-the-wire format of the streamer,
+ * for sc16 these are item32 words in the byte order of the link.
+ *
+ * The transport frames go back to the transport on release()
+ * or when the last reference is dropped. The transport has a limited
+ * number of frames, holding on to many of them will stall the stream.
+ */
+class UHD_API rx_zero_copy_buffs : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_zero_copy_buffs> sptr;
+
+    virtual ~rx_zero_copy_buffs(void);
+
+    //! Get the number of channels (one payload per channel)
+    virtual size_t get_num_channels(void) const = 0;
+
+    //! Get the number of samples per channel
+    virtual size_t get_num_samps(void) const = 0;
+
+    //! Get the payload of a channel, invalid after release()
+    virtual const void *get(const size_t chan) const = 0;
+
+    //! Give the frames back to the transport
+    virtual void release(void) = 0;
+};
+
 /*!
  * The RX streamer is the host interface to receiving samples.
  * It represents the layer between the samples on the host
@@ -191,6 +226,24 @@ public:
     //! Get the max number of samples per buffer per packet
     virtual size_t get_max_num_samps(void) const = 0;
 
+    /*!
+     * Get the size of a sample in the CPU format of this streamer.
+     * \return the number of bytes per sample, or 0 when not known
+     */
+    virtual size_t get_cpu_item_size(void) const;
+
+    /*!
+     * Get the packets discarded on a channel to align the channels.
+     * The count covers the last call to recv() or recv_zero_copy(),
+     * over all the packets that call received.
+     * The counts are not part of rx_metadata_t, which keeps its layout
+     * and stays cheap to copy: read them after each receive call,
+     * the next call starts them over.
+     * \param chan the channel index 0 to num channels - 1
+     * \return the number of packets, 0 when nothing was discarded
+     */
+    virtual size_t get_alignment_drops(const size_t chan) const;
+
     //! Typedef for a pointer to a single, or a collection of recv buffers
     typedef ref_vector<void *> buffs_type;
 
@@ -217,6 +270,9 @@ public:
      * the call will return after a single packet has been processed.
      * This may be useful to maintain packet boundaries in some cases.
      *
+     * Packets thrown out to align the channels are not reported
+     * in the metadata, see get_alignment_drops().
+     *
      * \param buffs a vector of writable memory to fill with samples
      * \param nsamps_per_buff the size of each buffer in number of samples
      * \param metadata data to fill describing the buffer
@@ -232,6 +288,29 @@ public:
         const bool one_packet = false
     ) = 0;
 
+    /*!
+     * Receive a packet per channel without copying the samples.
+     *
+     * Instead of converting the samples into user buffers,
+     * the payloads are lent out of the transport frames.
+     * The metadata is filled in the same way as recv() with one_packet.
+     * When the previous recv() left a fragment of a packet,
+     * the remainder of that packet is returned.
+     *
+     * The samples stay in the over-the-wire format, conversion
+     * options like scaling or the IQ and DC correction do not apply.
+     *
+     * \param metadata data to fill describing the buffers
+     * \param timeout the timeout in seconds to wait for a packet
+     * \return the lent buffers or a null pointer on error
+     * \throws uhd::not_implemented_error when the streamer cannot lend buffers,
+     * as when several channels share the packets of one stream (USRP1)
+     */
+    virtual rx_zero_copy_buffs::sptr recv_zero_copy(
+        rx_metadata_t &metadata,
+        const double timeout = 0.1
+    );
+
     /*!
      * Issue a stream command to the usrp device.
      * This tells the usrp to send samples into the host.
@@ -246,6 +325,29 @@ public:
     virtual void issue_stream_cmd(const stream_cmd_t &stream_cmd) = 0;
 };
 
+/*!
+ * Send buffers lent by tx_streamer::acquire_send_buffs():
+ * The payload region of one packet per channel,
+ * to be filled in the over-the-wire format of the streamer.
+ * The buffers are valid until they are committed with
+ * tx_streamer::commit_send_buffs() or until the next send().
+ */
+class UHD_API tx_zero_copy_buffs : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<tx_zero_copy_buffs> sptr;
+
+    virtual ~tx_zero_copy_buffs(void);
+
+    //! Get the number of channels (one payload per channel)
+    virtual size_t get_num_channels(void) const = 0;
+
+    //! Get the number of samples that fit per channel
+    virtual size_t get_num_samps(void) const = 0;
+
+    //! Get the payload of a channel to write into
+    virtual void *get(const size_t chan) const = 0;
+};
+
 /*!
  * The TX streamer is the host interface to transmitting samples.
  * It represents the layer between the samples on the host
@@ -303,6 +405,44 @@ public:
     virtual bool recv_async_msg(
         async_metadata_t &async_metadata, double timeout = 0.1
     ) = 0;
+
+    /*!
+     * Acquire send buffers to write samples in place.
+     *
+     * The application writes the samples of one packet per channel
+     * into the lent payloads, in the over-the-wire format,
+     * and sends them with commit_send_buffs().
+     * Conversion options like scaling or the IQ and DC correction do not apply.
+     * Acquiring again without a commit returns the same buffers.
+     *
+     * \param timeout the timeout in seconds to wait for the buffers
+     * \return the lent buffers or a null pointer on timeout
+     * \throws uhd::not_implemented_error when the streamer cannot lend buffers
+     */
+    virtual tx_zero_copy_buffs::sptr acquire_send_buffs(
+        const double timeout = 0.1
+    );
+
+    /*!
+     * Send the acquired buffers as one packet per channel.
+     *
+     * The packet header is filled in from the metadata.
+     * A packet with a time spec has a longer header than the lent
+     * payload was laid out for, the payload is moved to make room.
+     * Like send(), a start of burst without samples is held and applied
+     * to the next commit with samples; the buffers stay lent for it.
+     *
+     * \param buffs the buffers from acquire_send_buffs()
+     * \param nsamps_per_buff the number of samples written per buffer
+     * \param metadata data describing the buffers' contents
+     * \return the number of samples sent
+     * \throws uhd::not_implemented_error when the streamer cannot lend buffers
+     */
+    virtual size_t commit_send_buffs(
+        const tx_zero_copy_buffs::sptr &buffs,
+        const size_t nsamps_per_buff,
+        const tx_metadata_t &metadata
+    );
 };
 
 } //namespace uhd
@@ -0,0 +1,127 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_STREAM_PUMP_HPP
+#define INCLUDED_UHD_STREAM_PUMP_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/stream.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/ref_vector.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{
+
+/*!
+ * The RX stream pump receives on its own thread and pushes
+ * the samples into sinks that the application registers.
+ *
+ * The pump calls recv() on the streamer in batches of a
+ * configurable number of samples, converted into the CPU format,
+ * and hands every batch to all sinks in turn. The sinks share the
+ * same buffers, which are valid for the duration of the call.
+ * Errors like overflows are passed on to the sinks with the metadata,
+ * timeouts are not.
+ *
+ * A sink that cannot keep up returns SINK_BUSY: the pump offers the
+ * batch again later and holds the stream in the meantime, so the
+ * back-pressure reaches the transport and eventually the device,
+ * which then reports an overflow.
+ *
+ * While the pump runs, the application must not call recv() on the
+ * streamer. Stream commands are issued on the streamer as usual.
+ */
+class UHD_API rx_stream_pump : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<rx_stream_pump> sptr;
+
+    //! What a sink tells the pump after a batch
+    enum sink_result_t{
+        //! The sink is done with the batch
+        SINK_CONSUMED = 0,
+        //! The sink cannot take the batch now, offer it again
+        SINK_BUSY = 1,
+        //! The sink is done with the batch and takes no more
+        SINK_DETACH = 2
+    };
+
+    //! Typedef for the per channel buffers of a batch
+    typedef ref_vector<const void *> buffs_type;
+
+    /*!
+     * The sink callback is called on the pump thread.
+     * \param buffs the samples of each channel
+     * \param nsamps_per_buff the number of samples per buffer
+     * \param metadata the metadata of the first sample
+     * \return the sink result
+     */
+    typedef boost::function<sink_result_t(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const rx_metadata_t &metadata
+    )> sink_type;
+
+    virtual ~rx_stream_pump(void);
+
+    /*!
+     * Make a new stream pump for an RX streamer.
+     * The pump is created stopped.
+     *
+     * The stream args are the args that made the streamer.
+     * The pump uses the CPU format, which must have the sample size
+     * of the streamer (see rx_streamer::get_cpu_item_size()),
+     * and the following args:
+     * - pump_batch_nsamps: samples per channel in a batch (default: max samples per packet)
+     * - pump_recv_timeout: timeout of a recv() on the pump thread (default: 0.1 seconds)
+     * - pump_busy_retry_us: wait before a busy sink is offered the batch again (default: 100)
+     *
+     * \param rx_stream the streamer to pump
+     * \param args the stream args of the streamer
+     * \return a new stream pump
+     * \throws uhd::value_error when the CPU format does not match the streamer
+     */
+    static sptr make(rx_streamer::sptr rx_stream, const stream_args_t &args);
+
+    /*!
+     * Register a sink, it gets the batches from the next one on.
+     * \param sink the sink callback
+     * \return an id to remove the sink
+     */
+    virtual size_t add_sink(const sink_type &sink) = 0;
+
+    /*!
+     * Remove a sink, it is not called after this returns.
+     * Must not be called from a sink, return SINK_DETACH instead.
+     * \param sink_id the id from add_sink()
+     */
+    virtual void remove_sink(const size_t sink_id) = 0;
+
+    //! Start the pump thread
+    virtual void start(void) = 0;
+
+    //! Stop the pump thread, no sink is called after this returns
+    virtual void stop(void) = 0;
+
+    //! Get the number of times a busy sink held the stream
+    virtual size_t get_num_stalls(void) const = 0;
+};
+
+} //namespace uhd
+
+#endif /* INCLUDED_UHD_STREAM_PUMP_HPP */
@@ -0,0 +1,80 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_UHD_TRANSPORT_AF_PACKET_ZERO_COPY_HPP
+#define INCLUDED_UHD_TRANSPORT_AF_PACKET_ZERO_COPY_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * A zero copy transport for UDP traffic on top of memory mapped packet rings.
+ *
+ * Received frames are not copied out of the kernel: the transport reads
+ * the datagrams from a TPACKET_V3 receive ring of an AF_PACKET socket,
+ * and the managed receive buffers point directly at the UDP payload in the
+ * ring. Send buffers are frames of a TX_RING, the transport writes the IP
+ * and UDP headers in front of the payload when the buffer is committed.
+ *
+ * The endpoint must be on a directly connected network,
+ * and the process needs the CAP_NET_RAW capability (Linux only).
+ */
+class UHD_API af_packet_zero_copy : public virtual zero_copy_if{
+public:
+    typedef boost::shared_ptr<af_packet_zero_copy> sptr;
+
+    /*!
+     * Make a new zero copy packet ring transport:
+     * This transport is for sending and receiving
+     * between this host and a single endpoint.
+     * The primary usage for this transport will be data transactions.
+     *
+     * The address will be resolved, it can be a host name or ipv4.
+     * The port will be resolved, it can be a port type or number.
+     *
+     * \param addr a string representing the destination address
+     * \param port a string representing the destination port
+     * \param default_buff_args Default values for frame sizes and num frames
+     * \param[out] buff_params_out Returns the actual ring sizes
+     * \param hints optional parameters to pass to the underlying transport
+     * \throws uhd::not_implemented_error when not supported on this platform
+     */
+    static sptr make(
+        const std::string &addr,
+        const std::string &port,
+        const zero_copy_xport_params &default_buff_args,
+        udp_zero_copy::buff_params& buff_params_out,
+        const device_addr_t &hints = device_addr_t()
+    );
+
+    /*!
+     * Get the local UDP port of this transport.
+     * The endpoint sends its frames to this port.
+     * \return the port number in host byte order
+     */
+    virtual boost::uint16_t get_local_port(void) const = 0;
+};
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_AF_PACKET_ZERO_COPY_HPP */
@@ -19,6 +19,7 @@
 #define INCLUDED_UHD_TRANSPORT_BUFFER_POOL_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/device_addr.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -48,6 +49,28 @@ namespace uhd{ namespace transport{
             const size_t alignment = 16
         );
 
+        /*!
+         * Make a new buffer pool with an allocation policy.
+         * The policy comes from the hints (linux only):
+         *  - buff_hugepages: back the pool with huge pages,
+         *    1 or 2M for 2 MB pages, 1G for 1 GB pages
+         *  - buff_numa_node: bind the pool memory to this NUMA node
+         *  - buff_mlock: lock the pool memory into RAM
+         * When a policy cannot be applied, the pool is still
+         * allocated without it and a warning is printed.
+         * \param num_buffs the number of buffers to allocate
+         * \param buff_size the size of each buffer in bytes
+         * \param hints the transport hints with the allocation policy
+         * \param alignment the alignment boundary in bytes
+         * \return a new buffer pool buff_size X num_buffs
+         */
+        static sptr make(
+            const size_t num_buffs,
+            const size_t buff_size,
+            const device_addr_t &hints,
+            const size_t alignment = 16
+        );
+
         //! Get a pointer to the buffer start at the specified index
         virtual ptr_type at(const size_t index) const = 0;
 
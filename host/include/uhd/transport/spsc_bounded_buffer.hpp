@@ -0,0 +1,112 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_HPP
+#define INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_HPP
+
+#include <uhd/transport/spsc_bounded_buffer.ipp> //detail
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * Implement a templated lock-free bounded buffer:
+     * Used for passing elements from exactly one producer thread
+     * to exactly one consumer thread, with the same interface as bounded_buffer.
+     * Pushes and pops do not take a lock; a thread only blocks (on a futex
+     * on linux, a condition variable elsewhere) when the buffer is empty
+     * for a pop or full for a push, and the other side only makes a system call
+     * to wake it up when a thread is actually blocked.
+     * Callers that push or pop from more than one thread must use bounded_buffer.
+     */
+    template <typename elem_type> class spsc_bounded_buffer{
+    public:
+
+        /*!
+         * Create a new single producer, single consumer bounded buffer object.
+         * \param capacity the spsc_bounded_buffer capacity
+         */
+        spsc_bounded_buffer(size_t capacity):
+            _detail(capacity)
+        {
+            /* NOP */
+        }
+
+        /*!
+         * Push a new element into the bounded buffer immediately.
+         * The element will not be pushed when the buffer is full.
+         * \param elem the new element to push
+         * \return false when the buffer is full
+         */
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            return _detail.push_with_haste(elem);
+        }
+
+        /*!
+         * Push a new element into the spsc_bounded_buffer.
+         * Wait until the spsc_bounded_buffer becomes non-full.
+         * \param elem the new element to push
+         */
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            return _detail.push_with_wait(elem);
+        }
+
+        /*!
+         * Push a new element into the spsc_bounded_buffer.
+         * Wait until the spsc_bounded_buffer becomes non-full or timeout.
+         * \param elem the new element to push
+         * \param timeout the timeout in seconds
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            return _detail.push_with_timed_wait(elem, timeout);
+        }
+
+        /*!
+         * Pop an element from the bounded buffer immediately.
+         * The element will not be popped when the buffer is empty.
+         * \param elem the element reference pop to
+         * \return false when the buffer is empty
+         */
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            return _detail.pop_with_haste(elem);
+        }
+
+        /*!
+         * Pop an element from the spsc_bounded_buffer.
+         * Wait until the spsc_bounded_buffer becomes non-empty.
+         * \param elem the element reference pop to
+         */
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            return _detail.pop_with_wait(elem);
+        }
+
+        /*!
+         * Pop an element from the spsc_bounded_buffer.
+         * Wait until the spsc_bounded_buffer becomes non-empty or timeout.
+         * \param elem the element reference pop to
+         * \param timeout the timeout in seconds
+         * \return false when the operation times out
+         */
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            return _detail.pop_with_timed_wait(elem, timeout);
+        }
+
+    private: spsc_bounded_buffer_detail<elem_type> _detail;
+    };
+
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_HPP */
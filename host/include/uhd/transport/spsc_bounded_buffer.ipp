@@ -0,0 +1,201 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_IPP
+#define INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_IPP
+
+#include <uhd/config.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <vector>
+
+#ifdef __linux__
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <ctime>
+#else
+#  include <boost/thread/mutex.hpp>
+#  include <boost/thread/condition_variable.hpp>
+#endif
+
+namespace uhd{ namespace transport{
+
+    template <typename elem_type> class spsc_bounded_buffer_detail : boost::noncopyable{
+    public:
+
+        spsc_bounded_buffer_detail(size_t capacity):
+            _capacity(boost::uint32_t(capacity)),
+            _mask(boost::uint32_t(round_up_pow2(capacity) - 1)),
+            _buffer(_mask + 1),
+            _head(0), _head_waiting(0),
+            _tail(0), _tail_waiting(0)
+        {
+            UHD_ASSERT_THROW(capacity > 0 and capacity <= (size_t(1) << 30));
+        }
+
+        UHD_INLINE bool push_with_haste(const elem_type &elem){
+            const boost::uint32_t head = _head;
+            if (head - BOOST_IPC_DETAIL::atomic_read32(&_tail) >= _capacity) return false;
+            _buffer[head & _mask] = elem;
+            this->publish(_head, _head_waiting);
+            return true;
+        }
+
+        UHD_INLINE void push_with_wait(const elem_type &elem){
+            while (not this->push_with_haste(elem)){
+                this->wait_for_change(_tail, _tail_waiting, _head - _capacity, -1.0);
+            }
+        }
+
+        UHD_INLINE bool push_with_timed_wait(const elem_type &elem, double timeout){
+            if (this->push_with_haste(elem)) return true;
+            const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+            do{
+                const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+                if (not this->wait_for_change(_tail, _tail_waiting, _head - _capacity, std::max(remaining, 0.0))){
+                    return false;
+                }
+            } while (not this->push_with_haste(elem));
+            return true;
+        }
+
+        UHD_INLINE bool pop_with_haste(elem_type &elem){
+            const boost::uint32_t tail = _tail;
+            if (BOOST_IPC_DETAIL::atomic_read32(&_head) == tail) return false;
+            elem = _buffer[tail & _mask];
+            _buffer[tail & _mask] = elem_type();
+            this->publish(_tail, _tail_waiting);
+            return true;
+        }
+
+        UHD_INLINE void pop_with_wait(elem_type &elem){
+            while (not this->pop_with_haste(elem)){
+                this->wait_for_change(_head, _head_waiting, _tail, -1.0);
+            }
+        }
+
+        UHD_INLINE bool pop_with_timed_wait(elem_type &elem, double timeout){
+            if (this->pop_with_haste(elem)) return true;
+            const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+            do{
+                const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+                if (not this->wait_for_change(_head, _head_waiting, _tail, std::max(remaining, 0.0))){
+                    return false;
+                }
+            } while (not this->pop_with_haste(elem));
+            return true;
+        }
+
+    private:
+        static size_t round_up_pow2(const size_t n){
+            size_t pow2 = 1;
+            while (pow2 < n) pow2 <<= 1;
+            return pow2;
+        }
+
+        /*!
+         * Advance a counter owned by the calling side.
+         * The atomic increment is a full barrier: the element is visible
+         * before the counter, and the counter before the waiter check,
+         * so that a waiter either sees the new count or gets woken up.
+         * Only the first push or pop after a waiter went to sleep wakes it up.
+         */
+        UHD_INLINE void publish(volatile boost::uint32_t &count, volatile boost::uint32_t &waiting){
+            BOOST_IPC_DETAIL::atomic_inc32(&count);
+            if (BOOST_IPC_DETAIL::atomic_read32(&waiting) != 0
+                and BOOST_IPC_DETAIL::atomic_cas32(&waiting, 0, 1) == 1
+            ) this->wake(count);
+        }
+
+        /*!
+         * Block until the counter owned by the other side is not value.
+         * A negative timeout waits forever.
+         * The wait is sliced so that the thread remains interruptible.
+         * \return false when the operation times out
+         */
+        bool wait_for_change(
+            volatile boost::uint32_t &count, volatile boost::uint32_t &waiting,
+            const boost::uint32_t value, const double timeout
+        ){
+            static const double max_slice = 0.1;
+            const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+            bool changed = true;
+            while (true){
+                //set the flag (a full barrier) before the last look at the count
+                BOOST_IPC_DETAIL::atomic_cas32(&waiting, 1, 0);
+                if (BOOST_IPC_DETAIL::atomic_read32(&count) != value) break;
+                double slice = max_slice;
+                if (timeout >= 0.0){
+                    slice = std::min(slice, (exit_time - time_spec_t::get_system_time()).get_real_secs());
+                    if (slice <= 0.0){
+                        changed = false;
+                        break;
+                    }
+                }
+                this->sleep(count, value, slice);
+                boost::this_thread::interruption_point();
+            }
+            BOOST_IPC_DETAIL::atomic_write32(&waiting, 0);
+            return changed;
+        }
+
+#ifdef __linux__
+        //the futex returns immediately when the count is no longer value
+        UHD_INLINE void sleep(volatile boost::uint32_t &count, const boost::uint32_t value, const double timeout){
+            timespec ts;
+            ts.tv_sec = time_t(timeout);
+            ts.tv_nsec = long((timeout - ts.tv_sec)*1e9);
+            ::syscall(SYS_futex, const_cast<boost::uint32_t *>(&count), FUTEX_WAIT_PRIVATE, value, &ts, NULL, 0);
+        }
+
+        UHD_INLINE void wake(volatile boost::uint32_t &count){
+            ::syscall(SYS_futex, const_cast<boost::uint32_t *>(&count), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+#else
+        boost::mutex _mutex;
+        boost::condition_variable _cond;
+
+        UHD_INLINE void sleep(volatile boost::uint32_t &count, const boost::uint32_t value, const double timeout){
+            boost::mutex::scoped_lock lock(_mutex);
+            if (BOOST_IPC_DETAIL::atomic_read32(&count) != value) return;
+            _cond.timed_wait(lock, boost::posix_time::microseconds(long(timeout*1e6)));
+        }
+
+        UHD_INLINE void wake(volatile boost::uint32_t &){
+            boost::mutex::scoped_lock lock(_mutex);
+            lock.unlock();
+            _cond.notify_all();
+        }
+#endif
+
+        const boost::uint32_t _capacity, _mask;
+        std::vector<elem_type> _buffer;
+
+        //the producer and consumer counters live on separate cache lines
+        char _pad0[64];
+        volatile boost::uint32_t _head, _head_waiting;
+        char _pad1[64];
+        volatile boost::uint32_t _tail, _tail_waiting;
+        char _pad2[64];
+    };
+}} //namespace
+
+#endif /* INCLUDED_UHD_TRANSPORT_SPSC_BOUNDED_BUFFER_IPP */
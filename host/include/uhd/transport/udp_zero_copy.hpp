@@ -67,6 +67,15 @@ public:
         udp_zero_copy::buff_params& buff_params_out,
         const device_addr_t &hints = device_addr_t()
     );
+
+    /*!
+     * Send all committed send buffers that are still queued.
+     * Committed buffers are queued when the transport sends
+     * in batches (see the send_batch hint), else this is a NOP.
+     */
+    virtual void flush_send_buffs(void){
+        /* NOP */
+    }
 };
 
 }} //namespace
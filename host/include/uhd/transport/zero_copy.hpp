@@ -19,10 +19,12 @@
 #define INCLUDED_UHD_TRANSPORT_ZERO_COPY_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/intrusive_ptr.hpp>
 #include <boost/detail/atomic_count.hpp>
+#include <boost/cstdint.hpp>
 
 namespace uhd{ namespace transport{
 
@@ -122,6 +124,50 @@ namespace uhd{ namespace transport{
     class UHD_API managed_recv_buffer : public managed_buffer{
     public:
         typedef boost::intrusive_ptr<managed_recv_buffer> sptr;
+
+        managed_recv_buffer(void): _has_recv_time(false){
+            /* NOP */
+        }
+
+        /*!
+         * Does the buffer have the time the frame arrived at the host?
+         * Only transports with receive timestamps enabled set the time.
+         * \return true when get_recv_time() is valid
+         */
+        UHD_INLINE bool has_recv_time(void) const{
+            return _has_recv_time;
+        }
+
+        /*!
+         * Get the time the frame arrived at the host.
+         * The kernel takes the time when it receives the frame,
+         * on the host's real time clock, in seconds since the epoch.
+         * \return the arrival time of the frame
+         */
+        UHD_INLINE const time_spec_t &get_recv_time(void) const{
+            return _recv_time;
+        }
+
+        /*!
+         * Set the arrival time of the frame (for use by transports).
+         * \param recv_time the time the frame arrived at the host
+         */
+        UHD_INLINE void set_recv_time(const time_spec_t &recv_time){
+            _recv_time = recv_time;
+            _has_recv_time = true;
+        }
+
+        /*!
+         * Clear the arrival time of a reused frame (for use by transports).
+         * Call it for every frame that the transport has no time for.
+         */
+        UHD_INLINE void clear_recv_time(void){
+            _has_recv_time = false;
+        }
+
+    private:
+        bool _has_recv_time;
+        time_spec_t _recv_time;
     };
 
     /*!
@@ -144,6 +190,42 @@ namespace uhd{ namespace transport{
         size_t num_send_frames;
     };
 
+    /*!
+     * Transport counters:
+     * Every transport counts its traffic while it runs.
+     * The threads of the transport update each counter atomically,
+     * a copy may be a few updates apart between different counters.
+     * The frames in use are the received frames that the caller did not
+     * release yet (recv_packets - recv_frames_released), and the send
+     * buffers that the caller did not commit yet (send_frames - send_packets).
+     */
+    struct zero_copy_counters {
+        boost::uint64_t recv_packets;           //!< frames handed to the caller
+        boost::uint64_t recv_bytes;             //!< bytes in the handed out frames
+        boost::uint64_t recv_timeouts;          //!< calls to get_recv_buff that returned no frame
+        boost::uint64_t recv_retries;           //!< receive calls that failed and were retried
+        boost::uint64_t recv_frames_released;   //!< frames that the caller released
+        size_t recv_frames_in_use_max;          //!< the most frames that the caller held at once
+        double recv_wait_time;                  //!< seconds blocked waiting for a frame
+
+        boost::uint64_t send_frames;            //!< buffers handed to the caller
+        boost::uint64_t send_packets;           //!< buffers that the caller committed
+        boost::uint64_t send_bytes;             //!< bytes in the committed buffers
+        boost::uint64_t send_timeouts;          //!< calls to get_send_buff that returned no buffer
+        boost::uint64_t send_retries;           //!< send calls that the kernel refused (EAGAIN, ENOBUFS) and were retried
+        size_t send_frames_in_use_max;          //!< the most buffers that the caller held at once
+        double send_wait_time;                  //!< seconds blocked waiting for a free buffer
+
+        zero_copy_counters(void):
+            recv_packets(0), recv_bytes(0), recv_timeouts(0), recv_retries(0),
+            recv_frames_released(0), recv_frames_in_use_max(0), recv_wait_time(0.0),
+            send_frames(0), send_packets(0), send_bytes(0), send_timeouts(0), send_retries(0),
+            send_frames_in_use_max(0), send_wait_time(0.0)
+        {
+            /* NOP */
+        }
+    };
+
     /*!
      * A zero-copy interface for transport objects.
      * Provides a way to get send and receive buffers
@@ -200,6 +282,15 @@ namespace uhd{ namespace transport{
          */
         virtual size_t get_send_frame_size(void) const = 0;
 
+        /*!
+         * Get the counters of this transport.
+         * A transport that does not count returns all zero.
+         * \return a copy of the counters
+         */
+        virtual zero_copy_counters get_counters(void) const{
+            return zero_copy_counters();
+        }
+
     };
 
 }} //namespace
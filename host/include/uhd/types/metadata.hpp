@@ -49,6 +49,8 @@ namespace uhd{
             end_of_burst = false;
             error_code = ERROR_CODE_NONE;
             out_of_sequence = false;
+            has_recv_time = false;
+            recv_time = time_spec_t(0.0);
         }
 
         //! Has time specification?
@@ -119,6 +121,20 @@ namespace uhd{
         //! Out of sequence.  The transport has either dropped a packet or received data out of order.
         bool out_of_sequence;
 
+        /*!
+         * Has the host arrival time?
+         * Only set when the transport records receive timestamps
+         * (see the recv_timestamps transport argument).
+         */
+        bool has_recv_time;
+
+        /*!
+         * Host arrival time of the first packet:
+         * The time the kernel received the packet on the host's
+         * real time clock, in seconds since the epoch.
+         */
+        time_spec_t recv_time;
+
         /*!
          * Convert a rx_metadata_t into a pretty print string.
          *
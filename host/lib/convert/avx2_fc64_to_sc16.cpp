@@ -0,0 +1,75 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+template <xtox_t to_wire>
+UHD_CONVERT_TARGET_AVX2 static void convert_fc64_1_to_sc16_item32_1_avx2(
+    const fc64_t *input, item32_t *output, const size_t nsamps,
+    const double scale_factor, const __m128i &shuf
+){
+    const __m256d scalar = _mm256_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256d tmp0 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+i+0));
+        __m256d tmp1 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+i+2));
+        __m256d tmp2 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+i+4));
+        __m256d tmp3 = _mm256_loadu_pd(reinterpret_cast<const double *>(input+i+6));
+
+        /* convert and scale */
+        __m128i tmpi0 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp0, scalar));
+        __m128i tmpi1 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp1, scalar));
+        __m128i tmpi2 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp2, scalar));
+        __m128i tmpi3 = _mm256_cvttpd_epi32(_mm256_mul_pd(tmp3, scalar));
+
+        /* pack with saturation + shuffle into wire order */
+        __m128i tmpilo = _mm_shuffle_epi8(_mm_packs_epi32(tmpi0, tmpi1), shuf);
+        __m128i tmpihi = _mm_shuffle_epi8(_mm_packs_epi32(tmpi2, tmpi3), shuf);
+
+        /* store to output */
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+0), tmpilo);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i+4), tmpihi);
+    }
+
+    // convert any remaining samples
+    xx_to_item32_sc16<to_wire>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, fc64, 1, sc16_item32_le, 1, PRIORITY_SIMD_AVX2){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    // swap the 16-bit pairs
+    const __m128i shuf = _mm_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+    convert_fc64_1_to_sc16_item32_1_avx2<uhd::htowx>(input, output, nsamps, scale_factor, shuf);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, fc64, 1, sc16_item32_be, 1, PRIORITY_SIMD_AVX2){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    // byteswap the 16 bit words
+    const __m128i shuf = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    convert_fc64_1_to_sc16_item32_1_avx2<uhd::htonx>(input, output, nsamps, scale_factor, shuf);
+}
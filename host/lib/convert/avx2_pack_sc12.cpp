@@ -0,0 +1,159 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_cpu_features.hpp"
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+/*
+ * Pack sixteen 12-bit numbers into two 3 line blocks, one block per
+ * 128-bit lane. See sse41_pack_sc12.cpp for how the shuffle works,
+ * the avx2 shuffle applies the same pattern to each lane.
+ */
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256i pack_sc12_blocks_avx2(
+    const __m256i &nums, const __m256i &shuf
+){
+    const __m256i pairs = _mm256_madd_epi16(nums, _mm256_set1_epi32(0x00011000));
+    return _mm256_shuffle_epi8(pairs, shuf);
+}
+
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE void store_sc12_block_avx2(
+    const __m128i &lines, item32_sc12_3x &output
+){
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(&output.line0), lines);
+    output.line2 = item32_t(_mm_extract_epi32(lines, 2));
+}
+
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256i pack_sc12_shuffle_avx2(const bool wire_le){
+    return (wire_le)?
+        _mm256_set_epi8(
+            -1, -1, -1, -1, 8, 14, 13, 12, 5, 4, 10, 9, 2, 1, 0, 6,
+            -1, -1, -1, -1, 8, 14, 13, 12, 5, 4, 10, 9, 2, 1, 0, 6):
+        _mm256_set_epi8(
+            -1, -1, -1, -1, 12, 13, 14, 8, 9, 10, 4, 5, 6, 0, 1, 2,
+            -1, -1, -1, -1, 12, 13, 14, 8, 9, 10, 4, 5, 6, 0, 1, 2);
+}
+
+/*
+ * Scale eight floats (one block) and truncate them to 12 bits.
+ * The multiply is done in double precision like the scalar code,
+ * so that both produce exactly the same numbers.
+ */
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256i scale_sc12_avx2(
+    const __m256 &in, const __m256d &scalar
+){
+    const __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(in)), scalar));
+    const __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(in, 1)), scalar));
+    const __m256 scaled = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    return _mm256_and_si256(_mm256_cvttps_epi32(scaled), _mm256_set1_epi32(0xfff));
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_AVX2 void convert_fc32_to_sc12_item32_blocks_avx2(
+    const fc32_t *input, item32_sc12_3x *output, const size_t nblocks, const double scalar
+){
+    const __m256i shuf = pack_sc12_shuffle_avx2(wire_le);
+    const __m256d scalar_pd = _mm256_set1_pd(scalar);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i+=2){
+        const __m256i nums0 = scale_sc12_avx2(_mm256_loadu_ps(reinterpret_cast<const float *>(input+4*i+0)), scalar_pd);
+        const __m256i nums1 = scale_sc12_avx2(_mm256_loadu_ps(reinterpret_cast<const float *>(input+4*i+4)), scalar_pd);
+
+        /* the pack interleaves the lanes, put each block back into one lane */
+        const __m256i nums = _mm256_permute4x64_epi64(_mm256_packus_epi32(nums0, nums1), 0xd8);
+        const __m256i lines = pack_sc12_blocks_avx2(nums, shuf);
+        store_sc12_block_avx2(_mm256_castsi256_si128(lines), output[i+0]);
+        store_sc12_block_avx2(_mm256_extracti128_si256(lines, 1), output[i+1]);
+    }
+
+    // convert the last block when the number of blocks is odd
+    if (i < nblocks){
+        const __m256i nums0 = scale_sc12_avx2(_mm256_loadu_ps(reinterpret_cast<const float *>(input+4*i)), scalar_pd);
+        const __m256i nums = _mm256_permute4x64_epi64(_mm256_packus_epi32(nums0, nums0), 0xd8);
+        store_sc12_block_avx2(_mm256_castsi256_si128(pack_sc12_blocks_avx2(nums, shuf)), output[i]);
+    }
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_AVX2 void convert_sc16_to_sc12_item32_blocks_avx2(
+    const sc16_t *input, item32_sc12_3x *output, const size_t nblocks, const double
+){
+    const __m256i shuf = pack_sc12_shuffle_avx2(wire_le);
+
+    /* the logical shift keeps the upper 12 bits of each number */
+    size_t i = 0;
+    for (; i+1 < nblocks; i+=2){
+        const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+4*i));
+        const __m256i lines = pack_sc12_blocks_avx2(_mm256_srli_epi16(in, 4), shuf);
+        store_sc12_block_avx2(_mm256_castsi256_si128(lines), output[i+0]);
+        store_sc12_block_avx2(_mm256_extracti128_si256(lines, 1), output[i+1]);
+    }
+
+    // convert the last block when the number of blocks is odd
+    if (i < nblocks){
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i));
+        const __m256i lines = pack_sc12_blocks_avx2(_mm256_srli_epi16(_mm256_broadcastsi128_si256(in), 4), shuf);
+        store_sc12_block_avx2(_mm256_castsi256_si128(lines), output[i]);
+    }
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1_avx2(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx, convert_fc32_to_sc12_item32_blocks_avx2<true> >());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1_avx2(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::ntohx, convert_fc32_to_sc12_item32_blocks_avx2<false> >());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1_avx2(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<s16_t, uhd::wtohx, convert_sc16_to_sc12_item32_blocks_avx2<true> >());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1_avx2(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<s16_t, uhd::ntohx, convert_sc16_to_sc12_item32_blocks_avx2<false> >());
+}
+
+UHD_STATIC_BLOCK(register_avx2_pack_sc12)
+{
+    if (not cpu_has_avx2()) return;
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.input_format = "fc32";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_le_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_be_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.input_format = "sc16";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_le_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_be_1_avx2, PRIORITY_SIMD_AVX2);
+}
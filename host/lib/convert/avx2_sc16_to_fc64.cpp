@@ -0,0 +1,69 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+template <xtox_t to_host>
+UHD_CONVERT_TARGET_AVX2 static void convert_sc16_item32_1_to_fc64_1_avx2(
+    const item32_t *input, fc64_t *output, const size_t nsamps,
+    const double scale_factor, const __m128i &shuf
+){
+    const __m256d scalar = _mm256_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load from input */
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+
+        /* shuffle into I, Q order + sign extend to 32 bits */
+        __m256i tmp = _mm256_cvtepi16_epi32(_mm_shuffle_epi8(tmpi, shuf));
+
+        /* convert and scale */
+        __m256d tmp0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(tmp)), scalar);
+        __m256d tmp1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(tmp, 1)), scalar);
+
+        /* store to output */
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+i+0), tmp0);
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+i+2), tmp1);
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<to_host>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, sc16_item32_le, 1, fc64, 1, PRIORITY_SIMD_AVX2){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    // swap the 16-bit pairs
+    const __m128i shuf = _mm_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+    convert_sc16_item32_1_to_fc64_1_avx2<uhd::htowx>(input, output, nsamps, scale_factor, shuf);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, sc16_item32_be, 1, fc64, 1, PRIORITY_SIMD_AVX2){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    // byteswap the 16 bit words
+    const __m128i shuf = _mm_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    convert_sc16_item32_1_to_fc64_1_avx2<uhd::htonx>(input, output, nsamps, scale_factor, shuf);
+}
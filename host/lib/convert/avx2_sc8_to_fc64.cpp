@@ -0,0 +1,73 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+template <xtox_t to_host, bool reverse_bytes>
+UHD_CONVERT_TARGET_AVX2 static void convert_sc8_item32_1_to_fc64_1_avx2(
+    const void *input_buff, fc64_t *output, const size_t nsamps, const double scale_factor
+){
+    const item32_t *input = reinterpret_cast<const item32_t *>(size_t(input_buff) & ~0x3);
+
+    const __m256d scalar = _mm256_set1_pd(scale_factor);
+    // reverse the bytes of each item32 to get I0, Q0, I1, Q1 order
+    const __m128i shuf = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+    size_t i = 0, j = 0;
+    size_t num_samps = nsamps;
+
+    if ((size_t(input_buff) & 0x3) != 0){
+        item32_sc8_to_xx<to_host>(input++, output++, 1, scale_factor);
+        num_samps--;
+    }
+
+    for (; j+7 < num_samps; j+=8, i+=4){
+        /* load from input */
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+        if (reverse_bytes) tmpi = _mm_shuffle_epi8(tmpi, shuf);
+
+        /* sign extend each item32 to 32 bits, convert and scale */
+        __m256d tmp0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepi8_epi32(tmpi)), scalar);
+        __m256d tmp1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepi8_epi32(_mm_srli_si128(tmpi, 4))), scalar);
+        __m256d tmp2 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepi8_epi32(_mm_srli_si128(tmpi, 8))), scalar);
+        __m256d tmp3 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepi8_epi32(_mm_srli_si128(tmpi, 12))), scalar);
+
+        /* store to output */
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+j+0), tmp0);
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+j+2), tmp1);
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+j+4), tmp2);
+        _mm256_storeu_pd(reinterpret_cast<double *>(output+j+6), tmp3);
+    }
+
+    //convert remainder
+    item32_sc8_to_xx<to_host>(input+i, output+j, num_samps-j, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, sc8_item32_be, 1, fc64, 1, PRIORITY_SIMD_AVX2){
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+    convert_sc8_item32_1_to_fc64_1_avx2<uhd::ntohx, false>(inputs[0], output, nsamps, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx2(), UHD_CONVERT_TARGET_AVX2, sc8_item32_le, 1, fc64, 1, PRIORITY_SIMD_AVX2){
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+    convert_sc8_item32_1_to_fc64_1_avx2<uhd::wtohx, true>(inputs[0], output, nsamps, scale_factor);
+}
@@ -0,0 +1,145 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_cpu_features.hpp"
+#include <immintrin.h>
+
+using namespace uhd::convert;
+
+/*
+ * Unpack two 3 line blocks into sixteen 16-bit numbers, one block per
+ * 128-bit lane. See sse41_unpack_sc12.cpp for how the shuffle works,
+ * the avx2 shuffle applies the same pattern to each lane.
+ */
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256i unpack_sc12_blocks_avx2(
+    const item32_sc12_3x &in0, const item32_sc12_3x &in1, const __m256i &shuf
+){
+    const __m128i lo = _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&in0.line0)), int(in0.line2), 2);
+    const __m128i hi = _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&in1.line0)), int(in1.line2), 2);
+    const __m256i words = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), shuf);
+    const __m256i shift = _mm256_set_epi16(16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1);
+    return _mm256_and_si256(_mm256_mullo_epi16(words, shift), _mm256_set1_epi16(short(0xfff0)));
+}
+
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256i unpack_sc12_shuffle_avx2(const bool wire_le){
+    return (wire_le)?
+        _mm256_set_epi8(
+            9, 8, 10, 9, 4, 11, 5, 4, 7, 6, 0, 7, 2, 1, 3, 2,
+            9, 8, 10, 9, 4, 11, 5, 4, 7, 6, 0, 7, 2, 1, 3, 2):
+        _mm256_set_epi8(
+            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+            10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+}
+
+/*
+ * Sign extend eight numbers, then scale them to float.
+ * The multiply is done in double precision like the scalar code,
+ * so that both produce exactly the same floats.
+ */
+UHD_CONVERT_TARGET_AVX2 static UHD_INLINE __m256 scale_sc12_avx2(
+    const __m128i &nums16, const __m256d &scalar
+){
+    const __m256i nums = _mm256_cvtepi16_epi32(nums16);
+    const __m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(nums)), scalar));
+    const __m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(nums, 1)), scalar));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_AVX2 void convert_sc12_item32_blocks_to_fc32_avx2(
+    const item32_sc12_3x *input, fc32_t *output, const size_t nblocks, const double scalar
+){
+    const __m256i shuf = unpack_sc12_shuffle_avx2(wire_le);
+    const __m256d scalar_pd = _mm256_set1_pd(scalar);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i+=2){
+        const __m256i nums = unpack_sc12_blocks_avx2(input[i+0], input[i+1], shuf);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+4*i+0), scale_sc12_avx2(_mm256_castsi256_si128(nums), scalar_pd));
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+4*i+4), scale_sc12_avx2(_mm256_extracti128_si256(nums, 1), scalar_pd));
+    }
+
+    // convert the last block when the number of blocks is odd
+    if (i < nblocks){
+        const __m256i nums = unpack_sc12_blocks_avx2(input[i], input[i], shuf);
+        _mm256_storeu_ps(reinterpret_cast<float *>(output+4*i), scale_sc12_avx2(_mm256_castsi256_si128(nums), scalar_pd));
+    }
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_AVX2 void convert_sc12_item32_blocks_to_sc16_avx2(
+    const item32_sc12_3x *input, sc16_t *output, const size_t nblocks, const double
+){
+    const __m256i shuf = unpack_sc12_shuffle_avx2(wire_le);
+
+    size_t i = 0;
+    for (; i+1 < nblocks; i+=2){
+        const __m256i nums = unpack_sc12_blocks_avx2(input[i+0], input[i+1], shuf);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+4*i), nums);
+    }
+
+    // convert the last block when the number of blocks is odd
+    if (i < nblocks){
+        const __m256i nums = unpack_sc12_blocks_avx2(input[i], input[i], shuf);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i), _mm256_castsi256_si128(nums));
+    }
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1_avx2(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx, convert_sc12_item32_blocks_to_fc32_avx2<true> >());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1_avx2(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::ntohx, convert_sc12_item32_blocks_to_fc32_avx2<false> >());
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1_avx2(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<s16_t, uhd::wtohx, convert_sc12_item32_blocks_to_sc16_avx2<true> >());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1_avx2(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<s16_t, uhd::ntohx, convert_sc12_item32_blocks_to_sc16_avx2<false> >());
+}
+
+UHD_STATIC_BLOCK(register_avx2_unpack_sc12)
+{
+    if (not cpu_has_avx2()) return;
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.output_format = "sc16";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_sc16_1_avx2, PRIORITY_SIMD_AVX2);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_sc16_1_avx2, PRIORITY_SIMD_AVX2);
+}
@@ -0,0 +1,73 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include "convert_avx512.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+template <xtox_t to_wire>
+UHD_CONVERT_TARGET_AVX512 static void convert_fc32_1_to_sc16_item32_1_avx512(
+    const fc32_t *input, item32_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m512 scalar = _mm512_set1_ps(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+15 < nsamps; i+=16){
+        /* load from input */
+        __m512 tmplo = _mm512_loadu_ps(reinterpret_cast<const float *>(input+i+0));
+        __m512 tmphi = _mm512_loadu_ps(reinterpret_cast<const float *>(input+i+8));
+
+        /* convert and scale, then narrow to 16 bits with saturation */
+        __m256i tmpilo = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(_mm512_mul_ps(tmplo, scalar)));
+        __m256i tmpihi = _mm512_cvtsepi32_epi16(_mm512_cvtps_epi32(_mm512_mul_ps(tmphi, scalar)));
+
+        /* shuffle into wire order + store to output */
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i+0), _mm256_shuffle_epi8(tmpilo, shuf));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output+i+8), _mm256_shuffle_epi8(tmpihi, shuf));
+    }
+
+    // convert any remaining samples
+    xx_to_item32_sc16<to_wire>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, fc32, 1, sc16_item32_le, 1, PRIORITY_SIMD_AVX512){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    // swap the 16-bit pairs
+    const __m256i shuf = _mm256_set_epi8(
+        13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+        13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2
+    );
+    convert_fc32_1_to_sc16_item32_1_avx512<uhd::htowx>(input, output, nsamps, scale_factor, shuf);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, fc32, 1, sc16_item32_be, 1, PRIORITY_SIMD_AVX512){
+    const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    // byteswap the 16 bit words
+    const __m256i shuf = _mm256_set_epi8(
+        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1
+    );
+    convert_fc32_1_to_sc16_item32_1_avx512<uhd::htonx>(input, output, nsamps, scale_factor, shuf);
+}
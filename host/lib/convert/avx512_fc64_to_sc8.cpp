@@ -0,0 +1,66 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include "convert_avx512.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+template <xtox_t to_wire, bool reverse_bytes>
+UHD_CONVERT_TARGET_AVX512 static void convert_fc64_1_to_sc8_item32_1_avx512(
+    const fc64_t *input, item32_t *output, const size_t nsamps, const double scale_factor
+){
+    const __m512d scalar = _mm512_set1_pd(scale_factor);
+    // reverse the bytes of each item32 from I0, Q0, I1, Q1 order
+    const __m128i shuf = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+    size_t i = 0;
+    for (size_t j = 0; i+7 < nsamps; i+=8, j+=4){
+        /* load from input */
+        __m512d tmp0 = _mm512_loadu_pd(reinterpret_cast<const double *>(input+i+0));
+        __m512d tmp1 = _mm512_loadu_pd(reinterpret_cast<const double *>(input+i+4));
+
+        /* convert and scale */
+        __m256i tmpi0 = _mm512_cvttpd_epi32(_mm512_mul_pd(tmp0, scalar));
+        __m256i tmpi1 = _mm512_cvttpd_epi32(_mm512_mul_pd(tmp1, scalar));
+
+        /* narrow to 8 bits with saturation */
+        __m512i tmpi32 = _mm512_inserti64x4(_mm512_castsi256_si512(tmpi0), tmpi1, 1);
+        __m128i tmpi = _mm512_cvtsepi32_epi8(tmpi32);
+        if (reverse_bytes) tmpi = _mm_shuffle_epi8(tmpi, shuf);
+
+        /* store to output */
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+j), tmpi);
+    }
+
+    //convert remainder
+    xx_to_item32_sc8<to_wire>(input+i, output+(i/2), nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, fc64, 1, sc8_item32_be, 1, PRIORITY_SIMD_AVX512){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+    convert_fc64_1_to_sc8_item32_1_avx512<uhd::htonx, false>(input, output, nsamps, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, fc64, 1, sc8_item32_le, 1, PRIORITY_SIMD_AVX512){
+    const fc64_t *input = reinterpret_cast<const fc64_t *>(inputs[0]);
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+    convert_fc64_1_to_sc8_item32_1_avx512<uhd::htowx, true>(input, output, nsamps, scale_factor);
+}
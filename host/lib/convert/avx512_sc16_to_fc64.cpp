@@ -0,0 +1,75 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include "convert_cpu_features.hpp"
+#include "convert_avx512.hpp"
+#include <uhd/utils/byteswap.hpp>
+
+using namespace uhd::convert;
+
+template <xtox_t to_host>
+UHD_CONVERT_TARGET_AVX512 static void convert_sc16_item32_1_to_fc64_1_avx512(
+    const item32_t *input, fc64_t *output, const size_t nsamps,
+    const double scale_factor, const __m256i &shuf
+){
+    const __m512d scalar = _mm512_set1_pd(scale_factor);
+
+    size_t i = 0;
+    for (; i+7 < nsamps; i+=8){
+        /* load from input */
+        __m256i tmpi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input+i));
+
+        /* shuffle into I, Q order + sign extend to 32 bits */
+        __m512i tmp = _mm512_cvtepi16_epi32(_mm256_shuffle_epi8(tmpi, shuf));
+
+        /* convert and scale */
+        __m512d tmp0 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(tmp)), scalar);
+        __m512d tmp1 = _mm512_mul_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(tmp, 1)), scalar);
+
+        /* store to output */
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+0), tmp0);
+        _mm512_storeu_pd(reinterpret_cast<double *>(output+i+4), tmp1);
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<to_host>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, sc16_item32_le, 1, fc64, 1, PRIORITY_SIMD_AVX512){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    // swap the 16-bit pairs
+    const __m256i shuf = _mm256_set_epi8(
+        13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+        13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2
+    );
+    convert_sc16_item32_1_to_fc64_1_avx512<uhd::htowx>(input, output, nsamps, scale_factor, shuf);
+}
+
+DECLARE_CONVERTER_IF(cpu_has_avx512(), UHD_CONVERT_TARGET_AVX512, sc16_item32_be, 1, fc64, 1, PRIORITY_SIMD_AVX512){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc64_t *output = reinterpret_cast<fc64_t *>(outputs[0]);
+
+    // byteswap the 16 bit words
+    const __m256i shuf = _mm256_set_epi8(
+        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+        14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1
+    );
+    convert_sc16_item32_1_to_fc64_1_avx512<uhd::htonx>(input, output, nsamps, scale_factor, shuf);
+}
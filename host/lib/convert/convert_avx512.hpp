@@ -0,0 +1,40 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_AVX512_HPP
+#define INCLUDED_LIBUHD_CONVERT_AVX512_HPP
+
+/***********************************************************************
+ * The AVX-512 intrinsics for the avx512_* converters.
+ *
+ * In GCC's headers, the unmasked AVX-512 intrinsics call the masked
+ * builtins with an undefined pass-through operand. Once inlined into
+ * a function with a target attribute, GCC 12 reports that operand
+ * with -Wmaybe-uninitialized (GCC bug 105593), although the full mask
+ * never reads it. The warning is switched off for the header only,
+ * so it still covers the converters themselves.
+ **********************************************************************/
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #include <immintrin.h>
+    #pragma GCC diagnostic pop
+#else
+    #include <immintrin.h>
+#endif
+
+#endif /* INCLUDED_LIBUHD_CONVERT_AVX512_HPP */
@@ -23,14 +23,15 @@
 #include <boost/cstdint.hpp>
 #include <complex>
 
-#define _DECLARE_CONVERTER(name, in_form, num_in, out_form, num_out, prio) \
+#define _DECLARE_CONVERTER_IF(name, in_form, num_in, out_form, num_out, prio, cond, target) \
     struct name : public uhd::convert::converter{ \
         static sptr make(void){return sptr(new name());} \
         double scale_factor; \
         void set_scalar(const double s){scale_factor = s;} \
-        void operator()(const input_type&, const output_type&, const size_t); \
+        target void operator()(const input_type&, const output_type&, const size_t); \
     }; \
     UHD_STATIC_BLOCK(__register_##name##_##prio){ \
+        if (not (cond)) return; \
         uhd::convert::id_type id; \
         id.input_format = #in_form; \
         id.num_inputs = num_in; \
@@ -38,10 +39,16 @@
         id.num_outputs = num_out; \
         uhd::convert::register_converter(id, &name::make, prio); \
     } \
-    void name::operator()( \
+    target void name::operator()( \
         const input_type &inputs, const output_type &outputs, const size_t nsamps \
     )
 
+#define _DECLARE_CONVERTER(name, in_form, num_in, out_form, num_out, prio) \
+    _DECLARE_CONVERTER_IF(name, in_form, num_in, out_form, num_out, prio, true, UHD_CONVERT_TARGET_DEFAULT)
+
+//! Empty target attribute used by converters built for the baseline ISA
+#define UHD_CONVERT_TARGET_DEFAULT
+
 /*! Convenience macro to declare a single-function converter
  *
  * Most converters consist of a single for loop, and can make use of
@@ -58,11 +65,25 @@
 #define DECLARE_CONVERTER(in_form, num_in, out_form, num_out, prio) \
     _DECLARE_CONVERTER(__convert_##in_form##_##num_in##_##out_form##_##num_out##_##prio, in_form, num_in, out_form, num_out, prio)
 
+/*! Convenience macro to declare a converter for an optional instruction set
+ *
+ * Works like DECLARE_CONVERTER, but the converter is only registered
+ * when the condition `cond` is true when the library is loaded,
+ * and the conversion function is compiled with the attribute `target`.
+ * This lets a converter use instruction set extensions (AVX2, AVX-512)
+ * without compiling the entire translation unit for that extension,
+ * so that the library still loads on a CPU which lacks it.
+ * See convert_cpu_features.hpp for the conditions and target attributes.
+ */
+#define DECLARE_CONVERTER_IF(cond, target, in_form, num_in, out_form, num_out, prio) \
+    _DECLARE_CONVERTER_IF(__convert_##in_form##_##num_in##_##out_form##_##num_out##_##prio, in_form, num_in, out_form, num_out, prio, cond, target)
+
 /***********************************************************************
  * Setup priorities
  **********************************************************************/
 static const int PRIORITY_GENERAL = 0;
 static const int PRIORITY_EMPTY = -1;
+static const int PRIORITY_CORRECTION_GENERAL = -4; //generic correcting converters, the reference for the simd ones
 
 #ifdef __ARM_NEON__
 static const int PRIORITY_LIBORC = 3;
@@ -72,6 +93,8 @@ static const int PRIORITY_TABLE = 1; //tables require large cache, so they are s
 static const int PRIORITY_LIBORC = 2;
 static const int PRIORITY_SIMD = 3;
 static const int PRIORITY_TABLE = 1;
+static const int PRIORITY_SIMD_AVX2 = 4; //only registered when the cpu supports avx2
+static const int PRIORITY_SIMD_AVX512 = 5; //only registered when the cpu supports avx-512
 #endif
 
 /***********************************************************************
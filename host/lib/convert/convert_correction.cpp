@@ -0,0 +1,96 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_correction.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * Generic corrected conversions, always registered as a reference,
+ * they are the correcting converters when there is no SIMD version
+ **********************************************************************/
+template <xtox_t to_host>
+class convert_sc16_item32_1_to_fc32_1_corrected : public correcting_converter_base{
+public:
+    convert_sc16_item32_1_to_fc32_1_corrected(void): correcting_converter_base(true){}
+
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+        fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+        item32_sc16_to_fc32_corrected<to_host>(input, output, nsamps, _m, _o);
+    }
+};
+
+template <xtox_t to_wire>
+class convert_fc32_1_to_sc16_item32_1_corrected : public correcting_converter_base{
+public:
+    convert_fc32_1_to_sc16_item32_1_corrected(void): correcting_converter_base(false){}
+
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+        item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+        fc32_to_item32_sc16_corrected<to_wire>(input, output, nsamps, _m, _o);
+    }
+};
+
+static converter::sptr make_convert_sc16_item32_le_1_to_fc32_1_corrected(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected<uhd::wtohx>());
+}
+
+static converter::sptr make_convert_sc16_item32_be_1_to_fc32_1_corrected(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected<uhd::ntohx>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc16_item32_le_1_corrected(void){
+    return converter::sptr(new convert_fc32_1_to_sc16_item32_1_corrected<uhd::htowx>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc16_item32_be_1_corrected(void){
+    return converter::sptr(new convert_fc32_1_to_sc16_item32_1_corrected<uhd::htonx>());
+}
+
+static void register_correcting_converter(const uhd::convert::id_type &id, const function_type &fcn){
+    uhd::convert::register_converter(id, fcn, PRIORITY_CORRECTION_GENERAL);
+
+    //a SIMD version registers at PRIORITY_CORRECTION unconditionally,
+    //so it wins no matter which registration runs first
+    const std::vector<priority_type> prios = uhd::convert::get_converter_priorities(id);
+    if (std::find(prios.begin(), prios.end(), PRIORITY_CORRECTION) == prios.end()){
+        uhd::convert::register_converter(id, fcn, PRIORITY_CORRECTION);
+    }
+}
+
+UHD_STATIC_BLOCK(register_convert_correction)
+{
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc32";
+    id.input_format = "sc16_item32_le";
+    register_correcting_converter(id, &make_convert_sc16_item32_le_1_to_fc32_1_corrected);
+    id.input_format = "sc16_item32_be";
+    register_correcting_converter(id, &make_convert_sc16_item32_be_1_to_fc32_1_corrected);
+
+    id.input_format = "fc32";
+    id.output_format = "sc16_item32_le";
+    register_correcting_converter(id, &make_convert_fc32_1_to_sc16_item32_le_1_corrected);
+    id.output_format = "sc16_item32_be";
+    register_correcting_converter(id, &make_convert_fc32_1_to_sc16_item32_be_1_corrected);
+}
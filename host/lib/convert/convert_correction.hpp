@@ -0,0 +1,106 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP
+#define INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <algorithm>
+#include <cmath>
+
+/***********************************************************************
+ * Converters that apply an IQ and DC correction while converting
+ * between the sc16 over the wire format and fc32.
+ *
+ * The correction is folded together with the scale factor into one
+ * matrix and one offset, so that every sample costs 4 multiplies and
+ * 4 adds on top of the plain conversion:
+ * - RX (sc16 -> fc32): out = matrix*(scalar*in) + offset
+ * - TX (fc32 -> sc16): out = scalar*(matrix*in + offset)
+ **********************************************************************/
+class correcting_converter_base : public uhd::convert::correcting_converter{
+public:
+    correcting_converter_base(const bool rx):
+        _rx(rx), _scalar(1.0)
+    {
+        this->update();
+    }
+
+    void set_scalar(const double scalar){
+        _scalar = scalar;
+        this->update();
+    }
+
+    void set_correction(const uhd::convert::correction_type &correction){
+        _correction = correction;
+        this->update();
+    }
+
+protected:
+    //! The combined matrix (row major) and offset
+    float _m[4], _o[2];
+
+private:
+    void update(void){
+        for (size_t i = 0; i < 4; i++) _m[i] = float(_correction.matrix[i]*_scalar);
+        const double offset_scalar = (_rx)? 1.0 : _scalar;
+        _o[0] = float(_correction.offset.real()*offset_scalar);
+        _o[1] = float(_correction.offset.imag()*offset_scalar);
+    }
+
+    const bool _rx;
+    double _scalar;
+    uhd::convert::correction_type _correction;
+};
+
+/***********************************************************************
+ * Generic corrected conversions, also used for the head and tail
+ * samples of the SIMD conversions
+ **********************************************************************/
+template <xtox_t to_host>
+UHD_INLINE void item32_sc16_to_fc32_corrected(
+    const item32_t *input, fc32_t *output, const size_t nsamps,
+    const float m[4], const float o[2]
+){
+    for (size_t i = 0; i < nsamps; i++){
+        const item32_t item = to_host(input[i]);
+        const float re = float(boost::int16_t(item >> 16));
+        const float im = float(boost::int16_t(item >> 0));
+        output[i] = fc32_t(m[0]*re + m[1]*im + o[0], m[2]*re + m[3]*im + o[1]);
+    }
+}
+
+//! Round to the nearest integer (half to even, like the SIMD conversions) and saturate to the sc16 range
+UHD_INLINE boost::uint16_t fc32_to_sc16_sat(const float x){
+    return boost::uint16_t(boost::int16_t(lrintf(std::max(-32768.f, std::min(32767.f, x)))));
+}
+
+template <xtox_t to_wire>
+UHD_INLINE void fc32_to_item32_sc16_corrected(
+    const fc32_t *input, item32_t *output, const size_t nsamps,
+    const float m[4], const float o[2]
+){
+    for (size_t i = 0; i < nsamps; i++){
+        const float re = input[i].real(), im = input[i].imag();
+        const boost::uint16_t out_re = fc32_to_sc16_sat(m[0]*re + m[1]*im + o[0]);
+        const boost::uint16_t out_im = fc32_to_sc16_sat(m[2]*re + m[3]*im + o[1]);
+        output[i] = to_wire((item32_t(out_re) << 16) | out_im);
+    }
+}
+
+#endif /* INCLUDED_LIBUHD_CONVERT_CORRECTION_HPP */
@@ -0,0 +1,112 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_cpu_features.hpp"
+#include <boost/cstdint.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86)
+    #define HAVE_X86_CPUID
+    #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+    #define HAVE_X86_CPUID
+    #include <cpuid.h>
+#endif
+
+#ifdef HAVE_X86_CPUID
+
+/***********************************************************************
+ * Raw access to the cpuid and xgetbv instructions
+ **********************************************************************/
+static void cpuid(const int leaf, boost::uint32_t regs[4]){
+#if defined(_M_X64) || defined(_M_IX86)
+    int info[4];
+    __cpuidex(info, leaf, 0);
+    for (size_t i = 0; i < 4; i++) regs[i] = boost::uint32_t(info[i]);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count(leaf, 0, a, b, c, d);
+    regs[0] = a; regs[1] = b; regs[2] = c; regs[3] = d;
+#endif
+}
+
+static boost::uint64_t xgetbv(void){
+#if defined(_M_X64) || defined(_M_IX86)
+    return _xgetbv(0);
+#else
+    boost::uint32_t lo, hi;
+    __asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (boost::uint64_t(hi) << 32) | lo;
+#endif
+}
+
+/*!
+ * Check the cpu feature bits and that the OS saves the register state.
+ * \param ebx7_mask required bits in ebx of cpuid leaf 7
+ * \param xcr0_mask required state components enabled in XCR0
+ */
+static bool cpu_has_features(const boost::uint32_t ebx7_mask, const boost::uint64_t xcr0_mask){
+    boost::uint32_t regs[4];
+    cpuid(0, regs);
+    if (regs[0] < 7) return false;
+
+    //the os must have enabled xsave for the xgetbv check to be valid
+    cpuid(1, regs);
+    static const boost::uint32_t ecx1_osxsave = (1 << 27), ecx1_avx = (1 << 28);
+    if ((regs[2] & (ecx1_osxsave | ecx1_avx)) != (ecx1_osxsave | ecx1_avx)) return false;
+    if ((xgetbv() & xcr0_mask) != xcr0_mask) return false;
+
+    cpuid(7, regs);
+    return (regs[1] & ebx7_mask) == ebx7_mask;
+}
+
+bool uhd::convert::cpu_has_sse41(void){
+    boost::uint32_t regs[4];
+    cpuid(0, regs);
+    if (regs[0] < 1) return false;
+
+    cpuid(1, regs);
+    static const boost::uint32_t ecx1_ssse3 = (1 << 9), ecx1_sse41 = (1 << 19);
+    return (regs[2] & (ecx1_ssse3 | ecx1_sse41)) == (ecx1_ssse3 | ecx1_sse41);
+}
+
+bool uhd::convert::cpu_has_avx2(void){
+    static const boost::uint32_t ebx7_avx2 = (1 << 5);
+    static const boost::uint64_t xcr0_ymm = 0x6; //sse + avx state
+    return cpu_has_features(ebx7_avx2, xcr0_ymm);
+}
+
+bool uhd::convert::cpu_has_avx512(void){
+    static const boost::uint32_t ebx7_avx2 = (1 << 5), ebx7_avx512f = (1 << 16);
+    static const boost::uint64_t xcr0_zmm = 0xe6; //sse + avx + opmask + zmm state
+    return cpu_has_features(ebx7_avx2 | ebx7_avx512f, xcr0_zmm);
+}
+
+#else /* HAVE_X86_CPUID */
+
+bool uhd::convert::cpu_has_sse41(void){
+    return false;
+}
+
+bool uhd::convert::cpu_has_avx2(void){
+    return false;
+}
+
+bool uhd::convert::cpu_has_avx512(void){
+    return false;
+}
+
+#endif /* HAVE_X86_CPUID */
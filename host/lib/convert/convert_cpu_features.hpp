@@ -0,0 +1,55 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_CONVERT_CPU_FEATURES_HPP
+#define INCLUDED_LIBUHD_CONVERT_CPU_FEATURES_HPP
+
+#include <uhd/config.hpp>
+
+/***********************************************************************
+ * Target attributes for converters that use optional instruction sets.
+ *
+ * GCC and Clang only allow the intrinsics of an instruction set
+ * in functions compiled for that instruction set. Rather than compiling
+ * an entire source with -mavx2 (which lets the compiler use avx2 in
+ * the static registration code too), only the conversion routine gets
+ * the target attribute. MSVC allows the intrinsics anywhere.
+ **********************************************************************/
+#if defined(__GNUC__) && !defined(__INTEL_COMPILER)
+    #define UHD_CONVERT_TARGET_SSE41  __attribute__((target("sse4.1")))
+    #define UHD_CONVERT_TARGET_AVX2   __attribute__((target("avx2")))
+    #define UHD_CONVERT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+    #define UHD_CONVERT_TARGET_SSE41
+    #define UHD_CONVERT_TARGET_AVX2
+    #define UHD_CONVERT_TARGET_AVX512
+#endif
+
+namespace uhd{ namespace convert{
+
+    //! True when the cpu supports SSSE3 and SSE4.1
+    bool cpu_has_sse41(void);
+
+    //! True when the cpu and the operating system support AVX2
+    bool cpu_has_avx2(void);
+
+    //! True when the cpu and the operating system support AVX-512F
+    bool cpu_has_avx512(void);
+
+}} //namespace uhd::convert
+
+#endif /* INCLUDED_LIBUHD_CONVERT_CPU_FEATURES_HPP */
@@ -23,6 +23,9 @@
 #include <boost/cstdint.hpp>
 #include <boost/format.hpp>
 #include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <complex>
 
 using namespace uhd;
@@ -64,6 +67,88 @@ std::string convert::id_type::to_string(void) const{
     );
 }
 
+/***********************************************************************
+ * Corrections
+ **********************************************************************/
+convert::correction_type::correction_type(void):
+    offset(0.0, 0.0)
+{
+    matrix[0] = 1.0; matrix[1] = 0.0;
+    matrix[2] = 0.0; matrix[3] = 1.0;
+}
+
+bool convert::correction_type::is_identity(void) const{
+    return matrix[0] == 1.0 and matrix[1] == 0.0
+        and matrix[2] == 0.0 and matrix[3] == 1.0
+        and offset == std::complex<double>(0.0, 0.0);
+}
+
+//! Parse a list of doubles separated by colons, ex: 1.0:0.0
+static std::vector<double> parse_doubles(const std::string &key, const std::string &value, const size_t num){
+    std::vector<std::string> tokens;
+    boost::split(tokens, value, boost::is_any_of(":"));
+    if (tokens.size() != num) throw uhd::value_error(str(boost::format(
+        "%s=%s: expected %d values separated by colons") % key % value % num));
+    std::vector<double> values;
+    try{
+        BOOST_FOREACH(const std::string &token, tokens){
+            values.push_back(boost::lexical_cast<double>(boost::algorithm::trim_copy(token)));
+        }
+    }
+    catch(const boost::bad_lexical_cast &){
+        throw uhd::value_error(str(boost::format("%s=%s: not a number") % key % value));
+    }
+    return values;
+}
+
+convert::correction_type convert::correction_type::from_args(const device_addr_t &args, const size_t chan){
+    correction_type correction;
+
+    //the key with the channel index takes precedence
+    const std::string chan_str = boost::lexical_cast<std::string>(chan);
+    const std::string matrix_key = (args.has_key("iq_matrix" + chan_str))? "iq_matrix" + chan_str : "iq_matrix";
+    const std::string offset_key = (args.has_key("dc_offset" + chan_str))? "dc_offset" + chan_str : "dc_offset";
+
+    if (args.has_key(matrix_key)){
+        const std::vector<double> values = parse_doubles(matrix_key, args[matrix_key], 4);
+        std::copy(values.begin(), values.end(), correction.matrix);
+    }
+    if (args.has_key(offset_key)){
+        const std::vector<double> values = parse_doubles(offset_key, args[offset_key], 2);
+        correction.offset = std::complex<double>(values[0], values[1]);
+    }
+    return correction;
+}
+
+std::vector<convert::converter::sptr> convert::make_correcting_converters(
+    const id_type &id, const device_addr_t &args, const size_t nchan
+){
+    std::vector<correction_type> corrections;
+    bool has_correction = false;
+    for (size_t chan = 0; chan < nchan; chan++){
+        corrections.push_back(correction_type::from_args(args, chan));
+        has_correction = has_correction or not corrections.back().is_identity();
+    }
+
+    std::vector<converter::sptr> converters;
+    if (not has_correction) return converters;
+
+    BOOST_FOREACH(const correction_type &correction, corrections){
+        correcting_converter::sptr c;
+        try{
+            c = boost::dynamic_pointer_cast<correcting_converter>(get_converter(id, PRIORITY_CORRECTION)());
+        }
+        catch(const uhd::key_error &){
+            //handled below
+        }
+        if (not c) throw uhd::value_error(
+            "IQ and DC corrections are not supported for this " + id.to_pp_string());
+        c->set_correction(correction);
+        converters.push_back(c);
+    }
+    return converters;
+}
+
 /***********************************************************************
  * Setup the table registry
  **********************************************************************/
@@ -128,6 +213,19 @@ convert::function_type convert::get_converter(
     return get_table()[id][best_prio];
 }
 
+std::vector<convert::id_type> convert::get_converter_ids(void){
+    return get_table().keys();
+}
+
+std::vector<convert::priority_type> convert::get_converter_priorities(
+    const id_type &id
+){
+    if (not get_table().has_key(id)) throw uhd::key_error(
+        "Cannot find a conversion routine for " + id.to_pp_string());
+
+    return get_table()[id].keys();
+}
+
 /***********************************************************************
  * Mappings for item format to byte size for all items we can
  **********************************************************************/
@@ -48,6 +48,34 @@ DECLARE_CONVERTER(sc16_item32_$(end), 1, item32, 1, PRIORITY_GENERAL){
 }
 """
 
+TMPL_CONV_GEN2_MULTI_CHAN = """
+DECLARE_CONVERTER($(cpu_type), $(width), sc16_item32_$(end), 1, PRIORITY_GENERAL){
+    #for $w in range($width)
+    const $(cpu_type)_t *input$(w) = reinterpret_cast<const $(cpu_type)_t *>(inputs[$(w)]);
+    #end for
+    item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+    for (size_t i = 0, j = 0; i < nsamps; i++){
+        #for $w in range($width)
+        output[j++] = $(to_wire)(xx_to_item32_sc16_x1(input$(w)[i], scale_factor));
+        #end for
+    }
+}
+
+DECLARE_CONVERTER(sc16_item32_$(end), 1, $(cpu_type), $(width), PRIORITY_GENERAL){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    #for $w in range($width)
+    $(cpu_type)_t *output$(w) = reinterpret_cast<$(cpu_type)_t *>(outputs[$(w)]);
+    #end for
+
+    for (size_t i = 0, j = 0; i < nsamps; i++){
+        #for $w in range($width)
+        output$(w)[i] = item32_sc16_x1_to_xx<$(num_type)>($(to_host)(input[j++]), scale_factor);
+        #end for
+    }
+}
+"""
+
 TMPL_CONV_USRP1_COMPLEX = """
 DECLARE_CONVERTER($(cpu_type), $(width), sc16_item16_usrp1, 1, PRIORITY_GENERAL){
     #for $w in range($width)
@@ -119,6 +147,23 @@ if __name__ == '__main__':
                 end=end, to_host=to_host, to_wire=to_wire
             )
 
+    #generate multi-channel complex converters for gen2 platforms
+    for end, to_host, to_wire in (
+        ('be', 'uhd::ntohx', 'uhd::htonx'),
+        ('le', 'uhd::wtohx', 'uhd::htowx'),
+    ):
+        for width in 2, 4:
+            for cpu_type, num_type in (
+                ('fc64', 'double'),
+                ('fc32', 'float'),
+                ('sc16', 'boost::int16_t'),
+            ):
+                output += parse_tmpl(
+                    TMPL_CONV_GEN2_MULTI_CHAN,
+                    end=end, to_host=to_host, to_wire=to_wire, width=width,
+                    cpu_type=cpu_type, num_type=num_type
+                )
+
     #generate complex converters for usrp1 format
     for width in 1, 2, 4:
         for cpu_type, do_scale in (
@@ -0,0 +1,158 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_correction.hpp"
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * SSE2 corrected conversions: 4 samples at a time, with the I and Q
+ * values in separate registers for the 2x2 matrix and the offset
+ **********************************************************************/
+template <xtox_t to_host, bool swap_bytes>
+class convert_sc16_item32_1_to_fc32_1_corrected_sse2 : public correcting_converter_base{
+public:
+    convert_sc16_item32_1_to_fc32_1_corrected_sse2(void): correcting_converter_base(true){}
+
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+        fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+        const __m128 m0 = _mm_set_ps1(_m[0]), m1 = _mm_set_ps1(_m[1]);
+        const __m128 m2 = _mm_set_ps1(_m[2]), m3 = _mm_set_ps1(_m[3]);
+        const __m128 o0 = _mm_set_ps1(_o[0]), o1 = _mm_set_ps1(_o[1]);
+
+        size_t i = 0;
+        for (; i+3 < nsamps; i+=4){
+            /* load from input */
+            __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i));
+
+            /* sign extend I and Q into 32 bits */
+            __m128i tmpre, tmpim;
+            if (swap_bytes){
+                /* byteswap 16 bit words -> I in the lower, Q in the upper half */
+                tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+                tmpre = _mm_srai_epi32(_mm_slli_epi32(tmpi, 16), 16);
+                tmpim = _mm_srai_epi32(tmpi, 16);
+            }
+            else{
+                tmpre = _mm_srai_epi32(tmpi, 16);
+                tmpim = _mm_srai_epi32(_mm_slli_epi32(tmpi, 16), 16);
+            }
+            const __m128 re = _mm_cvtepi32_ps(tmpre);
+            const __m128 im = _mm_cvtepi32_ps(tmpim);
+
+            /* apply the matrix and offset */
+            const __m128 outre = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, re), _mm_mul_ps(m1, im)), o0);
+            const __m128 outim = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, re), _mm_mul_ps(m3, im)), o1);
+
+            /* interleave and store to output */
+            _mm_storeu_ps(reinterpret_cast<float *>(output+i+0), _mm_unpacklo_ps(outre, outim));
+            _mm_storeu_ps(reinterpret_cast<float *>(output+i+2), _mm_unpackhi_ps(outre, outim));
+        }
+
+        //convert any remaining samples
+        item32_sc16_to_fc32_corrected<to_host>(input+i, output+i, nsamps-i, _m, _o);
+    }
+};
+
+template <xtox_t to_wire, bool swap_bytes>
+class convert_fc32_1_to_sc16_item32_1_corrected_sse2 : public correcting_converter_base{
+public:
+    convert_fc32_1_to_sc16_item32_1_corrected_sse2(void): correcting_converter_base(false){}
+
+    void operator()(const input_type &inputs, const output_type &outputs, const size_t nsamps){
+        const fc32_t *input = reinterpret_cast<const fc32_t *>(inputs[0]);
+        item32_t *output = reinterpret_cast<item32_t *>(outputs[0]);
+
+        const __m128 m0 = _mm_set_ps1(_m[0]), m1 = _mm_set_ps1(_m[1]);
+        const __m128 m2 = _mm_set_ps1(_m[2]), m3 = _mm_set_ps1(_m[3]);
+        const __m128 o0 = _mm_set_ps1(_o[0]), o1 = _mm_set_ps1(_o[1]);
+        const __m128 min = _mm_set_ps1(-32768.f), max = _mm_set_ps1(32767.f);
+
+        size_t i = 0;
+        for (; i+3 < nsamps; i+=4){
+            /* load from input and deinterleave I and Q */
+            const __m128 tmplo = _mm_loadu_ps(reinterpret_cast<const float *>(input+i+0));
+            const __m128 tmphi = _mm_loadu_ps(reinterpret_cast<const float *>(input+i+2));
+            const __m128 re = _mm_shuffle_ps(tmplo, tmphi, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 im = _mm_shuffle_ps(tmplo, tmphi, _MM_SHUFFLE(3, 1, 3, 1));
+
+            /* apply the matrix and offset, then clip to the sc16 range */
+            __m128 outre = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, re), _mm_mul_ps(m1, im)), o0);
+            __m128 outim = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, re), _mm_mul_ps(m3, im)), o1);
+            outre = _mm_min_ps(_mm_max_ps(outre, min), max);
+            outim = _mm_min_ps(_mm_max_ps(outim, min), max);
+
+            /* convert to 16 bit and interleave the item halves */
+            __m128i tmpi;
+            if (swap_bytes){
+                /* I in the lower, Q in the upper half, then byteswap 16 bit words */
+                tmpi = _mm_packs_epi32(_mm_cvtps_epi32(outre), _mm_cvtps_epi32(outim));
+                tmpi = _mm_unpacklo_epi16(tmpi, _mm_srli_si128(tmpi, 8));
+                tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8));
+            }
+            else{
+                /* Q in the lower, I in the upper half */
+                tmpi = _mm_packs_epi32(_mm_cvtps_epi32(outim), _mm_cvtps_epi32(outre));
+                tmpi = _mm_unpacklo_epi16(tmpi, _mm_srli_si128(tmpi, 8));
+            }
+
+            /* store to output */
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(output+i), tmpi);
+        }
+
+        //convert any remaining samples
+        fc32_to_item32_sc16_corrected<to_wire>(input+i, output+i, nsamps-i, _m, _o);
+    }
+};
+
+static converter::sptr make_convert_sc16_item32_le_1_to_fc32_1_corrected_sse2(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected_sse2<uhd::wtohx, false>());
+}
+
+static converter::sptr make_convert_sc16_item32_be_1_to_fc32_1_corrected_sse2(void){
+    return converter::sptr(new convert_sc16_item32_1_to_fc32_1_corrected_sse2<uhd::ntohx, true>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc16_item32_le_1_corrected_sse2(void){
+    return converter::sptr(new convert_fc32_1_to_sc16_item32_1_corrected_sse2<uhd::htowx, false>());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc16_item32_be_1_corrected_sse2(void){
+    return converter::sptr(new convert_fc32_1_to_sc16_item32_1_corrected_sse2<uhd::htonx, true>());
+}
+
+UHD_STATIC_BLOCK(register_convert_correction_sse2)
+{
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    id.output_format = "fc32";
+    id.input_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_le_1_to_fc32_1_corrected_sse2, PRIORITY_CORRECTION);
+    id.input_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_item32_be_1_to_fc32_1_corrected_sse2, PRIORITY_CORRECTION);
+
+    id.input_format = "fc32";
+    id.output_format = "sc16_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc16_item32_le_1_corrected_sse2, PRIORITY_CORRECTION);
+    id.output_format = "sc16_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc16_item32_be_1_corrected_sse2, PRIORITY_CORRECTION);
+}
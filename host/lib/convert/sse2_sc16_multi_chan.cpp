@@ -0,0 +1,282 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * Multi-channel sc16 converters:
+ * The items of all channels are interleaved sample by sample on the wire.
+ * A 32-bit shuffle (2 channels) or a 4x4 transpose (4 channels) gathers
+ * 4 items of each channel into one register (or scatters them back),
+ * the rest of the conversion is the same as for a single channel.
+ **********************************************************************/
+enum sc16_wire_type{
+    SC16_ITEM32_LE,  //I in the upper 16 bits of a little endian item32
+    SC16_ITEM32_BE,  //I in the upper 16 bits of a big endian item32
+    SC16_ITEM16_USRP1 //little endian I and Q words, in host order on x86
+};
+
+//put 4 samples from the wire into std::complex<int16> order, or back
+template <sc16_wire_type wire> static UHD_INLINE __m128i swap_sc16_sse2(__m128i x){
+    switch (wire){
+    case SC16_ITEM32_LE:
+        x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    case SC16_ITEM32_BE:
+        return _mm_or_si128(_mm_srli_epi16(x, 8), _mm_slli_epi16(x, 8));
+    default:
+        return x;
+    }
+}
+
+//convert one item for the samples that do not fill a register
+template <sc16_wire_type wire, typename T> static UHD_INLINE item32_t xx_to_wire_sc16(
+    const std::complex<T> &num, const double scale_factor
+){
+    const item32_t item = xx_to_item32_sc16_x1(num, scale_factor);
+    switch (wire){
+    case SC16_ITEM32_LE: return uhd::htowx(item);
+    case SC16_ITEM32_BE: return uhd::htonx(item);
+    default: return (item << 16) | (item >> 16);
+    }
+}
+
+template <sc16_wire_type wire, typename T> static UHD_INLINE std::complex<T> wire_sc16_to_xx(
+    const item32_t item, const double scale_factor
+){
+    switch (wire){
+    case SC16_ITEM32_LE: return item32_sc16_x1_to_xx<T>(uhd::wtohx(item), scale_factor);
+    case SC16_ITEM32_BE: return item32_sc16_x1_to_xx<T>(uhd::ntohx(item), scale_factor);
+    default: return item32_sc16_x1_to_xx<T>((item << 16) | (item >> 16), scale_factor);
+    }
+}
+
+//store 4 samples in std::complex<int16> order
+static UHD_INLINE void store_sc16_sse2(const __m128i &samps, fc32_t *output, const __m128 &scalar){
+    const __m128i zeroi = _mm_setzero_si128();
+    __m128i tmpilo = _mm_unpacklo_epi16(zeroi, samps); /* value in upper 16 bits */
+    __m128i tmpihi = _mm_unpackhi_epi16(zeroi, samps);
+    _mm_storeu_ps(reinterpret_cast<float *>(output+0), _mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar));
+    _mm_storeu_ps(reinterpret_cast<float *>(output+2), _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar));
+}
+
+static UHD_INLINE void store_sc16_sse2(const __m128i &samps, sc16_t *output, const __m128 &){
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output), samps);
+}
+
+//load 4 samples in std::complex<int16> order
+static UHD_INLINE __m128i load_sc16_sse2(const fc32_t *input, const __m128 &scalar){
+    __m128 tmplo = _mm_loadu_ps(reinterpret_cast<const float *>(input+0));
+    __m128 tmphi = _mm_loadu_ps(reinterpret_cast<const float *>(input+2));
+    __m128i tmpilo = _mm_cvtps_epi32(_mm_mul_ps(tmplo, scalar));
+    __m128i tmpihi = _mm_cvtps_epi32(_mm_mul_ps(tmphi, scalar));
+    return _mm_packs_epi32(tmpilo, tmpihi);
+}
+
+static UHD_INLINE __m128i load_sc16_sse2(const sc16_t *input, const __m128 &){
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+}
+
+/***********************************************************************
+ * Deinterleave: 1 wire stream to 2 or 4 host buffers
+ **********************************************************************/
+template <sc16_wire_type wire, typename T>
+static void deinterleave_sc16_1_to_2_sse2(
+    const item32_t *input, std::complex<T> *output0, std::complex<T> *output1,
+    const size_t nsamps, const double scale_factor
+){
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load 4 items from each channel */
+        __m128i tmp0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+2*i+0));
+        __m128i tmp1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+2*i+4));
+
+        /* a0 b0 a1 b1 -> a0 a1 b0 b1 */
+        tmp0 = _mm_shuffle_epi32(tmp0, _MM_SHUFFLE(3, 1, 2, 0));
+        tmp1 = _mm_shuffle_epi32(tmp1, _MM_SHUFFLE(3, 1, 2, 0));
+
+        /* convert and store each channel */
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpacklo_epi64(tmp0, tmp1)), output0+i, scalar);
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpackhi_epi64(tmp0, tmp1)), output1+i, scalar);
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        output0[i] = wire_sc16_to_xx<wire, T>(input[2*i+0], scale_factor);
+        output1[i] = wire_sc16_to_xx<wire, T>(input[2*i+1], scale_factor);
+    }
+}
+
+template <sc16_wire_type wire, typename T>
+static void deinterleave_sc16_1_to_4_sse2(
+    const item32_t *input, std::complex<T> *output0, std::complex<T> *output1,
+    std::complex<T> *output2, std::complex<T> *output3,
+    const size_t nsamps, const double scale_factor
+){
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load 4 items from each channel */
+        __m128i tmp0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+0));
+        __m128i tmp1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+4));
+        __m128i tmp2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+8));
+        __m128i tmp3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+4*i+12));
+
+        /* transpose the 4x4 items */
+        __m128i ab01 = _mm_unpacklo_epi32(tmp0, tmp1);
+        __m128i ab23 = _mm_unpacklo_epi32(tmp2, tmp3);
+        __m128i cd01 = _mm_unpackhi_epi32(tmp0, tmp1);
+        __m128i cd23 = _mm_unpackhi_epi32(tmp2, tmp3);
+
+        /* convert and store each channel */
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpacklo_epi64(ab01, ab23)), output0+i, scalar);
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpackhi_epi64(ab01, ab23)), output1+i, scalar);
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpacklo_epi64(cd01, cd23)), output2+i, scalar);
+        store_sc16_sse2(swap_sc16_sse2<wire>(_mm_unpackhi_epi64(cd01, cd23)), output3+i, scalar);
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        output0[i] = wire_sc16_to_xx<wire, T>(input[4*i+0], scale_factor);
+        output1[i] = wire_sc16_to_xx<wire, T>(input[4*i+1], scale_factor);
+        output2[i] = wire_sc16_to_xx<wire, T>(input[4*i+2], scale_factor);
+        output3[i] = wire_sc16_to_xx<wire, T>(input[4*i+3], scale_factor);
+    }
+}
+
+#define DECLARE_DEINTERLEAVE_SC16_SSE2(wire_name, wire, cpu_type) \
+    DECLARE_CONVERTER(wire_name, 1, cpu_type, 2, PRIORITY_SIMD){ \
+        deinterleave_sc16_1_to_2_sse2<wire>( \
+            reinterpret_cast<const item32_t *>(inputs[0]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[0]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[1]), \
+            nsamps, scale_factor); \
+    } \
+    DECLARE_CONVERTER(wire_name, 1, cpu_type, 4, PRIORITY_SIMD){ \
+        deinterleave_sc16_1_to_4_sse2<wire>( \
+            reinterpret_cast<const item32_t *>(inputs[0]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[0]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[1]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[2]), \
+            reinterpret_cast<cpu_type ## _t *>(outputs[3]), \
+            nsamps, scale_factor); \
+    }
+
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item32_le, SC16_ITEM32_LE, fc32)
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item32_le, SC16_ITEM32_LE, sc16)
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item32_be, SC16_ITEM32_BE, fc32)
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item32_be, SC16_ITEM32_BE, sc16)
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item16_usrp1, SC16_ITEM16_USRP1, fc32)
+DECLARE_DEINTERLEAVE_SC16_SSE2(sc16_item16_usrp1, SC16_ITEM16_USRP1, sc16)
+
+/***********************************************************************
+ * Interleave: 2 or 4 host buffers to 1 wire stream
+ **********************************************************************/
+template <sc16_wire_type wire, typename T>
+static void interleave_sc16_2_to_1_sse2(
+    const std::complex<T> *input0, const std::complex<T> *input1, item32_t *output,
+    const size_t nsamps, const double scale_factor
+){
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load and convert 4 samples from each channel */
+        __m128i tmp0 = swap_sc16_sse2<wire>(load_sc16_sse2(input0+i, scalar));
+        __m128i tmp1 = swap_sc16_sse2<wire>(load_sc16_sse2(input1+i, scalar));
+
+        /* interleave and store */
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+2*i+0), _mm_unpacklo_epi32(tmp0, tmp1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+2*i+4), _mm_unpackhi_epi32(tmp0, tmp1));
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        output[2*i+0] = xx_to_wire_sc16<wire>(input0[i], scale_factor);
+        output[2*i+1] = xx_to_wire_sc16<wire>(input1[i], scale_factor);
+    }
+}
+
+template <sc16_wire_type wire, typename T>
+static void interleave_sc16_4_to_1_sse2(
+    const std::complex<T> *input0, const std::complex<T> *input1,
+    const std::complex<T> *input2, const std::complex<T> *input3,
+    item32_t *output, const size_t nsamps, const double scale_factor
+){
+    const __m128 scalar = _mm_set_ps1(float(scale_factor));
+
+    size_t i = 0;
+    for (; i+3 < nsamps; i+=4){
+        /* load and convert 4 samples from each channel */
+        __m128i tmp0 = swap_sc16_sse2<wire>(load_sc16_sse2(input0+i, scalar));
+        __m128i tmp1 = swap_sc16_sse2<wire>(load_sc16_sse2(input1+i, scalar));
+        __m128i tmp2 = swap_sc16_sse2<wire>(load_sc16_sse2(input2+i, scalar));
+        __m128i tmp3 = swap_sc16_sse2<wire>(load_sc16_sse2(input3+i, scalar));
+
+        /* transpose the 4x4 items */
+        __m128i ab01 = _mm_unpacklo_epi32(tmp0, tmp1);
+        __m128i cd01 = _mm_unpacklo_epi32(tmp2, tmp3);
+        __m128i ab23 = _mm_unpackhi_epi32(tmp0, tmp1);
+        __m128i cd23 = _mm_unpackhi_epi32(tmp2, tmp3);
+
+        /* store to output */
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+0), _mm_unpacklo_epi64(ab01, cd01));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+4), _mm_unpackhi_epi64(ab01, cd01));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+8), _mm_unpacklo_epi64(ab23, cd23));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output+4*i+12), _mm_unpackhi_epi64(ab23, cd23));
+    }
+
+    // convert any remaining samples
+    for (; i < nsamps; i++){
+        output[4*i+0] = xx_to_wire_sc16<wire>(input0[i], scale_factor);
+        output[4*i+1] = xx_to_wire_sc16<wire>(input1[i], scale_factor);
+        output[4*i+2] = xx_to_wire_sc16<wire>(input2[i], scale_factor);
+        output[4*i+3] = xx_to_wire_sc16<wire>(input3[i], scale_factor);
+    }
+}
+
+#define DECLARE_INTERLEAVE_SC16_SSE2(wire_name, wire, cpu_type) \
+    DECLARE_CONVERTER(cpu_type, 2, wire_name, 1, PRIORITY_SIMD){ \
+        interleave_sc16_2_to_1_sse2<wire>( \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[0]), \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[1]), \
+            reinterpret_cast<item32_t *>(outputs[0]), \
+            nsamps, scale_factor); \
+    } \
+    DECLARE_CONVERTER(cpu_type, 4, wire_name, 1, PRIORITY_SIMD){ \
+        interleave_sc16_4_to_1_sse2<wire>( \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[0]), \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[1]), \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[2]), \
+            reinterpret_cast<const cpu_type ## _t *>(inputs[3]), \
+            reinterpret_cast<item32_t *>(outputs[0]), \
+            nsamps, scale_factor); \
+    }
+
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item32_le, SC16_ITEM32_LE, fc32)
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item32_le, SC16_ITEM32_LE, sc16)
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item32_be, SC16_ITEM32_BE, fc32)
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item32_be, SC16_ITEM32_BE, sc16)
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item16_usrp1, SC16_ITEM16_USRP1, fc32)
+DECLARE_INTERLEAVE_SC16_SSE2(sc16_item16_usrp1, SC16_ITEM16_USRP1, sc16)
@@ -0,0 +1,205 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_common.hpp"
+#include <uhd/utils/byteswap.hpp>
+#include <emmintrin.h>
+#include <algorithm>
+
+using namespace uhd::convert;
+
+/***********************************************************************
+ * Converters that write the host buffer with non-temporal stores.
+ * When the host buffer is much larger than the cache, regular stores
+ * first read every output line into the cache and then evict the packet
+ * buffers and the rest of the working set to make room for samples that
+ * the application only reads much later. Streaming stores skip both.
+ * These are registered with PRIORITY_NON_TEMPORAL and are only used
+ * when explicitly requested (see the nt_stores stream args).
+ **********************************************************************/
+
+/*!
+ * Number of samples to convert with scalar code until the output is
+ * 16-byte aligned. Returns 0 when the output can never be aligned,
+ * the caller then falls back to unaligned regular stores.
+ */
+template <typename T> static UHD_INLINE size_t nt_head_nsamps(const T *output, const size_t nsamps){
+    if ((size_t(output) % sizeof(T)) != 0) return 0;
+    return std::min(nsamps, ((16 - (size_t(output) & 0xf)) & 0xf)/sizeof(T));
+}
+
+DECLARE_CONVERTER(sc16_item32_le, 1, fc32, 1, PRIORITY_NON_TEMPORAL){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+    const __m128i zeroi = _mm_setzero_si128();
+
+    // this macro converts 4 values at a time and stores them with _st_
+    #define convert_item32_1_to_fc32_1_nswap_nt_guts(_st_)              \
+    for (; i+3 < nsamps; i+=4){                                         \
+        /* load from input */                                           \
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
+                                                                        \
+        /* unpack + swap 16-bit pairs */                                \
+        tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));      \
+        tmpi = _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));      \
+        __m128i tmpilo = _mm_unpacklo_epi16(zeroi, tmpi); /* value in upper 16 bits */ \
+        __m128i tmpihi = _mm_unpackhi_epi16(zeroi, tmpi);               \
+                                                                        \
+        /* convert and scale */                                         \
+        __m128 tmplo = _mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar);     \
+        __m128 tmphi = _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar);     \
+                                                                        \
+        /* store to output */                                           \
+        _mm_ ## _st_ ## _ps(reinterpret_cast<float *>(output+i+0), tmplo); \
+        _mm_ ## _st_ ## _ps(reinterpret_cast<float *>(output+i+2), tmphi); \
+    }                                                                   \
+
+    // convert the samples up to the first 16-byte aligned output
+    size_t i = nt_head_nsamps(output, nsamps);
+    item32_sc16_to_xx<uhd::htowx>(input, output, i, scale_factor);
+
+    if ((size_t(output+i) & 0xf) == 0){
+        // stream the bulk of the samples, bypassing the cache
+        convert_item32_1_to_fc32_1_nswap_nt_guts(stream)
+        _mm_sfence();
+    }
+    else{
+        // the output can not be aligned, use regular unaligned stores
+        convert_item32_1_to_fc32_1_nswap_nt_guts(storeu)
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER(sc16_item32_be, 1, fc32, 1, PRIORITY_NON_TEMPORAL){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    fc32_t *output = reinterpret_cast<fc32_t *>(outputs[0]);
+
+    const __m128 scalar = _mm_set_ps1(float(scale_factor)/(1 << 16));
+    const __m128i zeroi = _mm_setzero_si128();
+
+    // this macro converts 4 values at a time and stores them with _st_
+    #define convert_item32_1_to_fc32_1_bswap_nt_guts(_st_)              \
+    for (; i+3 < nsamps; i+=4){                                         \
+        /* load from input */                                           \
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
+                                                                        \
+        /* byteswap + unpack -> byteswap 16 bit words */                \
+        tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8)); \
+        __m128i tmpilo = _mm_unpacklo_epi16(zeroi, tmpi); /* value in upper 16 bits */ \
+        __m128i tmpihi = _mm_unpackhi_epi16(zeroi, tmpi);               \
+                                                                        \
+        /* convert and scale */                                         \
+        __m128 tmplo = _mm_mul_ps(_mm_cvtepi32_ps(tmpilo), scalar);     \
+        __m128 tmphi = _mm_mul_ps(_mm_cvtepi32_ps(tmpihi), scalar);     \
+                                                                        \
+        /* store to output */                                           \
+        _mm_ ## _st_ ## _ps(reinterpret_cast<float *>(output+i+0), tmplo); \
+        _mm_ ## _st_ ## _ps(reinterpret_cast<float *>(output+i+2), tmphi); \
+    }                                                                   \
+
+    // convert the samples up to the first 16-byte aligned output
+    size_t i = nt_head_nsamps(output, nsamps);
+    item32_sc16_to_xx<uhd::htonx>(input, output, i, scale_factor);
+
+    if ((size_t(output+i) & 0xf) == 0){
+        // stream the bulk of the samples, bypassing the cache
+        convert_item32_1_to_fc32_1_bswap_nt_guts(stream)
+        _mm_sfence();
+    }
+    else{
+        // the output can not be aligned, use regular unaligned stores
+        convert_item32_1_to_fc32_1_bswap_nt_guts(storeu)
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::htonx>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER(sc16_item32_le, 1, sc16, 1, PRIORITY_NON_TEMPORAL){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    // this macro converts 4 values at a time and stores them with _st_
+    #define convert_item32_1_to_sc16_1_nswap_nt_guts(_st_)              \
+    for (; i+3 < nsamps; i+=4){                                         \
+        /* load from input */                                           \
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
+                                                                        \
+        /* swap 16-bit pairs */                                         \
+        tmpi = _mm_shufflelo_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));      \
+        tmpi = _mm_shufflehi_epi16(tmpi, _MM_SHUFFLE(2, 3, 0, 1));      \
+                                                                        \
+        /* store to output */                                           \
+        _mm_ ## _st_ ## _si128(reinterpret_cast<__m128i *>(output+i), tmpi); \
+    }                                                                   \
+
+    // convert the samples up to the first 16-byte aligned output
+    size_t i = nt_head_nsamps(output, nsamps);
+    item32_sc16_to_xx<uhd::htowx>(input, output, i, scale_factor);
+
+    if ((size_t(output+i) & 0xf) == 0){
+        // stream the bulk of the samples, bypassing the cache
+        convert_item32_1_to_sc16_1_nswap_nt_guts(stream)
+        _mm_sfence();
+    }
+    else{
+        // the output can not be aligned, use regular unaligned stores
+        convert_item32_1_to_sc16_1_nswap_nt_guts(storeu)
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::htowx>(input+i, output+i, nsamps-i, scale_factor);
+}
+
+DECLARE_CONVERTER(sc16_item32_be, 1, sc16, 1, PRIORITY_NON_TEMPORAL){
+    const item32_t *input = reinterpret_cast<const item32_t *>(inputs[0]);
+    sc16_t *output = reinterpret_cast<sc16_t *>(outputs[0]);
+
+    // this macro converts 4 values at a time and stores them with _st_
+    #define convert_item32_1_to_sc16_1_bswap_nt_guts(_st_)              \
+    for (; i+3 < nsamps; i+=4){                                         \
+        /* load from input */                                           \
+        __m128i tmpi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input+i)); \
+                                                                        \
+        /* byteswap 16 bit words */                                     \
+        tmpi = _mm_or_si128(_mm_srli_epi16(tmpi, 8), _mm_slli_epi16(tmpi, 8)); \
+                                                                        \
+        /* store to output */                                           \
+        _mm_ ## _st_ ## _si128(reinterpret_cast<__m128i *>(output+i), tmpi); \
+    }                                                                   \
+
+    // convert the samples up to the first 16-byte aligned output
+    size_t i = nt_head_nsamps(output, nsamps);
+    item32_sc16_to_xx<uhd::htonx>(input, output, i, scale_factor);
+
+    if ((size_t(output+i) & 0xf) == 0){
+        // stream the bulk of the samples, bypassing the cache
+        convert_item32_1_to_sc16_1_bswap_nt_guts(stream)
+        _mm_sfence();
+    }
+    else{
+        // the output can not be aligned, use regular unaligned stores
+        convert_item32_1_to_sc16_1_bswap_nt_guts(storeu)
+    }
+
+    // convert any remaining samples
+    item32_sc16_to_xx<uhd::htonx>(input+i, output+i, nsamps-i, scale_factor);
+}
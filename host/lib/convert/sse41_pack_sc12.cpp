@@ -0,0 +1,131 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_cpu_features.hpp"
+#include <smmintrin.h>
+
+using namespace uhd::convert;
+
+/*
+ * Pack eight 12-bit numbers (I0 Q0 I1 Q1 ... Q3, in the low bits of 16-bit
+ * words) into one 3 line block.
+ *
+ * The multiply-add combines each pair of numbers into a 24-bit value,
+ * then the shuffle moves the three bytes of each value into place.
+ * The le shuffle also applies the byte order of the 32-bit lines.
+ * The block is written with one 8 byte and one 4 byte store,
+ * so nothing past the end of the block is touched.
+ */
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE void pack_sc12_block_sse41(
+    const __m128i &nums, item32_sc12_3x &output, const __m128i &shuf
+){
+    const __m128i pairs = _mm_madd_epi16(nums, _mm_set1_epi32(0x00011000));
+    const __m128i lines = _mm_shuffle_epi8(pairs, shuf);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(&output.line0), lines);
+    output.line2 = item32_t(_mm_extract_epi32(lines, 2));
+}
+
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE __m128i pack_sc12_shuffle_sse41(const bool wire_le){
+    return (wire_le)?
+        _mm_set_epi8(-1, -1, -1, -1, 8, 14, 13, 12, 5, 4, 10, 9, 2, 1, 0, 6):
+        _mm_set_epi8(-1, -1, -1, -1, 12, 13, 14, 8, 9, 10, 4, 5, 6, 0, 1, 2);
+}
+
+/*
+ * Scale four floats and truncate them to 12 bits. The multiply is done in
+ * double precision like the scalar code, so that both produce exactly the
+ * same numbers, and the truncation to 12 bits wraps instead of saturating.
+ */
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE __m128i scale_sc12_sse41(
+    const __m128 &in, const __m128d &scalar
+){
+    const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(in), scalar));
+    const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(in, in)), scalar));
+    return _mm_and_si128(_mm_cvttps_epi32(_mm_movelh_ps(lo, hi)), _mm_set1_epi32(0xfff));
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_SSE41 void convert_fc32_to_sc12_item32_blocks_sse41(
+    const fc32_t *input, item32_sc12_3x *output, const size_t nblocks, const double scalar
+){
+    const __m128i shuf = pack_sc12_shuffle_sse41(wire_le);
+    const __m128d scalar_pd = _mm_set1_pd(scalar);
+
+    for (size_t i = 0; i < nblocks; i++, input += 4){
+        const __m128i lo = scale_sc12_sse41(_mm_loadu_ps(reinterpret_cast<const float *>(input+0)), scalar_pd);
+        const __m128i hi = scale_sc12_sse41(_mm_loadu_ps(reinterpret_cast<const float *>(input+2)), scalar_pd);
+        pack_sc12_block_sse41(_mm_packus_epi32(lo, hi), output[i], shuf);
+    }
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_SSE41 void convert_sc16_to_sc12_item32_blocks_sse41(
+    const sc16_t *input, item32_sc12_3x *output, const size_t nblocks, const double
+){
+    const __m128i shuf = pack_sc12_shuffle_sse41(wire_le);
+
+    /* the logical shift keeps the upper 12 bits of each number */
+    for (size_t i = 0; i < nblocks; i++, input += 4){
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+        pack_sc12_block_sse41(_mm_srli_epi16(in, 4), output[i], shuf);
+    }
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_le_1_sse41(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::wtohx, convert_fc32_to_sc12_item32_blocks_sse41<true> >());
+}
+
+static converter::sptr make_convert_fc32_1_to_sc12_item32_be_1_sse41(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<float, uhd::ntohx, convert_fc32_to_sc12_item32_blocks_sse41<false> >());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_le_1_sse41(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<s16_t, uhd::wtohx, convert_sc16_to_sc12_item32_blocks_sse41<true> >());
+}
+
+static converter::sptr make_convert_sc16_1_to_sc12_item32_be_1_sse41(void)
+{
+    return converter::sptr(new convert_star_1_to_sc12_item32_1<s16_t, uhd::ntohx, convert_sc16_to_sc12_item32_blocks_sse41<false> >());
+}
+
+UHD_STATIC_BLOCK(register_sse41_pack_sc12)
+{
+    if (not cpu_has_sse41()) return;
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.input_format = "fc32";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_le_1_sse41, PRIORITY_SIMD);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_fc32_1_to_sc12_item32_be_1_sse41, PRIORITY_SIMD);
+
+    id.input_format = "sc16";
+
+    id.output_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_le_1_sse41, PRIORITY_SIMD);
+
+    id.output_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc16_1_to_sc12_item32_be_1_sse41, PRIORITY_SIMD);
+}
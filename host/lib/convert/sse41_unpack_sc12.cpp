@@ -0,0 +1,136 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_sc12.hpp"
+#include "convert_cpu_features.hpp"
+#include <smmintrin.h>
+
+using namespace uhd::convert;
+
+/*
+ * Unpack one 3 line block into eight 16-bit numbers (I0 Q0 I1 Q1 ... Q3),
+ * each with the 12-bit value in the upper bits, just like the scalar code.
+ *
+ * The shuffle moves the two bytes that hold a number into one 16-bit word.
+ * Numbers at even positions start on a byte boundary and only need their low
+ * nibble masked off, numbers at odd positions start on a nibble boundary and
+ * are moved up by 4 bits with the multiply. The le shuffle also undoes the
+ * byte order of the 32-bit lines, so there is no separate byteswap.
+ */
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE __m128i unpack_sc12_block_sse41(
+    const item32_sc12_3x &input, const __m128i &shuf
+){
+    __m128i in = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&input.line0));
+    in = _mm_insert_epi32(in, int(input.line2), 2);
+    const __m128i words = _mm_shuffle_epi8(in, shuf);
+    const __m128i shift = _mm_set_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+    return _mm_and_si128(_mm_mullo_epi16(words, shift), _mm_set1_epi16(short(0xfff0)));
+}
+
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE __m128i unpack_sc12_shuffle_sse41(const bool wire_le){
+    return (wire_le)?
+        _mm_set_epi8(9, 8, 10, 9, 4, 11, 5, 4, 7, 6, 0, 7, 2, 1, 3, 2):
+        _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+}
+
+/*
+ * Scale four numbers to float. The multiply is done in double precision
+ * like the scalar code, so that both produce exactly the same floats.
+ */
+UHD_CONVERT_TARGET_SSE41 static UHD_INLINE __m128 scale_sc12_sse41(
+    const __m128i &nums, const __m128d &scalar
+){
+    const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(nums), scalar));
+    const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(nums, nums)), scalar));
+    return _mm_movelh_ps(lo, hi);
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_SSE41 void convert_sc12_item32_blocks_to_fc32_sse41(
+    const item32_sc12_3x *input, fc32_t *output, const size_t nblocks, const double scalar
+){
+    const __m128i shuf = unpack_sc12_shuffle_sse41(wire_le);
+    const __m128d scalar_pd = _mm_set1_pd(scalar);
+
+    for (size_t i = 0; i < nblocks; i++, output += 4){
+        const __m128i nums = unpack_sc12_block_sse41(input[i], shuf);
+
+        /* sign extend to 32 bits, convert and scale */
+        const __m128i lo = _mm_cvtepi16_epi32(nums);
+        const __m128i hi = _mm_cvtepi16_epi32(_mm_unpackhi_epi64(nums, nums));
+
+        /* store to output */
+        _mm_storeu_ps(reinterpret_cast<float *>(output+0), scale_sc12_sse41(lo, scalar_pd));
+        _mm_storeu_ps(reinterpret_cast<float *>(output+2), scale_sc12_sse41(hi, scalar_pd));
+    }
+}
+
+template <bool wire_le>
+UHD_CONVERT_TARGET_SSE41 void convert_sc12_item32_blocks_to_sc16_sse41(
+    const item32_sc12_3x *input, sc16_t *output, const size_t nblocks, const double
+){
+    const __m128i shuf = unpack_sc12_shuffle_sse41(wire_le);
+
+    for (size_t i = 0; i < nblocks; i++, output += 4){
+        const __m128i nums = unpack_sc12_block_sse41(input[i], shuf);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output), nums);
+    }
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_fc32_1_sse41(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::wtohx, convert_sc12_item32_blocks_to_fc32_sse41<true> >());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_fc32_1_sse41(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<float, uhd::ntohx, convert_sc12_item32_blocks_to_fc32_sse41<false> >());
+}
+
+static converter::sptr make_convert_sc12_item32_le_1_to_sc16_1_sse41(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<s16_t, uhd::wtohx, convert_sc12_item32_blocks_to_sc16_sse41<true> >());
+}
+
+static converter::sptr make_convert_sc12_item32_be_1_to_sc16_1_sse41(void)
+{
+    return converter::sptr(new convert_sc12_item32_1_to_star_1<s16_t, uhd::ntohx, convert_sc12_item32_blocks_to_sc16_sse41<false> >());
+}
+
+UHD_STATIC_BLOCK(register_sse41_unpack_sc12)
+{
+    if (not cpu_has_sse41()) return;
+
+    uhd::convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+    id.output_format = "fc32";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_fc32_1_sse41, PRIORITY_SIMD);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_fc32_1_sse41, PRIORITY_SIMD);
+
+    id.output_format = "sc16";
+
+    id.input_format = "sc12_item32_le";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_le_1_to_sc16_1_sse41, PRIORITY_SIMD);
+
+    id.input_format = "sc12_item32_be";
+    uhd::convert::register_converter(id, &make_convert_sc12_item32_be_1_to_sc16_1_sse41, PRIORITY_SIMD);
+}
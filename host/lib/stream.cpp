@@ -16,15 +16,51 @@
 //
 
 #include <uhd/stream.hpp>
+#include <uhd/exception.hpp>
 
 using namespace uhd;
 
+rx_zero_copy_buffs::~rx_zero_copy_buffs(void)
+{
+    //empty
+}
+
 rx_streamer::~rx_streamer(void)
 {
     //empty
 }
 
+size_t rx_streamer::get_cpu_item_size(void) const
+{
+    return 0;
+}
+
+size_t rx_streamer::get_alignment_drops(const size_t) const
+{
+    return 0;
+}
+
+rx_zero_copy_buffs::sptr rx_streamer::recv_zero_copy(rx_metadata_t &, const double)
+{
+    throw uhd::not_implemented_error("this rx streamer cannot lend buffers, use recv()");
+}
+
+tx_zero_copy_buffs::~tx_zero_copy_buffs(void)
+{
+    //empty
+}
+
 tx_streamer::~tx_streamer(void)
 {
     //empty
 }
+
+tx_zero_copy_buffs::sptr tx_streamer::acquire_send_buffs(const double)
+{
+    throw uhd::not_implemented_error("this tx streamer cannot lend buffers, use send()");
+}
+
+size_t tx_streamer::commit_send_buffs(const tx_zero_copy_buffs::sptr &, const size_t, const tx_metadata_t &)
+{
+    throw uhd::not_implemented_error("this tx streamer cannot lend buffers, use send()");
+}
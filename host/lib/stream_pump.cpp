@@ -0,0 +1,172 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/stream_pump.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <map>
+#include <vector>
+
+using namespace uhd;
+
+rx_stream_pump::~rx_stream_pump(void){
+    /* NOP */
+}
+
+/***********************************************************************
+ * RX stream pump implementation
+ **********************************************************************/
+class rx_stream_pump_impl : public rx_stream_pump{
+public:
+    rx_stream_pump_impl(rx_streamer::sptr rx_stream, const stream_args_t &args):
+        _rx_stream(rx_stream),
+        _batch_nsamps(args.args.cast<size_t>("pump_batch_nsamps", rx_stream->get_max_num_samps())),
+        _recv_timeout(args.args.cast<double>("pump_recv_timeout", 0.1)),
+        _busy_retry_us(args.args.cast<long>("pump_busy_retry_us", 100)),
+        _next_sink_id(0)
+    {
+        if (_batch_nsamps == 0) throw uhd::value_error("rx_stream_pump: pump_batch_nsamps must not be 0");
+
+        //the samples are in the streamer's CPU format, which must match the args
+        const size_t bytes_per_item = convert::get_bytes_per_item(args.cpu_format);
+        const size_t stream_bytes_per_item = rx_stream->get_cpu_item_size();
+        if (stream_bytes_per_item != 0 and stream_bytes_per_item != bytes_per_item) throw uhd::value_error(str(boost::format(
+            "rx_stream_pump: the cpu_format %s has %u byte samples, the streamer has %u byte samples"
+        ) % args.cpu_format % bytes_per_item % stream_bytes_per_item));
+
+        //one batch buffer per channel, shared by all sinks
+        const size_t bytes_per_buff = _batch_nsamps*bytes_per_item;
+        _mems.resize(rx_stream->get_num_channels(), std::vector<char>(bytes_per_buff));
+        for (size_t i = 0; i < _mems.size(); i++){
+            _buffs.push_back(&_mems[i].front());
+            _const_buffs.push_back(&_mems[i].front());
+        }
+    }
+
+    ~rx_stream_pump_impl(void){
+        this->stop();
+    }
+
+    size_t add_sink(const sink_type &sink){
+        boost::mutex::scoped_lock lock(_mutex);
+        _sinks[_next_sink_id] = sink;
+        return _next_sink_id++;
+    }
+
+    void remove_sink(const size_t sink_id){
+        boost::mutex::scoped_lock lock(_mutex);
+        _sinks.erase(sink_id);
+    }
+
+    void start(void){
+        if (_task) return;
+        _task = task::make(boost::bind(&rx_stream_pump_impl::pump_task, this));
+    }
+
+    void stop(void){
+        _task.reset(); //interrupts and joins the pump thread
+    }
+
+    size_t get_num_stalls(void) const{
+        return _num_stalls.read();
+    }
+
+private:
+    typedef std::map<size_t, sink_type> sinks_type;
+
+    rx_streamer::sptr _rx_stream;
+    const size_t _batch_nsamps;
+    const double _recv_timeout;
+    const long _busy_retry_us;
+
+    std::vector<std::vector<char> > _mems;
+    std::vector<void *> _buffs;
+    std::vector<const void *> _const_buffs;
+
+    boost::mutex _mutex;
+    sinks_type _sinks;
+    size_t _next_sink_id;
+    mutable atomic_uint32_t _num_stalls;
+    task::sptr _task;
+
+    //! Receive one batch and push it into the sinks
+    void pump_task(void){
+        rx_metadata_t metadata;
+        const size_t nsamps = _rx_stream->recv(_buffs, _batch_nsamps, metadata, _recv_timeout);
+        if (metadata.error_code == rx_metadata_t::ERROR_CODE_TIMEOUT) return;
+        const buffs_type buffs(_const_buffs);
+
+        boost::mutex::scoped_lock lock(_mutex);
+        std::vector<size_t> pending;
+        BOOST_FOREACH(const sinks_type::value_type &sink, _sinks){
+            pending.push_back(sink.first);
+        }
+
+        //offer the batch until no sink is busy
+        while (not pending.empty()){
+            std::vector<size_t> busy;
+            BOOST_FOREACH(const size_t sink_id, pending){
+                sinks_type::iterator it = _sinks.find(sink_id);
+                if (it == _sinks.end()) continue; //removed while busy
+                switch (this->call_sink(it->second, buffs, nsamps, metadata)){
+                case SINK_CONSUMED: break;
+                case SINK_BUSY: busy.push_back(sink_id); break;
+                case SINK_DETACH: _sinks.erase(it); break;
+                }
+            }
+            if (busy.empty()) return;
+
+            //hold the stream, let the busy sinks catch up
+            _num_stalls.inc();
+            pending.swap(busy);
+            lock.unlock();
+            boost::this_thread::sleep(boost::posix_time::microseconds(_busy_retry_us));
+            lock.lock();
+        }
+    }
+
+    //! Call a sink, a sink that throws is detached
+    sink_result_t call_sink(
+        const sink_type &sink,
+        const buffs_type &buffs,
+        const size_t nsamps,
+        const rx_metadata_t &metadata
+    ){
+        try{
+            return sink(buffs, nsamps, metadata);
+        }
+        catch(const std::exception &e){
+            UHD_MSG(error) << "rx_stream_pump: a sink threw and is detached: " << e.what() << std::endl;
+        }
+        return SINK_DETACH;
+    }
+};
+
+/***********************************************************************
+ * RX stream pump factory function
+ **********************************************************************/
+rx_stream_pump::sptr rx_stream_pump::make(rx_streamer::sptr rx_stream, const stream_args_t &args){
+    return sptr(new rx_stream_pump_impl(rx_stream, args));
+}
@@ -0,0 +1,671 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/transport/af_packet_zero_copy.hpp>
+#include <uhd/exception.hpp>
+
+#ifdef HAVE_AF_PACKET
+
+#include "udp_common.hpp"
+#include "zero_copy_counters.hpp"
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp> //sleep
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <ifaddrs.h>
+#include <unistd.h>
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+
+using namespace uhd;
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+//! IPv4 header without options and UDP header in front of the payload
+static const size_t IP_HDR_LEN = 20, UDP_HDR_LEN = 8;
+
+//! Where the frame data starts in a TPACKET_V2 send ring frame
+static const size_t TX_DATA_OFFSET = TPACKET_ALIGN(sizeof(tpacket2_hdr));
+
+static size_t round_up(const size_t num, const size_t multiple){
+    return ((num + multiple - 1)/multiple)*multiple;
+}
+
+static std::string errno_str(void){
+    return std::strerror(errno);
+}
+
+/***********************************************************************
+ * Receive ring block:
+ *  - the kernel fills a block with datagrams and hands it to the user
+ *  - the datagrams are handed out as managed buffers that point into the block
+ *  - the block goes back to the kernel when all buffers were released
+ **********************************************************************/
+class af_packet_rx_block;
+
+class af_packet_mrb : public managed_recv_buffer{
+public:
+    af_packet_mrb(af_packet_rx_block *block): _block(block) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len){
+        return make(this, mem, len);
+    }
+
+private:
+    af_packet_rx_block *_block;
+};
+
+class af_packet_rx_block{
+public:
+    typedef boost::shared_ptr<af_packet_rx_block> sptr;
+
+    af_packet_rx_block(void *mem, atomic_zero_copy_counters &counters):
+        _desc(reinterpret_cast<tpacket_block_desc *>(mem)),
+        _pkt(NULL), _num_pkts(0), _next_pkt(0), _counters(counters) { /*NOP*/ }
+
+    //! True when the kernel handed the block to the user
+    UHD_INLINE bool ready(void) const{
+        const boost::uint32_t status = *reinterpret_cast<volatile boost::uint32_t *>(&_desc->hdr.bh1.block_status);
+        return (status & TP_STATUS_USER) != 0;
+    }
+
+    //! Start reading a ready block, the reader holds one reference
+    UHD_INLINE void open(void){
+        __sync_synchronize(); //read the block after its status
+        _num_pkts = _desc->hdr.bh1.num_pkts;
+        _next_pkt = 0;
+        _pkt = reinterpret_cast<char *>(_desc) + _desc->hdr.bh1.offset_to_first_pkt;
+        _num_refs.write(boost::uint32_t(_num_pkts + 1));
+        while (_mrbs.size() < _num_pkts){
+            _mrbs.push_back(boost::make_shared<af_packet_mrb>(this));
+        }
+    }
+
+    //! True when all datagrams of the block were read
+    UHD_INLINE bool done(void) const{
+        return _next_pkt == _num_pkts;
+    }
+
+    /*!
+     * Get the next datagram of the block.
+     * Only UDP datagrams that were received pass the socket filter,
+     * everything else is skipped and yields a null buffer.
+     */
+    UHD_INLINE managed_recv_buffer::sptr get_next(void){
+        const tpacket3_hdr *hdr = reinterpret_cast<const tpacket3_hdr *>(_pkt);
+        _pkt += hdr->tp_next_offset;
+        af_packet_mrb &mrb = *_mrbs[_next_pkt++];
+        if (this->done()) this->release_one(); //the reader's reference
+
+        const sockaddr_ll *sll = reinterpret_cast<const sockaddr_ll *>(
+            reinterpret_cast<const char *>(hdr) + TPACKET_ALIGN(sizeof(tpacket3_hdr))
+        );
+        char *ip = const_cast<char *>(reinterpret_cast<const char *>(hdr)) + hdr->tp_net;
+        const size_t ip_hdr_len = size_t(ip[0] & 0xf)*4;
+        if (sll->sll_pkttype == PACKET_OUTGOING or hdr->tp_snaplen < ip_hdr_len + UDP_HDR_LEN){
+            this->release_one();
+            return managed_recv_buffer::sptr();
+        }
+
+        boost::uint16_t udp_len;
+        std::memcpy(&udp_len, ip + ip_hdr_len + 4, sizeof(udp_len));
+        const size_t len = std::min<size_t>(ntohs(udp_len), hdr->tp_snaplen - ip_hdr_len) - UDP_HDR_LEN;
+        return mrb.get_new(ip + ip_hdr_len + UDP_HDR_LEN, len);
+    }
+
+    //! Called by the buffers when the caller is done with them
+    UHD_INLINE void release_buff(void){
+        count_recv_release(_counters);
+        this->release_one();
+    }
+
+    //! Called for each reference, the last one returns the block to the kernel
+    UHD_INLINE void release_one(void){
+        if (_num_refs.dec() != 1) return;
+        __sync_synchronize(); //finish all reads before the kernel owns the block
+        *reinterpret_cast<volatile boost::uint32_t *>(&_desc->hdr.bh1.block_status) = TP_STATUS_KERNEL;
+    }
+
+private:
+    tpacket_block_desc *_desc;
+    char *_pkt;
+    size_t _num_pkts, _next_pkt;
+    atomic_uint32_t _num_refs;
+    std::vector<boost::shared_ptr<af_packet_mrb> > _mrbs;
+    atomic_zero_copy_counters &_counters;
+};
+
+void af_packet_mrb::release(void){
+    _block->release_buff();
+}
+
+/***********************************************************************
+ * Send ring frame:
+ *  - the buffer is the payload area of the frame
+ *  - commit writes the IP and UDP headers and sends the frame
+ **********************************************************************/
+class af_packet_msb : public managed_send_buffer{
+public:
+    typedef boost::function<void(tpacket2_hdr *, char *, size_t)> send_fcn_type;
+
+    af_packet_msb(void *frame, const size_t frame_size, const send_fcn_type &send_fcn, atomic_zero_copy_counters &counters):
+        _hdr(reinterpret_cast<tpacket2_hdr *>(frame)),
+        _data(reinterpret_cast<char *>(frame) + TX_DATA_OFFSET),
+        _frame_size(frame_size), _send_fcn(send_fcn), _counters(counters) { /*NOP*/ }
+
+    void release(void){
+        _send_fcn(_hdr, _data, size());
+        _claimer.release();
+    }
+
+    UHD_INLINE boost::uint32_t status(void) const{
+        return *reinterpret_cast<volatile boost::uint32_t *>(&_hdr->tp_status);
+    }
+
+    UHD_INLINE sptr get_new(const double timeout, size_t &index){
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.send_wait_time)) return sptr();
+
+        //wait for the kernel to finish sending the previous frame
+        if (this->status() != TP_STATUS_AVAILABLE){
+            counted_wait wait(_counters.send_wait_time);
+            if (not this->wait_for_kernel(timeout)) return sptr(); //null for timeout
+        }
+        __sync_synchronize(); //status before the frame
+
+        index++; //advances the caller's buffer
+        return make(this, _data + IP_HDR_LEN + UDP_HDR_LEN, _frame_size);
+    }
+
+private:
+    //! Poll the status of the frame, the claim is undone on timeout
+    bool wait_for_kernel(const double timeout){
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        while (this->status() != TP_STATUS_AVAILABLE){
+            if (this->status() == TP_STATUS_WRONG_FORMAT){
+                _claimer.release();
+                throw uhd::io_error("af_packet_zero_copy: the kernel rejected a frame of the send ring");
+            }
+            if (boost::get_system_time() > exit_time){
+                _claimer.release(); //undo claim
+                return false;
+            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(10));
+        }
+        return true;
+    }
+
+    tpacket2_hdr *_hdr;
+    char *_data;
+    size_t _frame_size;
+    send_fcn_type _send_fcn;
+    simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+/***********************************************************************
+ * Zero copy implementation with AF_PACKET packet rings:
+ *   A TPACKET_V3 receive ring and a TPACKET_V2 send ring,
+ *   on separate sockets that are bound to the interface of the route.
+ *   A regular UDP socket owns the local port, so that the kernel
+ *   does not answer the datagrams with port unreachable messages.
+ **********************************************************************/
+class af_packet_zero_copy_impl : public af_packet_zero_copy{
+public:
+    typedef boost::shared_ptr<af_packet_zero_copy_impl> sptr;
+
+    af_packet_zero_copy_impl(
+        const std::string &addr,
+        const std::string &port,
+        const zero_copy_xport_params& xport_params,
+        const size_t recv_ring_size,
+        const size_t send_ring_size,
+        const double recv_block_timeout
+    ):
+        _recv_frame_size(xport_params.recv_frame_size),
+        _num_recv_frames(xport_params.num_recv_frames),
+        _send_frame_size(xport_params.send_frame_size),
+        _num_send_frames(xport_params.num_send_frames),
+        _rx_fd(-1), _tx_fd(-1),
+        _rx_ring(NULL), _tx_ring(NULL), _rx_ring_len(0), _tx_ring_len(0),
+        _next_rx_block(0), _next_send_buff_index(0), _ip_id(0)
+    {
+        UHD_LOG << boost::format("Creating af_packet transport for %s %s") % addr % port << std::endl;
+
+        try{
+            this->setup_endpoints(addr, port);
+            this->setup_recv_ring(recv_ring_size, recv_block_timeout);
+            this->setup_send_ring(send_ring_size);
+        }
+        catch(...){
+            this->cleanup();
+            throw;
+        }
+    }
+
+    ~af_packet_zero_copy_impl(void){
+        this->cleanup();
+    }
+
+    size_t get_recv_ring_size(void) const {return _rx_ring_len;}
+    size_t get_send_ring_size(void) const {return _tx_ring_len;}
+
+    /*******************************************************************
+     * Receive implementation:
+     * Hand out the datagrams of the current block,
+     * then wait for the kernel to hand over the next block.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff = this->get_next_recv_buff(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_recv_buffer::sptr get_next_recv_buff(const double timeout){
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        while (true){
+            if (_rx_block and not _rx_block->done()){
+                managed_recv_buffer::sptr buff = _rx_block->get_next();
+                if (buff) return buff;
+                continue; //skipped a datagram
+            }
+
+            af_packet_rx_block::sptr &block = _rx_blocks[_next_rx_block];
+            if (not block->ready()){
+                const double time_left = double((exit_time - boost::get_system_time()).total_microseconds())/1e6;
+                bool ready = false;
+                if (time_left >= 0.0){
+                    counted_wait wait(_counters.recv_wait_time);
+                    ready = wait_for_recv_ready(_rx_fd, time_left);
+                }
+                if (not ready){
+                    if (not block->ready()) return managed_recv_buffer::sptr(); //null for timeout
+                }
+                continue;
+            }
+            block->open();
+            _rx_block = block;
+            _next_rx_block = (_next_rx_block + 1) % _rx_blocks.size();
+        }
+    }
+
+    size_t get_num_recv_frames(void) const {return _num_recv_frames;}
+    size_t get_recv_frame_size(void) const {return _recv_frame_size;}
+
+    /*******************************************************************
+     * Send implementation:
+     * Block on the managed buffer's get call and advance the index.
+     ******************************************************************/
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        if (_next_send_buff_index == _msb_pool.size()) _next_send_buff_index = 0;
+        managed_send_buffer::sptr buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        count_send_buff(_counters, buff);
+        return buff;
+    }
+
+    size_t get_num_send_frames(void) const {return _num_send_frames;}
+    size_t get_send_frame_size(void) const {return _send_frame_size;}
+
+    zero_copy_counters get_counters(void) const {return _counters.snapshot();}
+
+    boost::uint16_t get_local_port(void) const {return ntohs(_local_port);}
+
+private:
+    /*!
+     * Find the addresses for the headers and the interface for the rings:
+     * The local address and port come from a UDP socket connected to the endpoint,
+     * the hardware address of the endpoint comes from the kernel's neighbor table.
+     */
+    void setup_endpoints(const std::string &addr, const std::string &port){
+        asio::ip::udp::resolver resolver(_io_service);
+        asio::ip::udp::resolver::query query(asio::ip::udp::v4(), addr, port);
+        const asio::ip::udp::endpoint remote_endpoint = *resolver.resolve(query);
+
+        //the socket reserves the local port, its filter drops everything
+        _socket = socket_sptr(new asio::ip::udp::socket(_io_service));
+        _socket->open(asio::ip::udp::v4());
+        _socket->connect(remote_endpoint);
+        sock_filter drop_all = BPF_STMT(BPF_RET | BPF_K, 0);
+        sock_fprog drop_all_prog = {1, &drop_all};
+        if (::setsockopt(_socket->native(), SOL_SOCKET, SO_ATTACH_FILTER, &drop_all_prog, sizeof(drop_all_prog)) != 0){
+            throw uhd::os_error("af_packet_zero_copy: failed to filter the udp socket: " + errno_str());
+        }
+        const asio::ip::udp::endpoint local_endpoint = _socket->local_endpoint();
+
+        _local_addr = htonl(local_endpoint.address().to_v4().to_ulong());
+        _remote_addr = htonl(remote_endpoint.address().to_v4().to_ulong());
+        _local_port = htons(local_endpoint.port());
+        _remote_port = htons(remote_endpoint.port());
+
+        //find the interface with the local address
+        bool found = false, no_arp = false;
+        ifaddrs *ifas = NULL;
+        if (::getifaddrs(&ifas) != 0) throw uhd::os_error("af_packet_zero_copy: getifaddrs: " + errno_str());
+        for (ifaddrs *ifa = ifas; ifa != NULL; ifa = ifa->ifa_next){
+            if (ifa->ifa_addr == NULL or ifa->ifa_addr->sa_family != AF_INET) continue;
+            if (reinterpret_cast<sockaddr_in *>(ifa->ifa_addr)->sin_addr.s_addr != _local_addr) continue;
+            const boost::uint32_t mask = reinterpret_cast<sockaddr_in *>(ifa->ifa_netmask)->sin_addr.s_addr;
+            no_arp = (ifa->ifa_flags & (IFF_LOOPBACK | IFF_NOARP)) != 0;
+            if (not no_arp and (_local_addr & mask) != (_remote_addr & mask)){
+                ::freeifaddrs(ifas);
+                throw uhd::value_error(str(boost::format(
+                    "af_packet_zero_copy: %s is not on the network of interface %s, "
+                    "the endpoint must be directly connected"
+                ) % addr % ifa->ifa_name));
+            }
+            _ifname = ifa->ifa_name;
+            found = true;
+            break;
+        }
+        ::freeifaddrs(ifas);
+        if (not found) throw uhd::lookup_error("af_packet_zero_copy: no interface for the route to " + addr);
+
+        std::memset(&_tx_addr, 0, sizeof(_tx_addr));
+        _tx_addr.sll_family = AF_PACKET;
+        _tx_addr.sll_protocol = htons(ETH_P_IP);
+        _tx_addr.sll_ifindex = int(if_nametoindex(_ifname.c_str()));
+        _tx_addr.sll_halen = ETH_ALEN;
+        if (not no_arp) this->lookup_hw_addr(_tx_addr.sll_addr);
+    }
+
+    //! Read the endpoint's hardware address from the neighbor table
+    void lookup_hw_addr(unsigned char *hw_addr){
+        const std::string ip = asio::ip::address_v4(ntohl(_remote_addr)).to_string();
+        for (size_t attempt = 0; attempt < 100; attempt++){
+            std::ifstream arp("/proc/net/arp");
+            std::string line;
+            std::getline(arp, line); //skip the header
+            while (std::getline(arp, line)){
+                std::istringstream fields(line);
+                std::string entry_ip, hw_type, flags, mac, mask, dev;
+                fields >> entry_ip >> hw_type >> flags >> mac >> mask >> dev;
+                if (entry_ip != ip or dev != _ifname or flags == "0x0") continue;
+                unsigned int b[ETH_ALEN];
+                if (std::sscanf(mac.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != ETH_ALEN) continue;
+                for (size_t i = 0; i < ETH_ALEN; i++) hw_addr[i] = (unsigned char)(b[i]);
+                return;
+            }
+
+            //resolve the address with a datagram to the discard port
+            if (attempt == 0){
+                asio::ip::udp::socket probe(_io_service, asio::ip::udp::v4());
+                probe.send_to(asio::buffer(&attempt, 0), asio::ip::udp::endpoint(asio::ip::address_v4(ntohl(_remote_addr)), 9));
+            }
+            boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        }
+        throw uhd::lookup_error("af_packet_zero_copy: no hardware address for " + ip + " on " + _ifname);
+    }
+
+    int make_packet_socket(const int version){
+        const int fd = ::socket(AF_PACKET, SOCK_DGRAM, 0); //no protocol, bound later
+        if (fd < 0) throw uhd::os_error(
+            "af_packet_zero_copy: cannot open a packet socket (needs CAP_NET_RAW): " + errno_str()
+        );
+        if (::setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0){
+            ::close(fd);
+            throw uhd::os_error("af_packet_zero_copy: packet ring version not supported: " + errno_str());
+        }
+        return fd;
+    }
+
+    void bind_packet_socket(const int fd, const int protocol){
+        sockaddr_ll sll;
+        std::memset(&sll, 0, sizeof(sll));
+        sll.sll_family = AF_PACKET;
+        sll.sll_protocol = htons(protocol);
+        sll.sll_ifindex = _tx_addr.sll_ifindex;
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&sll), sizeof(sll)) != 0){
+            throw uhd::os_error("af_packet_zero_copy: cannot bind to " + _ifname + ": " + errno_str());
+        }
+    }
+
+    /*!
+     * Receive ring with the datagrams from the endpoint's port to the local port.
+     * The socket filter works on the IP header (SOCK_DGRAM) and drops
+     * outgoing datagrams, which are seen on the loopback interface.
+     */
+    void setup_recv_ring(const size_t ring_size, const double block_timeout){
+        _rx_fd = this->make_packet_socket(TPACKET_V3);
+
+        sock_filter filter[] = {
+            BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, boost::uint32_t(SKF_AD_OFF + SKF_AD_PKTTYPE)),
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 10, 0),
+            BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 9), //protocol
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, IPPROTO_UDP, 0, 8),
+            BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, 12), //source address
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ntohl(_remote_addr), 0, 6),
+            BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 6), //fragment offset
+            BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K, 0x1fff, 4, 0),
+            BPF_STMT(BPF_LDX | BPF_B   | BPF_MSH, 0), //header length
+            BPF_STMT(BPF_LD  | BPF_W   | BPF_IND, 0), //source and destination port
+            BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (boost::uint32_t(ntohs(_remote_port)) << 16) | ntohs(_local_port), 0, 1),
+            BPF_STMT(BPF_RET | BPF_K, 0x40000),
+            BPF_STMT(BPF_RET | BPF_K, 0),
+        };
+        sock_fprog prog = {sizeof(filter)/sizeof(filter[0]), filter};
+        if (::setsockopt(_rx_fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) != 0){
+            throw uhd::os_error("af_packet_zero_copy: failed to attach the socket filter: " + errno_str());
+        }
+
+        //a block must hold the largest datagram with the ring headers
+        const size_t page_size = size_t(::getpagesize());
+        const size_t block_size = std::max<size_t>(1 << 16, round_up(_recv_frame_size + 256, page_size));
+        tpacket_req3 req;
+        std::memset(&req, 0, sizeof(req));
+        req.tp_block_size = unsigned(block_size);
+        req.tp_block_nr = unsigned(std::max<size_t>(4, (ring_size + block_size - 1)/block_size));
+        req.tp_frame_size = unsigned(block_size);
+        req.tp_frame_nr = req.tp_block_nr;
+        req.tp_retire_blk_tov = unsigned(std::max(1.0, block_timeout*1e3 + 0.5));
+        if (::setsockopt(_rx_fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0){
+            throw uhd::os_error("af_packet_zero_copy: failed to setup the receive ring: " + errno_str());
+        }
+
+        _rx_ring_len = size_t(req.tp_block_size)*req.tp_block_nr;
+        void *ring = ::mmap(NULL, _rx_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_LOCKED, _rx_fd, 0);
+        if (ring == MAP_FAILED) ring = ::mmap(NULL, _rx_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED, _rx_fd, 0);
+        if (ring == MAP_FAILED) throw uhd::os_error("af_packet_zero_copy: failed to map the receive ring: " + errno_str());
+        _rx_ring = ring;
+        for (size_t i = 0; i < req.tp_block_nr; i++){
+            _rx_blocks.push_back(boost::make_shared<af_packet_rx_block>(static_cast<char *>(_rx_ring) + i*block_size, _counters));
+        }
+
+        this->bind_packet_socket(_rx_fd, ETH_P_IP);
+    }
+
+    //! Send ring with one frame per send buffer, the headers are written on commit
+    void setup_send_ring(const size_t ring_size){
+        _tx_fd = this->make_packet_socket(TPACKET_V2);
+
+        const size_t page_size = size_t(::getpagesize());
+        const size_t frame_size = TPACKET_ALIGN(TX_DATA_OFFSET + IP_HDR_LEN + UDP_HDR_LEN + _send_frame_size);
+        const size_t block_size = round_up(frame_size, page_size);
+        const size_t frames_per_block = block_size/frame_size;
+        const size_t num_frames = std::max(_num_send_frames, ring_size/frame_size);
+        tpacket_req req;
+        std::memset(&req, 0, sizeof(req));
+        req.tp_block_size = unsigned(block_size);
+        req.tp_block_nr = unsigned((num_frames + frames_per_block - 1)/frames_per_block);
+        req.tp_frame_size = unsigned(frame_size);
+        req.tp_frame_nr = unsigned(req.tp_block_nr*frames_per_block);
+        if (::setsockopt(_tx_fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) != 0){
+            throw uhd::os_error("af_packet_zero_copy: failed to setup the send ring: " + errno_str());
+        }
+
+        _tx_ring_len = size_t(req.tp_block_size)*req.tp_block_nr;
+        void *ring = ::mmap(NULL, _tx_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED, _tx_fd, 0);
+        if (ring == MAP_FAILED) throw uhd::os_error("af_packet_zero_copy: failed to map the send ring: " + errno_str());
+        _tx_ring = ring;
+
+        //the frames are used in ring order, the kernel sends them in the same order
+        for (size_t i = 0; i < req.tp_frame_nr; i++){
+            char *frame = static_cast<char *>(_tx_ring) + (i/frames_per_block)*block_size + (i%frames_per_block)*frame_size;
+            _msb_pool.push_back(boost::make_shared<af_packet_msb>(
+                frame, get_send_frame_size(), boost::bind(&af_packet_zero_copy_impl::send_frame, this, _1, _2, _3), _counters
+            ));
+        }
+
+        //the send socket does not receive, the protocol is given per send
+        this->bind_packet_socket(_tx_fd, 0);
+    }
+
+    /*!
+     * Write the headers in front of a committed payload and send the frame.
+     * The UDP checksum is optional for IPv4 and left at zero.
+     */
+    void send_frame(tpacket2_hdr *hdr, char *data, const size_t len){
+        count_send_commit(_counters, len);
+        const boost::uint16_t ip_len = htons(boost::uint16_t(IP_HDR_LEN + UDP_HDR_LEN + len));
+        const boost::uint16_t udp_len = htons(boost::uint16_t(UDP_HDR_LEN + len));
+        const boost::uint16_t ip_id = htons(boost::uint16_t(_ip_id++));
+
+        boost::uint16_t ip_hdr[IP_HDR_LEN/2] = {
+            htons(0x4500), ip_len, ip_id, htons(0x4000) /*don't fragment*/,
+            htons((64 << 8) | IPPROTO_UDP), 0 /*checksum*/
+        };
+        std::memcpy(&ip_hdr[6], &_local_addr, sizeof(_local_addr));
+        std::memcpy(&ip_hdr[8], &_remote_addr, sizeof(_remote_addr));
+        boost::uint32_t sum = 0;
+        for (size_t i = 0; i < IP_HDR_LEN/2; i++) sum += ip_hdr[i];
+        while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+        ip_hdr[5] = boost::uint16_t(~sum);
+
+        const boost::uint16_t udp_hdr[UDP_HDR_LEN/2] = {_local_port, _remote_port, udp_len, 0};
+        std::memcpy(data, ip_hdr, IP_HDR_LEN);
+        std::memcpy(data + IP_HDR_LEN, udp_hdr, UDP_HDR_LEN);
+        hdr->tp_len = boost::uint32_t(IP_HDR_LEN + UDP_HDR_LEN + len);
+
+        __sync_synchronize(); //write the frame before its status
+        *reinterpret_cast<volatile boost::uint32_t *>(&hdr->tp_status) = TP_STATUS_SEND_REQUEST;
+
+        //the kernel sends all requested frames of the ring
+        while (::sendto(_tx_fd, NULL, 0, MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&_tx_addr), sizeof(_tx_addr)) < 0){
+            if (errno == EAGAIN or errno == ENOBUFS or errno == EINTR){
+                _counters.send_retries++;
+                boost::this_thread::sleep(boost::posix_time::microseconds(1));
+                continue; //try to send again
+            }
+            throw uhd::os_error("af_packet_zero_copy: send from the ring failed: " + errno_str());
+        }
+    }
+
+    void cleanup(void){
+        _rx_block.reset();
+        _rx_blocks.clear();
+        _msb_pool.clear();
+        if (_rx_ring != NULL) ::munmap(_rx_ring, _rx_ring_len);
+        if (_tx_ring != NULL) ::munmap(_tx_ring, _tx_ring_len);
+        if (_rx_fd >= 0) ::close(_rx_fd);
+        if (_tx_fd >= 0) ::close(_tx_fd);
+        _rx_ring = _tx_ring = NULL;
+        _rx_fd = _tx_fd = -1;
+    }
+
+    //counters -> declared first, the blocks and frames refer to them
+    atomic_zero_copy_counters _counters;
+
+    //frame parameters of the zero copy interface
+    const size_t _recv_frame_size, _num_recv_frames;
+    const size_t _send_frame_size, _num_send_frames;
+
+    //addresses in network byte order
+    boost::uint32_t _local_addr, _remote_addr;
+    boost::uint16_t _local_port, _remote_port;
+    std::string _ifname;
+    sockaddr_ll _tx_addr;
+
+    //packet sockets and rings
+    int _rx_fd, _tx_fd;
+    void *_rx_ring, *_tx_ring;
+    size_t _rx_ring_len, _tx_ring_len;
+    std::vector<af_packet_rx_block::sptr> _rx_blocks;
+    af_packet_rx_block::sptr _rx_block;
+    size_t _next_rx_block;
+    std::vector<boost::shared_ptr<af_packet_msb> > _msb_pool;
+    size_t _next_send_buff_index;
+    size_t _ip_id;
+
+    //asio guts -> the socket that owns the local port
+    asio::io_service _io_service;
+    socket_sptr _socket;
+};
+
+/***********************************************************************
+ * AF_PACKET zero copy make function
+ **********************************************************************/
+af_packet_zero_copy::sptr af_packet_zero_copy::make(
+    const std::string &addr,
+    const std::string &port,
+    const zero_copy_xport_params &default_buff_args,
+    udp_zero_copy::buff_params& buff_params_out,
+    const device_addr_t &hints
+){
+    //Initialize xport_params
+    zero_copy_xport_params xport_params = default_buff_args;
+
+    xport_params.recv_frame_size = size_t(hints.cast<double>("recv_frame_size", default_buff_args.recv_frame_size));
+    xport_params.num_recv_frames = size_t(hints.cast<double>("num_recv_frames", default_buff_args.num_recv_frames));
+    xport_params.send_frame_size = size_t(hints.cast<double>("send_frame_size", default_buff_args.send_frame_size));
+    xport_params.num_send_frames = size_t(hints.cast<double>("num_send_frames", default_buff_args.num_send_frames));
+
+    //the buffer sizes set the ring sizes, the rings hold at least the frames
+    const size_t recv_ring_size = size_t(hints.cast<double>("recv_buff_size",
+        double(xport_params.num_recv_frames*xport_params.recv_frame_size)));
+    const size_t send_ring_size = size_t(hints.cast<double>("send_buff_size",
+        double(xport_params.num_send_frames*xport_params.send_frame_size)));
+    const double recv_block_timeout = hints.cast<double>("recv_block_timeout", 0.001);
+
+    af_packet_zero_copy_impl::sptr xport(new af_packet_zero_copy_impl(
+        addr, port, xport_params, recv_ring_size, send_ring_size, recv_block_timeout
+    ));
+
+    buff_params_out.recv_buff_size = xport->get_recv_ring_size();
+    buff_params_out.send_buff_size = xport->get_send_ring_size();
+    return xport;
+}
+
+#else /*HAVE_AF_PACKET*/
+
+uhd::transport::af_packet_zero_copy::sptr uhd::transport::af_packet_zero_copy::make(
+    const std::string &,
+    const std::string &,
+    const zero_copy_xport_params &,
+    udp_zero_copy::buff_params &,
+    const device_addr_t &
+){
+    throw uhd::not_implemented_error("af_packet_zero_copy: packet rings are not supported on this platform");
+}
+
+#endif /*HAVE_AF_PACKET*/
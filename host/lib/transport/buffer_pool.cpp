@@ -17,9 +17,22 @@
 
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/transport/zero_copy.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/log.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/format.hpp>
 #include <vector>
 
+#ifdef HAVE_BUFFER_POOL_POLICIES
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 using namespace uhd::transport;
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
@@ -65,6 +78,107 @@ private:
     boost::shared_array<char> _mem;
 };
 
+/***********************************************************************
+ * Allocation policy from the transport hints
+ **********************************************************************/
+struct alloc_policy{
+    size_t huge_page_size; //0 for normal pages
+    int numa_node; //negative for no binding
+    bool lock;
+
+    bool is_default(void) const{
+        return huge_page_size == 0 and numa_node < 0 and not lock;
+    }
+};
+
+static alloc_policy get_alloc_policy(const uhd::device_addr_t &hints){
+    alloc_policy policy;
+    const std::string huge_pages = hints.get("buff_hugepages", "0");
+    if (huge_pages == "0") policy.huge_page_size = 0;
+    else if (huge_pages == "1" or huge_pages == "2M") policy.huge_page_size = size_t(1) << 21;
+    else if (huge_pages == "1G") policy.huge_page_size = size_t(1) << 30;
+    else throw uhd::value_error("buff_hugepages must be 0, 1, 2M or 1G, not " + huge_pages);
+    policy.numa_node = hints.cast<int>("buff_numa_node", -1);
+    policy.lock = hints.cast<int>("buff_mlock", 0) != 0;
+    return policy;
+}
+
+#ifdef HAVE_BUFFER_POOL_POLICIES
+/***********************************************************************
+ * Allocate the pool memory with mmap and apply the policy:
+ *   Huge pages need to be reserved by the administrator, without them
+ *   the memory falls back to normal pages with a transparent huge page hint.
+ *   The NUMA binding has to happen before the pages are touched,
+ *   locking the memory touches all pages.
+ **********************************************************************/
+struct munmap_deleter{
+    munmap_deleter(const size_t length): length(length){}
+    void operator()(char *mem) const{
+        ::munmap(mem, length);
+    }
+    size_t length;
+};
+
+static boost::shared_array<char> alloc_memory(const size_t bytes, const alloc_policy &policy){
+    const size_t page_size = size_t(::sysconf(_SC_PAGESIZE));
+    size_t length = pad_to_boundary(bytes, page_size);
+    void *mem = MAP_FAILED;
+
+    if (policy.huge_page_size != 0){
+        const int huge_page_shift = (policy.huge_page_size == (size_t(1) << 30))? 30 : 21;
+        const size_t huge_length = pad_to_boundary(bytes, policy.huge_page_size);
+        mem = ::mmap(
+            NULL, huge_length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (huge_page_shift << MAP_HUGE_SHIFT), -1, 0
+        );
+        if (mem == MAP_FAILED){
+            UHD_MSG(warning) << boost::format(
+                "Could not allocate %u bytes of %u kB huge pages for a buffer pool: %s\n"
+                "Reserve more huge pages with /sys/kernel/mm/hugepages/hugepages-%ukB/nr_hugepages.\n"
+                "Using normal pages instead.\n"
+            ) % huge_length % (policy.huge_page_size >> 10) % std::strerror(errno) % (policy.huge_page_size >> 10);
+        }
+        else length = huge_length;
+    }
+
+    if (mem == MAP_FAILED){
+        mem = ::mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) throw uhd::os_error(str(boost::format(
+            "buffer_pool: could not map %u bytes: %s") % length % std::strerror(errno)
+        ));
+        if (policy.huge_page_size != 0) ::madvise(mem, length, MADV_HUGEPAGE);
+    }
+    boost::shared_array<char> mem_array(static_cast<char *>(mem), munmap_deleter(length));
+
+    if (policy.numa_node >= 0){
+        static const size_t bits = sizeof(unsigned long)*8;
+        std::vector<unsigned long> node_mask(policy.numa_node/bits + 1, 0);
+        node_mask.back() |= 1UL << (policy.numa_node%bits);
+        if (::syscall(__NR_mbind, mem, length, MPOL_BIND, &node_mask.front(), node_mask.size()*bits + 1, MPOL_MF_MOVE) != 0){
+            UHD_MSG(warning) << boost::format(
+                "Could not bind a buffer pool to NUMA node %d: %s\n"
+            ) % policy.numa_node % std::strerror(errno);
+        }
+    }
+
+    if (policy.lock and ::mlock(mem, length) != 0){
+        UHD_MSG(warning) << boost::format(
+            "Could not lock %u bytes of a buffer pool into memory: %s\n"
+            "Raise the locked memory limit (ulimit -l) or run with CAP_IPC_LOCK.\n"
+        ) % length % std::strerror(errno);
+    }
+
+    UHD_LOG << boost::format("Mapped a buffer pool of %u bytes (huge pages %u, NUMA node %d, locked %d)")
+        % length % policy.huge_page_size % policy.numa_node % policy.lock << std::endl;
+    return mem_array;
+}
+#else
+static boost::shared_array<char> alloc_memory(const size_t bytes, const alloc_policy &){
+    UHD_MSG(warning) << "Huge page, NUMA and locked buffer pools are not supported on this platform." << std::endl;
+    return boost::shared_array<char>(new char[bytes]);
+}
+#endif
+
 /***********************************************************************
  * Buffer pool factor function
  **********************************************************************/
@@ -72,12 +186,24 @@ buffer_pool::sptr buffer_pool::make(
     const size_t num_buffs,
     const size_t buff_size,
     const size_t alignment
+){
+    return buffer_pool::make(num_buffs, buff_size, device_addr_t(), alignment);
+}
+
+buffer_pool::sptr buffer_pool::make(
+    const size_t num_buffs,
+    const size_t buff_size,
+    const device_addr_t &hints,
+    const size_t alignment
 ){
     //1) pad the buffer size to be a multiple of alignment
     //2) pad the overall memory size for room after alignment
     //3) allocate the memory in one block of sufficient size
     const size_t padded_buff_size = pad_to_boundary(buff_size, alignment);
-    boost::shared_array<char> mem(new char[padded_buff_size*num_buffs + alignment-1]);
+    const size_t mem_size = padded_buff_size*num_buffs + alignment-1;
+    const alloc_policy policy = get_alloc_policy(hints);
+    boost::shared_array<char> mem = policy.is_default()?
+        boost::shared_array<char>(new char[mem_size]) : alloc_memory(mem_size, policy);
 
     //Fill a vector with boundary-aligned points in the memory
     const size_t mem_start = pad_to_boundary(size_t(mem.get()), alignment);
@@ -0,0 +1,301 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "convert_pool.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+#include <pthread.h>
+#endif
+
+using namespace uhd;
+using namespace uhd::transport;
+
+//! Workers poll this often for jobs before they sleep
+static const size_t CONVERT_POOL_SPINS = 16;
+
+//! Default upper limit on the number of workers
+static const size_t CONVERT_POOL_MAX_DEFAULT_THREADS = 8;
+
+/***********************************************************************
+ * Pool configuration from the environment
+ **********************************************************************/
+static size_t get_num_threads_from_env(void){
+    const char *env = std::getenv("UHD_CONVERT_THREADS");
+    if (env != NULL) try{
+        return boost::lexical_cast<size_t>(env);
+    }
+    catch(const boost::bad_lexical_cast &){
+        UHD_MSG(warning) << "Ignoring UHD_CONVERT_THREADS=" << env << ", not a number" << std::endl;
+    }
+
+    //leave one core for the thread that calls recv() or send()
+    const size_t num_cores = std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+    return std::min(num_cores - 1, CONVERT_POOL_MAX_DEFAULT_THREADS);
+}
+
+static std::vector<int> get_affinity_from_env(void){
+    std::vector<int> cpus;
+    const char *env = std::getenv("UHD_CONVERT_AFFINITY");
+    if (env == NULL) return cpus;
+
+    std::vector<std::string> ranges;
+    boost::split(ranges, env, boost::is_any_of(","), boost::token_compress_on);
+    try{
+        for (size_t i = 0; i < ranges.size(); i++){
+            if (ranges[i].empty()) continue;
+            std::vector<std::string> bounds;
+            boost::split(bounds, ranges[i], boost::is_any_of("-"));
+            const int first = boost::lexical_cast<int>(bounds.front());
+            const int last = boost::lexical_cast<int>(bounds.back());
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+    }
+    catch(const boost::bad_lexical_cast &){
+        UHD_MSG(warning) << "Ignoring UHD_CONVERT_AFFINITY=" << env << ", not a list of CPUs" << std::endl;
+        cpus.clear();
+    }
+    return cpus;
+}
+
+static void set_thread_affinity(const int cpu){
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0){
+        UHD_MSG(warning) << "The convert pool could not bind a worker to CPU " << cpu << std::endl;
+    }
+#else
+    UHD_MSG(warning) << "The convert pool cannot bind a worker to CPU " << cpu << " on this platform" << std::endl;
+#endif
+}
+
+/***********************************************************************
+ * A batch of jobs from one run() call, lives on the caller's stack
+ **********************************************************************/
+struct convert_batch{
+    convert_batch(convert_pool::job_fcn_type fcn, void *context):
+        fcn(fcn), context(context)
+    {
+        /* NOP */
+    }
+
+    //! Run a job, the batch is gone once the last job is counted
+    //! \return true when this was the last job of the batch
+    bool run_job(const size_t index){
+        try{
+            fcn(context, index);
+        }
+        catch(const std::exception &e){
+            if (failed.cas(1, 0) == 0) error = e.what();
+        }
+        catch(...){
+            if (failed.cas(1, 0) == 0) error = "unknown exception";
+        }
+        return remaining.dec() == 1;
+    }
+
+    const convert_pool::job_fcn_type fcn;
+    void *const context;
+    atomic_uint32_t remaining;
+    atomic_uint32_t failed;
+    std::string error;
+};
+
+struct convert_job{
+    convert_job(convert_batch *batch, const size_t index):
+        batch(batch), index(index)
+    {
+        /* NOP */
+    }
+    convert_batch *batch;
+    size_t index;
+};
+
+/***********************************************************************
+ * Convert pool implementation
+ **********************************************************************/
+class convert_pool_impl : public convert_pool{
+public:
+    convert_pool_impl(const size_t num_threads, const std::vector<int> &cpus):
+        _running(true)
+    {
+        for (size_t i = 0; i < num_threads; i++){
+            _queues.push_back(boost::make_shared<worker_queue>());
+        }
+        for (size_t i = 0; i < num_threads; i++){
+            const int cpu = cpus.empty()? -1 : cpus[i % cpus.size()];
+            _threads.create_thread(boost::bind(&convert_pool_impl::worker_loop, this, i, cpu));
+        }
+    }
+
+    ~convert_pool_impl(void){
+        {
+            boost::mutex::scoped_lock lock(_idle_mutex);
+            _running = false;
+        }
+        _idle_cond.notify_all();
+        _threads.join_all();
+    }
+
+    void run(job_fcn_type fcn, void *context, const size_t num_jobs){
+        //without workers or with one job there is nothing to hand out
+        if (_queues.empty() or num_jobs < 2){
+            for (size_t i = 0; i < num_jobs; i++) fcn(context, i);
+            return;
+        }
+
+        convert_batch batch(fcn, context);
+        batch.remaining.write(boost::uint32_t(num_jobs));
+
+        //spread the jobs over the worker queues, from a rotating start
+        const size_t first = _next_queue.inc();
+        for (size_t i = 1; i < num_jobs; i++){
+            worker_queue &queue = *_queues[(first + i) % _queues.size()];
+            boost::mutex::scoped_lock lock(queue.mutex);
+            queue.jobs.push_back(convert_job(&batch, i));
+            _num_queued.inc();
+        }
+
+        //wake a sleeping worker per job, the busy ones find the rest
+        const size_t num_idle = _num_idle.read();
+        if (num_idle != 0){
+            boost::mutex::scoped_lock lock(_idle_mutex);
+            for (size_t i = 0; i < std::min(num_idle, num_jobs - 1); i++) _idle_cond.notify_one();
+        }
+
+        //the caller does the first job and helps while jobs are queued,
+        //then sleeps until the workers are done with the rest
+        batch.run_job(0);
+        while (batch.remaining.read() != 0 and this->steal_and_run(first)){}
+        if (batch.remaining.read() != 0){
+            boost::mutex::scoped_lock lock(_done_mutex);
+            while (batch.remaining.read() != 0) _done_cond.wait(lock);
+        }
+
+        if (batch.failed.read() != 0){
+            throw uhd::runtime_error("a conversion job failed: " + batch.error);
+        }
+    }
+
+    size_t get_num_threads(void) const{
+        return _queues.size();
+    }
+
+private:
+    struct worker_queue{
+        boost::mutex mutex;
+        std::deque<convert_job> jobs;
+    };
+
+    std::vector<boost::shared_ptr<worker_queue> > _queues;
+    boost::thread_group _threads;
+    atomic_uint32_t _next_queue;
+    atomic_uint32_t _num_queued;
+    atomic_uint32_t _num_idle;
+    boost::mutex _idle_mutex;
+    boost::condition_variable _idle_cond;
+    bool _running;
+    boost::mutex _done_mutex;
+    boost::condition_variable _done_cond;
+
+    //! Run a job, the last job of a batch wakes the callers
+    void run_job(const convert_job &job){
+        if (not job.batch->run_job(job.index)) return;
+        boost::mutex::scoped_lock lock(_done_mutex);
+        _done_cond.notify_all();
+    }
+
+    //! Take a job from a queue, starting at the given one, and run it
+    bool steal_and_run(const size_t start){
+        if (_num_queued.read() == 0) return false;
+        for (size_t i = 0; i < _queues.size(); i++){
+            worker_queue &queue = *_queues[(start + i) % _queues.size()];
+            boost::mutex::scoped_lock lock(queue.mutex);
+            if (queue.jobs.empty()) continue;
+            const convert_job job = queue.jobs.front();
+            queue.jobs.pop_front();
+            _num_queued.dec();
+            lock.unlock();
+            this->run_job(job);
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop(const size_t index, const int cpu){
+        if (cpu >= 0) set_thread_affinity(cpu);
+
+        size_t num_spins = 0;
+        while (true){
+            if (this->steal_and_run(index)){
+                num_spins = 0;
+                continue;
+            }
+            if (++num_spins < CONVERT_POOL_SPINS){
+                boost::this_thread::yield();
+                continue;
+            }
+
+            //nothing to do for a while: sleep until a batch comes,
+            //the idle count is raised before the queues are checked
+            //and run() queues the jobs before it reads the idle count
+            boost::mutex::scoped_lock lock(_idle_mutex);
+            _num_idle.inc();
+            while (_running and _num_queued.read() == 0) _idle_cond.wait(lock);
+            _num_idle.dec();
+            if (not _running) return;
+            num_spins = 0;
+        }
+    }
+};
+
+/***********************************************************************
+ * The pool of the process
+ **********************************************************************/
+convert_pool::~convert_pool(void){
+    /* NOP */
+}
+
+convert_pool::sptr convert_pool::get_shared(void){
+    static boost::mutex mutex;
+    static boost::weak_ptr<convert_pool> weak_pool;
+
+    boost::mutex::scoped_lock lock(mutex);
+    sptr pool = weak_pool.lock();
+    if (not pool){
+        pool = sptr(new convert_pool_impl(get_num_threads_from_env(), get_affinity_from_env()));
+        weak_pool = pool;
+    }
+    return pool;
+}
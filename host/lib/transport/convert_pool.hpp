@@ -0,0 +1,70 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_CONVERT_POOL_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_CONVERT_POOL_HPP
+
+#include <uhd/config.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace transport{
+
+/*!
+ * The convert pool runs the per channel conversions of the packet handlers.
+ *
+ * One pool of worker threads is shared by all streamers in the process.
+ * A handler submits the channels of a packet as one batch of jobs:
+ * the caller converts the first channel itself, the workers take the others
+ * from their queues or steal them from the queues of busy workers,
+ * and the caller helps with queued jobs, then sleeps until its batch is done.
+ * Idle workers poll briefly and then sleep until jobs are queued.
+ *
+ * The environment configures the pool when it is made:
+ * - UHD_CONVERT_THREADS: the number of worker threads,
+ *   0 converts all channels on the calling thread
+ * - UHD_CONVERT_AFFINITY: a list of CPUs for the workers, like "2,4-7"
+ */
+class convert_pool : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<convert_pool> sptr;
+    typedef void (*job_fcn_type)(void *context, const size_t index);
+
+    virtual ~convert_pool(void);
+
+    /*!
+     * Get the pool of the process.
+     * The pool is made on first use and stops with the last reference.
+     */
+    static sptr get_shared(void);
+
+    /*!
+     * Run the jobs 0 to num_jobs-1 and wait for all of them.
+     * \param fcn the job function, called with the context and the job index
+     * \param context the context pointer for the job function
+     * \param num_jobs the number of jobs in the batch
+     * \throws uhd::runtime_error when a job threw
+     */
+    virtual void run(job_fcn_type fcn, void *context, const size_t num_jobs) = 0;
+
+    //! Get the number of worker threads
+    virtual size_t get_num_threads(void) const = 0;
+};
+
+}} //namespace
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_CONVERT_POOL_HPP */
@@ -0,0 +1,545 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "io_uring_zero_copy.hpp"
+#include <uhd/exception.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+io_uring_recv_xport::~io_uring_recv_xport(void){
+    /* NOP */
+}
+
+io_uring_send_xport::~io_uring_send_xport(void){
+    /* NOP */
+}
+
+#ifdef HAVE_IO_URING
+
+#include "udp_common.hpp"
+#include "zero_copy_counters.hpp"
+#include <uhd/utils/log.hpp>
+#include <uhd/utils/safe_call.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp> //sleep
+#include <boost/thread/mutex.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+
+//! User data of requests that do not complete a frame
+static const boost::uint64_t CANCEL_USER_DATA = ~boost::uint64_t(0);
+
+//! How long the destructors wait for the kernel to give up the frames
+static const double CANCEL_TIMEOUT = 1.0;
+
+static std::string errno_str(const int err){
+    return std::strerror(err);
+}
+
+static boost::system_time get_exit_time(const double timeout){
+    return boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+}
+
+static double get_time_left(const boost::system_time &exit_time){
+    return std::max(0.0, (exit_time - boost::get_system_time()).total_microseconds()/1e6);
+}
+
+/***********************************************************************
+ * The ring:
+ *  - the submission and completion queues are mapped from the kernel
+ *  - the submission tail and the completion head are written here,
+ *    the kernel writes the other ends, the order is kept with barriers
+ *  - the fd becomes readable when there are completions
+ **********************************************************************/
+class io_uring_ring : boost::noncopyable{
+public:
+    io_uring_ring(const size_t entries):
+        _sq_ring(MAP_FAILED), _cq_ring(MAP_FAILED), _sqes(MAP_FAILED)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        _fd = int(::syscall(__NR_io_uring_setup, unsigned(entries), &params));
+        if (_fd < 0) throw uhd::os_error("io_uring: failed to create the ring: " + errno_str(errno));
+
+        try{
+            _sq_ring_size = params.sq_off.array + params.sq_entries*sizeof(unsigned);
+            _cq_ring_size = params.cq_off.cqes + params.cq_entries*sizeof(io_uring_cqe);
+            _sqes_size = params.sq_entries*sizeof(io_uring_sqe);
+            _sq_ring = this->map(_sq_ring_size, IORING_OFF_SQ_RING);
+            _cq_ring = this->map(_cq_ring_size, IORING_OFF_CQ_RING);
+            _sqes = this->map(_sqes_size, IORING_OFF_SQES);
+        }
+        catch(...){
+            this->cleanup();
+            throw;
+        }
+
+        char *sq = static_cast<char *>(_sq_ring);
+        _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        _sq_entries = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+        _sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+        char *cq = static_cast<char *>(_cq_ring);
+        _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    ~io_uring_ring(void){
+        this->cleanup();
+    }
+
+    //! Register the frames of the pool, the buffer index is the frame index
+    void register_buffers(buffer_pool::sptr pool, const size_t frame_size){
+        std::vector<iovec> iovs(pool->size());
+        for (size_t i = 0; i < iovs.size(); i++){
+            iovs[i].iov_base = pool->at(i);
+            iovs[i].iov_len = frame_size;
+        }
+        if (::syscall(__NR_io_uring_register, _fd, IORING_REGISTER_BUFFERS, &iovs.front(), unsigned(iovs.size())) < 0){
+            throw uhd::os_error(
+                "io_uring: failed to register the buffers: " + errno_str(errno) + "\n"
+                "The locked memory limit (ulimit -l) may be too small for the frames."
+            );
+        }
+    }
+
+    //! Get the next submission to fill in, null when the queue is full
+    io_uring_sqe *get_sqe(void){
+        const unsigned tail = *_sq_tail;
+        if (tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) return NULL;
+        io_uring_sqe *sqe = &static_cast<io_uring_sqe *>(_sqes)[tail & _sq_mask];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        return sqe;
+    }
+
+    //! Queue the submission from get_sqe for the next call to submit
+    void push_sqe(void){
+        const unsigned tail = *_sq_tail;
+        _sq_array[tail & _sq_mask] = tail & _sq_mask;
+        __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    //! Hand the queued submissions to the kernel
+    void submit(size_t num){
+        while (num > 0){
+            const int ret = int(::syscall(__NR_io_uring_enter, _fd, unsigned(num), 0, 0, NULL, 0));
+            if (ret < 0 and (errno == EINTR or errno == EAGAIN or errno == EBUSY)){
+                boost::this_thread::sleep(boost::posix_time::microseconds(1));
+                continue; //try to submit again
+            }
+            if (ret < 0) throw uhd::os_error("io_uring: failed to submit: " + errno_str(errno));
+            num -= std::min(num, size_t(ret));
+        }
+    }
+
+    //! Get the oldest completion, null when there is none
+    io_uring_cqe *peek_cqe(void){
+        const unsigned head = *_cq_head;
+        if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) return NULL;
+        return &_cqes[head & _cq_mask];
+    }
+
+    //! Give the completion from peek_cqe back to the kernel
+    void pop_cqe(void){
+        __atomic_store_n(_cq_head, *_cq_head + 1, __ATOMIC_RELEASE);
+    }
+
+    //! Wait for a completion, true when there is one
+    bool wait_for_cqe(const double timeout){
+        return this->peek_cqe() != NULL or wait_for_recv_ready(_fd, timeout);
+    }
+
+    //! Cancel the requests with the user data, the cancel requests complete as well
+    void cancel(const std::vector<boost::uint64_t> &user_data){
+        size_t num_queued = 0;
+        for (size_t i = 0; i < user_data.size(); i++){
+            io_uring_sqe *sqe = this->get_sqe();
+            if (sqe == NULL){ //queue is full -> submit the queued cancels
+                this->submit(num_queued);
+                num_queued = 0;
+                sqe = this->get_sqe();
+            }
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = user_data[i];
+            sqe->user_data = CANCEL_USER_DATA;
+            this->push_sqe();
+            num_queued++;
+        }
+        this->submit(num_queued);
+    }
+
+private:
+    void *map(const size_t size, const off_t offset){
+        void *mem = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+        if (mem == MAP_FAILED) throw uhd::os_error("io_uring: failed to map the ring: " + errno_str(errno));
+        return mem;
+    }
+
+    void cleanup(void){
+        if (_sqes != MAP_FAILED) ::munmap(_sqes, _sqes_size);
+        if (_cq_ring != MAP_FAILED) ::munmap(_cq_ring, _cq_ring_size);
+        if (_sq_ring != MAP_FAILED) ::munmap(_sq_ring, _sq_ring_size);
+        ::close(_fd);
+    }
+
+    int _fd;
+    void *_sq_ring, *_cq_ring, *_sqes;
+    size_t _sq_ring_size, _cq_ring_size, _sqes_size;
+    unsigned *_sq_head, *_sq_tail, *_sq_array;
+    unsigned _sq_mask, _sq_entries;
+    unsigned *_cq_head, *_cq_tail;
+    unsigned _cq_mask;
+    io_uring_cqe *_cqes;
+};
+
+/***********************************************************************
+ * Receive implementation:
+ *  - every free frame has a fixed buffer read posted
+ *  - a released frame is queued for the next call into the kernel
+ **********************************************************************/
+class io_uring_recv_xport_impl;
+
+class io_uring_recv_mrb : public managed_recv_buffer{
+public:
+    io_uring_recv_mrb(io_uring_recv_xport_impl *xport, void *mem, const size_t index):
+        _xport(xport), _mem(mem), _index(index){ /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(const size_t len){
+        return make(this, _mem, len);
+    }
+
+private:
+    io_uring_recv_xport_impl *_xport;
+    void *_mem;
+    const size_t _index;
+};
+
+class io_uring_recv_xport_impl : public io_uring_recv_xport{
+public:
+    io_uring_recv_xport_impl(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _sock_fd(sock_fd), _pool(pool), _frame_size(frame_size), _counters(counters),
+        _ring(pool->size()), _posted(pool->size(), 0), _num_pending(0)
+    {
+        _ring.register_buffers(_pool, _frame_size);
+        for (size_t i = 0; i < _pool->size(); i++){
+            _mrb_pool.push_back(boost::make_shared<io_uring_recv_mrb>(this, _pool->at(i), i));
+            this->post_read(i);
+        }
+        this->submit_pending(0);
+    }
+
+    ~io_uring_recv_xport_impl(void){
+        UHD_SAFE_CALL(this->cancel_reads();)
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(const double timeout){
+        const boost::system_time exit_time = get_exit_time(timeout);
+        while (true){
+            io_uring_cqe *cqe = _ring.peek_cqe();
+            if (cqe == NULL){
+                //nothing received -> post the released frames and wait
+                this->submit_pending(0);
+                counted_wait wait(_counters.recv_wait_time);
+                if (not _ring.wait_for_cqe(get_time_left(exit_time))) return managed_recv_buffer::sptr();
+                continue;
+            }
+            const boost::uint64_t index = cqe->user_data;
+            const int res = cqe->res;
+            _ring.pop_cqe();
+            if (index >= _mrb_pool.size()) continue; //not a read
+            _posted[index] = 0;
+
+            //ex: connection refused or the submitting thread exited
+            if (res < 0){
+                _counters.recv_retries++;
+                this->post_read(size_t(index));
+                if (get_time_left(exit_time) == 0.0) return managed_recv_buffer::sptr();
+                continue;
+            }
+
+            //frames come in back to back -> post the released frames
+            //once in a while, so that enough reads stay posted
+            this->submit_pending(_mrb_pool.size()/2);
+            return _mrb_pool[index]->get_new(size_t(res));
+        }
+    }
+
+    void release_read(const size_t index){
+        count_recv_release(_counters);
+        this->post_read(index);
+    }
+
+private:
+    void post_read(const size_t index){
+        boost::mutex::scoped_lock lock(_mutex);
+        io_uring_sqe *sqe = _ring.get_sqe();
+        UHD_ASSERT_THROW(sqe != NULL);
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->fd = _sock_fd;
+        sqe->addr = boost::uint64_t(size_t(_pool->at(index)));
+        sqe->len = unsigned(_frame_size);
+        sqe->buf_index = boost::uint16_t(index);
+        sqe->user_data = index;
+        _ring.push_sqe();
+        _posted[index] = 1;
+        _num_pending++;
+    }
+
+    void submit_pending(const size_t min_pending){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (_num_pending == 0 or _num_pending < min_pending) return;
+        const size_t num = _num_pending;
+        _num_pending = 0;
+        lock.unlock();
+        _ring.submit(num);
+    }
+
+    //the kernel must not write into the frames after they are gone
+    void cancel_reads(void){
+        this->submit_pending(0);
+        std::vector<boost::uint64_t> posted;
+        for (size_t i = 0; i < _posted.size(); i++){
+            if (_posted[i] != 0) posted.push_back(i);
+        }
+        _ring.cancel(posted);
+
+        size_t num_posted = posted.size();
+        const boost::system_time exit_time = get_exit_time(CANCEL_TIMEOUT);
+        while (num_posted > 0 and _ring.wait_for_cqe(get_time_left(exit_time))){
+            io_uring_cqe *cqe = _ring.peek_cqe();
+            if (cqe == NULL) continue;
+            const boost::uint64_t index = cqe->user_data;
+            _ring.pop_cqe();
+            if (index < _posted.size() and _posted[index] != 0){
+                _posted[index] = 0;
+                num_posted--;
+            }
+        }
+        if (num_posted > 0) UHD_LOG << "io_uring: reads not canceled: " << num_posted << std::endl;
+    }
+
+    const int _sock_fd;
+    buffer_pool::sptr _pool;
+    const size_t _frame_size;
+    atomic_zero_copy_counters &_counters;
+    io_uring_ring _ring;
+    std::vector<boost::shared_ptr<io_uring_recv_mrb> > _mrb_pool;
+
+    //reads queued or in the kernel, frames are released from any thread
+    boost::mutex _mutex;
+    std::vector<char> _posted;
+    size_t _num_pending;
+};
+
+void io_uring_recv_mrb::release(void){
+    _xport->release_read(_index);
+}
+
+/***********************************************************************
+ * Send implementation:
+ *  - a committed frame is written with a fixed buffer write
+ *  - the frame is free again when the write completed
+ *  - one write is in the kernel at a time to keep the order of the
+ *    frames, a commit waits for the last write like a blocking send
+ **********************************************************************/
+class io_uring_send_xport_impl;
+
+class io_uring_send_msb : public managed_send_buffer{
+public:
+    io_uring_send_msb(io_uring_send_xport_impl *xport, void *mem, const size_t frame_size, const size_t index):
+        _xport(xport), _mem(mem), _frame_size(frame_size), _index(index){ /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void){
+        return make(this, _mem, _frame_size);
+    }
+
+private:
+    io_uring_send_xport_impl *_xport;
+    void *_mem;
+    const size_t _frame_size;
+    const size_t _index;
+};
+
+class io_uring_send_xport_impl : public io_uring_send_xport{
+public:
+    io_uring_send_xport_impl(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, const bool full_frames, atomic_zero_copy_counters &counters):
+        _sock_fd(sock_fd), _pool(pool), _frame_size(frame_size), _full_frames(full_frames), _counters(counters),
+        _ring(pool->size()), _lens(pool->size(), 0), _offsets(pool->size(), 0), _writing(false)
+    {
+        _ring.register_buffers(_pool, _frame_size);
+        for (size_t i = 0; i < _pool->size(); i++){
+            _msb_pool.push_back(boost::make_shared<io_uring_send_msb>(this, _pool->at(i), _frame_size, i));
+            _free_frames.push_back(_pool->size() - i - 1);
+        }
+    }
+
+    ~io_uring_send_xport_impl(void){
+        UHD_SAFE_CALL(this->finish_writes();)
+    }
+
+    managed_send_buffer::sptr get_send_buff(const double timeout){
+        const boost::system_time exit_time = get_exit_time(timeout);
+        this->reap_writes();
+        while (_free_frames.empty()){
+            counted_wait wait(_counters.send_wait_time);
+            if (not _ring.wait_for_cqe(get_time_left(exit_time))) return managed_send_buffer::sptr();
+            this->reap_writes();
+        }
+        const size_t index = _free_frames.back();
+        _free_frames.pop_back();
+        return _msb_pool[index]->get_new();
+    }
+
+    void post_write(const size_t index, const size_t len){
+        count_send_commit(_counters, len);
+        if (_writing){
+            counted_wait wait(_counters.send_wait_time);
+            while (_writing){
+                _ring.wait_for_cqe(1.0);
+                this->reap_writes();
+            }
+        }
+        _lens[index] = _full_frames? _frame_size : len;
+        _offsets[index] = 0;
+        this->write(index);
+    }
+
+private:
+    void write(const size_t index){
+        io_uring_sqe *sqe = _ring.get_sqe();
+        UHD_ASSERT_THROW(sqe != NULL);
+        sqe->opcode = IORING_OP_WRITE_FIXED;
+        sqe->fd = _sock_fd;
+        sqe->addr = boost::uint64_t(size_t(_pool->at(index)) + _offsets[index]);
+        sqe->len = unsigned(_lens[index] - _offsets[index]);
+        sqe->buf_index = boost::uint16_t(index);
+        sqe->user_data = index;
+        _ring.push_sqe();
+        _writing = true;
+        _ring.submit(1);
+    }
+
+    void reap_writes(void){
+        io_uring_cqe *cqe;
+        while ((cqe = _ring.peek_cqe()) != NULL){
+            const boost::uint64_t index = cqe->user_data;
+            const int res = cqe->res;
+            _ring.pop_cqe();
+            if (index >= _msb_pool.size()) continue; //not a write
+            _writing = false;
+
+            //Retry logic because send may fail with ENOBUFS.
+            //This is known to occur at least on some OSX systems.
+            //But it should be safe to always check for the error.
+            if (res == -ENOBUFS or res == -EAGAIN or res == -EINTR){
+                _counters.send_retries++;
+                boost::this_thread::sleep(boost::posix_time::microseconds(1));
+                this->write(size_t(index));
+                continue;
+            }
+            if (res < 0){
+                _free_frames.push_back(size_t(index));
+                throw uhd::io_error("io_uring: failed to send: " + errno_str(-res));
+            }
+
+            //a stream socket may take part of the frame
+            _offsets[index] += size_t(res);
+            if (res > 0 and _offsets[index] < _lens[index]){
+                this->write(size_t(index));
+                continue;
+            }
+            _free_frames.push_back(size_t(index));
+        }
+    }
+
+    //the kernel must not read from the frames after they are gone
+    void finish_writes(void){
+        const boost::system_time exit_time = get_exit_time(CANCEL_TIMEOUT);
+        while (_writing and _ring.wait_for_cqe(get_time_left(exit_time))) this->reap_writes();
+        if (not _writing) return;
+
+        std::vector<boost::uint64_t> writes;
+        for (size_t i = 0; i < _msb_pool.size(); i++) writes.push_back(i);
+        _ring.cancel(writes);
+        while (_writing and _ring.wait_for_cqe(CANCEL_TIMEOUT)){
+            io_uring_cqe *cqe = _ring.peek_cqe();
+            if (cqe == NULL) continue;
+            if (cqe->user_data < _msb_pool.size()) _writing = false;
+            _ring.pop_cqe();
+        }
+        if (_writing) UHD_LOG << "io_uring: write not canceled" << std::endl;
+    }
+
+    const int _sock_fd;
+    buffer_pool::sptr _pool;
+    const size_t _frame_size;
+    const bool _full_frames;
+    atomic_zero_copy_counters &_counters;
+    io_uring_ring _ring;
+    std::vector<boost::shared_ptr<io_uring_send_msb> > _msb_pool;
+    std::vector<size_t> _free_frames;
+    std::vector<size_t> _lens, _offsets;
+    bool _writing;
+};
+
+void io_uring_send_msb::release(void){
+    _xport->post_write(_index, size());
+}
+
+/***********************************************************************
+ * io_uring make functions
+ **********************************************************************/
+io_uring_recv_xport::sptr io_uring_recv_xport::make(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, atomic_zero_copy_counters &counters){
+    UHD_LOG << boost::format("Creating io_uring receiver with %d frames of %d bytes") % pool->size() % frame_size << std::endl;
+    return sptr(new io_uring_recv_xport_impl(sock_fd, pool, frame_size, counters));
+}
+
+io_uring_send_xport::sptr io_uring_send_xport::make(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, const bool full_frames, atomic_zero_copy_counters &counters){
+    UHD_LOG << boost::format("Creating io_uring sender with %d frames of %d bytes") % pool->size() % frame_size << std::endl;
+    return sptr(new io_uring_send_xport_impl(sock_fd, pool, frame_size, full_frames, counters));
+}
+
+#else /*HAVE_IO_URING*/
+
+io_uring_recv_xport::sptr io_uring_recv_xport::make(int, buffer_pool::sptr, const size_t, atomic_zero_copy_counters &){
+    throw uhd::not_implemented_error("io_uring is not supported on this platform");
+}
+
+io_uring_send_xport::sptr io_uring_send_xport::make(int, buffer_pool::sptr, const size_t, const bool, atomic_zero_copy_counters &){
+    throw uhd::not_implemented_error("io_uring is not supported on this platform");
+}
+
+#endif /*HAVE_IO_URING*/
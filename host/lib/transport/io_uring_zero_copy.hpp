@@ -0,0 +1,90 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_TRANSPORT_IO_URING_ZERO_COPY_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_IO_URING_ZERO_COPY_HPP
+
+#include "zero_copy_counters.hpp"
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * Receive frames from a connected socket through an io_uring (Linux only).
+     *
+     * Every free frame of the buffer pool has a read posted on the ring,
+     * the frames are registered with the kernel as fixed buffers.
+     * get_recv_buff takes completions from the ring without a system call,
+     * released frames are posted again with the next call into the kernel.
+     */
+    class io_uring_recv_xport : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<io_uring_recv_xport> sptr;
+
+        virtual ~io_uring_recv_xport(void) = 0;
+
+        /*!
+         * Make a new io_uring receiver for the socket.
+         * \param sock_fd the connected socket, it must outlive the receiver
+         * \param pool the frames for the received data
+         * \param frame_size the number of bytes to read into each frame
+         * \param counters the counters of the transport, they must outlive the receiver
+         * \throws uhd::not_implemented_error when not supported on this platform
+         * \throws uhd::os_error when the ring can not be created
+         */
+        static sptr make(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, atomic_zero_copy_counters &counters);
+
+        //! Get the next received frame, null on timeout
+        virtual managed_recv_buffer::sptr get_recv_buff(const double timeout) = 0;
+    };
+
+    /*!
+     * Send frames to a connected socket through an io_uring (Linux only).
+     *
+     * The frames of the buffer pool are registered with the kernel as
+     * fixed buffers, a committed frame is written with one system call
+     * and it is handed out again when the ring reports the write done.
+     */
+    class io_uring_send_xport : boost::noncopyable{
+    public:
+        typedef boost::shared_ptr<io_uring_send_xport> sptr;
+
+        virtual ~io_uring_send_xport(void) = 0;
+
+        /*!
+         * Make a new io_uring sender for the socket.
+         * \param sock_fd the connected socket, it must outlive the sender
+         * \param pool the frames for the data to send
+         * \param frame_size the size of each frame
+         * \param full_frames true to always write the full frame size
+         * \param counters the counters of the transport, they must outlive the sender
+         * \throws uhd::not_implemented_error when not supported on this platform
+         * \throws uhd::os_error when the ring can not be created
+         */
+        static sptr make(int sock_fd, buffer_pool::sptr pool, const size_t frame_size, const bool full_frames, atomic_zero_copy_counters &counters);
+
+        //! Get a free frame to fill, null on timeout
+        virtual managed_send_buffer::sptr get_send_buff(const double timeout) = 0;
+    };
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_IO_URING_ZERO_COPY_HPP */
@@ -16,9 +16,10 @@
 //
 
 #include "libusb1_base.hpp"
+#include "zero_copy_counters.hpp"
 #include <uhd/transport/usb_zero_copy.hpp>
 #include <uhd/transport/buffer_pool.hpp>
-#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/spsc_bounded_buffer.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
 #include <boost/foreach.hpp>
@@ -28,7 +29,8 @@
 #include <boost/make_shared.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/condition_variable.hpp>
+#include <boost/ref.hpp>
+#include <algorithm>
 #include <list>
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
@@ -60,9 +62,9 @@ static const size_t DEFAULT_XFER_SIZE = 32*512; //bytes
         str(boost::format("LIBUSB_ERROR_CODE %d") % code)
 #endif
 
-//! type for sharing the release queue with managed buffers
+//! type for the queue of completed transfers, filled from the libusb callback
 class libusb_zero_copy_mb;
-typedef boost::shared_ptr<bounded_buffer<libusb_zero_copy_mb *> > mb_queue_sptr;
+typedef spsc_bounded_buffer<libusb_zero_copy_mb *> mb_completion_queue;
 
 /*!
  * The libusb docs state that status and actual length can only be read in the callback.
@@ -72,7 +74,6 @@ struct lut_result_t
 {
     lut_result_t(void)
     {
-        completed = 0;
         status = LIBUSB_TRANSFER_COMPLETED;
         actual_length = 0;
 #ifdef UHD_TXRX_DEBUG_PRINTS
@@ -80,11 +81,8 @@ struct lut_result_t
         buff_num = -1;
 #endif
     }
-    int completed;
     libusb_transfer_status status;
     int actual_length;
-    boost::mutex mut;
-    boost::condition_variable usb_transfer_complete;
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
     // These are fore debugging
@@ -94,13 +92,6 @@ struct lut_result_t
 #endif
 };
 
-// Created to be used as an argument to boost::condition_variable::timed_wait() function
-struct lut_result_completed {
-    const lut_result_t& _result;
-    lut_result_completed(const lut_result_t& result):_result(result) {}
-    bool operator()() const {return (_result.completed ? true : false);}
-};
-
 #ifdef UHD_TXRX_DEBUG_PRINTS
 static std::string dbg_prefix("libusb1_zero_copy,");
 static void libusb1_zerocopy_dbg_print_err(std::string msg){
@@ -109,37 +100,18 @@ static void libusb1_zerocopy_dbg_print_err(std::string msg){
 }
 #endif
 
-/*!
- * All libusb callback functions should be marked with the LIBUSB_CALL macro
- * to ensure that they are compiled with the same calling convention as libusb.
- */
-
-//! helper function: handles all async callbacks
-static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut)
-{
-    lut_result_t *r = (lut_result_t *)lut->user_data;
-    boost::lock_guard<boost::mutex> lock(r->mut);
-    r->status = lut->status;
-    r->actual_length = lut->actual_length;
-    r->completed = 1;
-    r->usb_transfer_complete.notify_one();  // wake up thread waiting in wait_for_completion() member function below
-#ifdef UHD_TXRX_DEBUG_PRINTS
-    long end_time = boost::get_system_time().time_of_day().total_microseconds();
-    libusb1_zerocopy_dbg_print_err( (boost::format("libusb_async_cb,%s,%i,%i,%i,%ld,%ld") % (r->is_recv ? "rx":"tx") % r->buff_num % r->actual_length % r->status % end_time % r->start_time).str() );
-#endif
-}
-
 /***********************************************************************
  * Reusable managed buffer:
  *  - Associated with a particular libusb transfer struct.
  *  - Submits the transfer to libusb in the release method.
+ *  - Pushes itself into the completion queue when the transfer is done.
  **********************************************************************/
 class libusb_zero_copy_mb : public managed_buffer
 {
 public:
-    libusb_zero_copy_mb(libusb_transfer *lut, const size_t frame_size, boost::function<void(libusb_zero_copy_mb *)> release_cb, const bool is_recv, const std::string &name):
-        _release_cb(release_cb), _is_recv(is_recv), _name(name),
-        _ctx(libusb::session::get_global_session()->get_context()),
+    libusb_zero_copy_mb(libusb_transfer *lut, const size_t frame_size, boost::function<void(libusb_zero_copy_mb *)> release_cb, mb_completion_queue &completed, const bool is_recv, const std::string &name):
+        in_flight(false),
+        _release_cb(release_cb), _completed(completed), _is_recv(is_recv), _name(name),
         _lut(lut), _frame_size(frame_size) { /* NOP */ }
 
     void release(void){
@@ -159,53 +131,63 @@ public:
             "usb %s submit failed: %s") % _name % libusb_error_name(ret)));
     }
 
+    /*!
+     * Store the result of the transfer and hand the buffer to the caller.
+     * Called from the libusb callback, the queue holds all of the buffers.
+     */
+    UHD_INLINE void complete(const libusb_transfer_status status, const int actual_length)
+    {
+        result.status = status;
+        result.actual_length = actual_length;
+#ifdef UHD_TXRX_DEBUG_PRINTS
+        long end_time = boost::get_system_time().time_of_day().total_microseconds();
+        libusb1_zerocopy_dbg_print_err( (boost::format("libusb_async_cb,%s,%i,%i,%i,%ld,%ld") % (result.is_recv ? "rx":"tx") % result.buff_num % result.actual_length % result.status % end_time % result.start_time).str() );
+#endif
+        _completed.push_with_haste(this);
+    }
+
     template <typename buffer_type>
-    UHD_INLINE typename buffer_type::sptr get_new(const double timeout)
+    UHD_INLINE typename buffer_type::sptr get_new(void)
     {
-        if (wait_for_completion(timeout))
-        {
-            if (result.status != LIBUSB_TRANSFER_COMPLETED) throw uhd::runtime_error(str(boost::format(
-                "usb %s transfer status: %d") % _name % int(result.status)));
-            result.completed = 0;
-            return make(reinterpret_cast<buffer_type *>(this), _lut->buffer, (_is_recv)? result.actual_length : _frame_size);
-        }
-        return typename buffer_type::sptr();
+        return make(reinterpret_cast<buffer_type *>(this), _lut->buffer, (_is_recv)? result.actual_length : _frame_size);
     }
 
     // This is public because it is accessed from the libusb_zero_copy_single constructor
     lut_result_t result;
 
-    /*!
-     * Wait for a managed buffer to become complete.
-     *
-     * \param timeout the wait timeout in seconds.  A negative value will wait forever.
-     * \return true for completion, false for timeout
-     */
-    UHD_INLINE bool wait_for_completion(const double timeout)
-    {
-        boost::unique_lock<boost::mutex> lock(result.mut);
-        if (!result.completed) {
-            if (timeout < 0.0) {
-                result.usb_transfer_complete.wait(lock);
-            } else {
-                const boost::system_time timeout_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1000000));
-                result.usb_transfer_complete.timed_wait(lock, timeout_time, lut_result_completed(result));
-            }
-        }
-        return (result.completed > 0);
-    }
+    //! Submitted and not handed out since (guarded by the mutex of libusb_zero_copy_single)
+    bool in_flight;
 
 private:
     boost::function<void(libusb_zero_copy_mb *)> _release_cb;
+    mb_completion_queue &_completed;
     const bool _is_recv;
     const std::string _name;
-    libusb_context *_ctx;
     libusb_transfer *_lut;
     const size_t _frame_size;
 };
 
+/*!
+ * All libusb callback functions should be marked with the LIBUSB_CALL macro
+ * to ensure that they are compiled with the same calling convention as libusb.
+ */
+
+//! helper function: handles all async callbacks
+static void LIBUSB_CALL libusb_async_cb(libusb_transfer *lut)
+{
+    static_cast<libusb_zero_copy_mb *>(lut->user_data)->complete(lut->status, lut->actual_length);
+}
+
 /***********************************************************************
- * USB zero_copy device class
+ * USB zero_copy device class:
+ *  - The event thread of the libusb session runs the callbacks,
+ *    which push the completed buffers into a lock-free queue.
+ *    (The synchronous libusb calls may run the callbacks in the calling
+ *    thread, but libusb lets only one thread at a time handle events,
+ *    so there is still one producer for the queue.)
+ *  - The caller pops the completed buffers without taking a lock.
+ *  - Released buffers are submitted up to the number of transfers
+ *    in flight, the others wait for a transfer to complete.
  **********************************************************************/
 class libusb_zero_copy_single
 {
@@ -213,16 +195,27 @@ public:
     libusb_zero_copy_single(
         libusb::device_handle::sptr handle,
         const size_t interface, const size_t endpoint,
-        const size_t num_frames, const size_t frame_size
+        const size_t num_frames, const size_t frame_size,
+        const size_t num_xfers_in_flight,
+        const device_addr_t &hints,
+        atomic_zero_copy_counters &counters
     ):
         _handle(handle),
         _num_frames(num_frames),
         _frame_size(frame_size),
-        _buffer_pool(buffer_pool::make(_num_frames, _frame_size)),
-        _enqueued(_num_frames), _released(_num_frames)
+        _is_recv((endpoint & 0x80) != 0),
+        _name(str(boost::format("%s%d") % ((_is_recv)? "rx" : "tx") % int(endpoint & 0x7f))),
+        _counters(counters),
+        _wait_time((_is_recv)? counters.recv_wait_time : counters.send_wait_time),
+        _buffer_pool(buffer_pool::make(_num_frames, _frame_size, hints)),
+        _completed(_num_frames),
+        _max_in_flight(std::max<size_t>(1, std::min(num_xfers_in_flight, _num_frames))),
+        _num_in_flight(0),
+        _released(_num_frames),
+        _failed(_num_frames)
     {
-        const bool is_recv = (endpoint & 0x80) != 0;
-        const std::string name = str(boost::format("%s%d") % ((is_recv)? "rx" : "tx") % int(endpoint & 0x7f));
+        const bool is_recv = _is_recv;
+        const std::string &name = _name;
         _handle->claim_interface(interface);
 
         //flush the buffers out of the recv endpoint
@@ -249,7 +242,7 @@ public:
             UHD_ASSERT_THROW(lut != NULL);
 
             _mb_pool.push_back(boost::make_shared<libusb_zero_copy_mb>(
-                lut, this->get_frame_size(), boost::bind(&libusb_zero_copy_single::enqueue_buffer, this, _1), is_recv, name
+                lut, this->get_frame_size(), boost::bind(&libusb_zero_copy_single::release_buffer, this, _1), boost::ref(_completed), is_recv, name
             ));
 
             libusb_fill_bulk_transfer(
@@ -259,7 +252,7 @@ public:
                 static_cast<unsigned char *>(_buffer_pool->at(i)),      // buffer
                 this->get_frame_size(),                                 // length
                 libusb_transfer_cb_fn(&libusb_async_cb),                // callback
-                static_cast<void *>(&_mb_pool.back()->result),          // user_data
+                static_cast<void *>(_mb_pool.back().get()),             // user_data
                 0                                                       // timeout (ms)
             );
 
@@ -270,12 +263,8 @@ public:
         for (size_t i = 0; i < get_num_frames(); i++)
         {
             libusb_zero_copy_mb &mb = *(_mb_pool[i]);
-            if (is_recv) mb.release();
-            else
-            {
-                mb.result.completed = 1;
-                _enqueued.push_back(&mb);
-            }
+            if (is_recv) this->enqueue_buffer(&mb);
+            else _completed.push_with_haste(&mb);
         }
     }
 
@@ -287,10 +276,13 @@ public:
             libusb_cancel_transfer(lut);
         }
 
-        //process all transfers until timeout occurs
-        BOOST_FOREACH(libusb_zero_copy_mb *mb, _enqueued)
+        //process all transfers in flight until timeout occurs
+        libusb_zero_copy_mb *mb = NULL;
+        boost::mutex::scoped_lock lock(_mutex);
+        while (_num_in_flight != 0 and _completed.pop_with_timed_wait(mb, 0.01))
         {
-            mb->wait_for_completion(0.01);
+            if (mb->in_flight) _num_in_flight--;
+            mb->in_flight = false;
         }
 
         //free all transfers
@@ -303,23 +295,28 @@ public:
     template <typename buffer_type>
     UHD_INLINE typename buffer_type::sptr get_buff(double timeout)
     {
-        typename buffer_type::sptr buff;
-        libusb_zero_copy_mb *front = NULL;
-        boost::mutex::scoped_lock lock(_mutex);
-        if (_enqueued.empty())
+        libusb_zero_copy_mb *mb = NULL;
+        if (not _failed.empty())
         {
-            _cond.timed_wait(lock, boost::posix_time::microseconds(long(timeout*1e6)));
+            mb = _failed.front();
+            _failed.pop_front();
+            return mb->get_new<buffer_type>();
+        }
+        if (not _completed.pop_with_haste(mb))
+        {
+            counted_wait wait(_wait_time);
+            if (not _completed.pop_with_timed_wait(mb, timeout)) return typename buffer_type::sptr();
         }
-        if (_enqueued.empty()) return buff;
-        front = _enqueued.front();
-
-        lock.unlock();
-        buff = front->get_new<buffer_type>(timeout);
-        lock.lock();
 
-        if (buff) _enqueued.pop_front();
-        this->submit_what_we_can();
-        return buff;
+        //the transfer is done -> another released buffer can be submitted
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if (mb->in_flight) _num_in_flight--;
+            mb->in_flight = false;
+            this->submit_what_we_can();
+        }
+        if (mb->result.status != LIBUSB_TRANSFER_COMPLETED) this->fail_transfer(mb);
+        return mb->get_new<buffer_type>();
     }
 
     UHD_INLINE size_t get_num_frames(void) const { return _num_frames; }
@@ -328,32 +325,64 @@ public:
 private:
     libusb::device_handle::sptr _handle;
     const size_t _num_frames, _frame_size;
+    const bool _is_recv;
+    const std::string _name;
+    atomic_zero_copy_counters &_counters;
+    atomic_counter &_wait_time;
 
     //! Storage for transfer related objects
     buffer_pool::sptr _buffer_pool;
     std::vector<boost::shared_ptr<libusb_zero_copy_mb> > _mb_pool;
 
+    //! completed transfers in order, pushed by the callback and popped by the caller
+    mb_completion_queue _completed;
+
+    //! released buffers wait here while the maximum of transfers is in flight
     boost::mutex _mutex;
-    boost::condition_variable _cond;
+    const size_t _max_in_flight;
+    size_t _num_in_flight;
+    boost::circular_buffer<libusb_zero_copy_mb *> _released;
 
-    //! why 2 queues? there is room in the future to have > N buffers but only N in flight
-    boost::circular_buffer<libusb_zero_copy_mb *> _enqueued, _released;
+    //! send buffers of failed transfers, free for the next call (caller only)
+    boost::circular_buffer<libusb_zero_copy_mb *> _failed;
+
+    //! the caller is done with the buffer -> count it and hand it to libusb
+    void release_buffer(libusb_zero_copy_mb *mb)
+    {
+        if (_is_recv) count_recv_release(_counters);
+        else count_send_commit(_counters, mb->size());
+        this->enqueue_buffer(mb);
+    }
+
+    /*!
+     * Give the buffer of a failed transfer back and throw the error:
+     * a receive transfer is submitted again, a send buffer is handed out
+     * by the next call, so that the transport does not lose the frame.
+     */
+    void fail_transfer(libusb_zero_copy_mb *mb)
+    {
+        const int status = int(mb->result.status);
+        mb->result.status = LIBUSB_TRANSFER_COMPLETED;
+        if (_is_recv) this->enqueue_buffer(mb);
+        else _failed.push_back(mb);
+        throw uhd::runtime_error(str(boost::format(
+            "usb %s transfer status: %d") % _name % status));
+    }
 
     void enqueue_buffer(libusb_zero_copy_mb *mb)
     {
         boost::mutex::scoped_lock l(_mutex);
         _released.push_back(mb);
         this->submit_what_we_can();
-        l.unlock();
-        _cond.notify_one();
     }
 
     void submit_what_we_can(void)
     {
-        while (not _released.empty() and not _enqueued.full())
+        while (not _released.empty() and _num_in_flight < _max_in_flight)
         {
             _released.front()->submit();
-            _enqueued.push_back(_released.front());
+            _released.front()->in_flight = true;
+            _num_in_flight++;
             _released.pop_front();
         }
     }
@@ -375,34 +404,44 @@ struct libusb_zero_copy_impl : usb_zero_copy
         const size_t send_endpoint,
         const device_addr_t &hints
     ){
+        //by default, every frame can be in flight
+        const size_t num_recv_frames = size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_XFERS));
+        const size_t num_send_frames = size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_XFERS));
         _recv_impl.reset(new libusb_zero_copy_single(
-            handle, recv_interface, (recv_endpoint & 0x7f) | 0x80,
-            size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_XFERS)),
-            size_t(hints.cast<double>("recv_frame_size", DEFAULT_XFER_SIZE))));
+            handle, recv_interface, (recv_endpoint & 0x7f) | 0x80, num_recv_frames,
+            size_t(hints.cast<double>("recv_frame_size", DEFAULT_XFER_SIZE)),
+            size_t(hints.cast<double>("recv_xfers_in_flight", double(num_recv_frames))), hints, _counters));
         _send_impl.reset(new libusb_zero_copy_single(
-            handle, send_interface, (send_endpoint & 0x7f) | 0x00,
-            size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_XFERS)),
-            size_t(hints.cast<double>("send_frame_size", DEFAULT_XFER_SIZE))));
+            handle, send_interface, (send_endpoint & 0x7f) | 0x00, num_send_frames,
+            size_t(hints.cast<double>("send_frame_size", DEFAULT_XFER_SIZE)),
+            size_t(hints.cast<double>("send_xfers_in_flight", double(num_send_frames))), hints, _counters));
     }
 
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
         boost::mutex::scoped_lock l(_recv_mutex);
-        return _recv_impl->get_buff<managed_recv_buffer>(timeout);
+        managed_recv_buffer::sptr buff = _recv_impl->get_buff<managed_recv_buffer>(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     managed_send_buffer::sptr get_send_buff(double timeout)
     {
         boost::mutex::scoped_lock l(_send_mutex);
-        return _send_impl->get_buff<managed_send_buffer>(timeout);
+        managed_send_buffer::sptr buff = _send_impl->get_buff<managed_send_buffer>(timeout);
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
+    zero_copy_counters get_counters(void) const { return _counters.snapshot(); }
+
     size_t get_num_recv_frames(void) const { return _recv_impl->get_num_frames(); }
     size_t get_num_send_frames(void) const { return _send_impl->get_num_frames(); }
 
     size_t get_recv_frame_size(void) const { return _recv_impl->get_frame_size(); }
     size_t get_send_frame_size(void) const { return _send_impl->get_frame_size(); }
 
+    atomic_zero_copy_counters _counters;
     boost::shared_ptr<libusb_zero_copy_single> _recv_impl, _send_impl;
     boost::mutex _recv_mutex, _send_mutex;
 };
@@ -28,6 +28,7 @@
 #include <boost/thread/thread.hpp> //sleep
 #include <vector>
 #include <algorithm>    // std::max
+#include "zero_copy_counters.hpp"
 //@TODO: Move the register defs required by the class to a common location
 #include "../usrp/x300/x300_regs.hpp"
 
@@ -40,11 +41,12 @@ typedef uint64_t fifo_data_t;
 class nirio_zero_copy_mrb : public managed_recv_buffer
 {
 public:
-    nirio_zero_copy_mrb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size):
-        _fifo(fifo), _frame_size(frame_size) { }
+    nirio_zero_copy_mrb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _fifo(fifo), _frame_size(frame_size), _counters(counters) { }
 
     void release(void)
     {
+        count_recv_release(_counters);
         _fifo.release(_frame_size / sizeof(fifo_data_t));
     }
 
@@ -53,6 +55,7 @@ public:
         nirio_status status = 0;
         size_t elems_acquired = 0;
         size_t elems_remaining = 0;
+        counted_wait wait(_counters.recv_wait_time);
         nirio_status_chain(_fifo.acquire(
             _typed_buffer, _frame_size / sizeof(fifo_data_t),
             static_cast<uint32_t>(timeout*1000),
@@ -76,16 +79,18 @@ private:
     fifo_data_t*                _typed_buffer;
     const size_t                _frame_size;
     size_t                      _num_frames;
+    atomic_zero_copy_counters&         _counters;
 };
 
 class nirio_zero_copy_msb : public managed_send_buffer
 {
 public:
-    nirio_zero_copy_msb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size):
-        _fifo(fifo), _frame_size(frame_size) { }
+    nirio_zero_copy_msb(nirio_fifo<fifo_data_t>& fifo, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _fifo(fifo), _frame_size(frame_size), _counters(counters) { }
 
     void release(void)
     {
+        count_send_commit(_counters, size());
         _fifo.release(_frame_size / sizeof(fifo_data_t));
     }
 
@@ -94,6 +99,7 @@ public:
         nirio_status status = 0;
         size_t elems_acquired = 0;
         size_t elems_remaining = 0;
+        counted_wait wait(_counters.send_wait_time);
         nirio_status_chain(_fifo.acquire(
             _typed_buffer, _frame_size / sizeof(fifo_data_t),
             static_cast<uint32_t>(timeout*1000),
@@ -117,6 +123,7 @@ private:
     fifo_data_t*                _typed_buffer;
     const size_t                _frame_size;
     size_t                      _num_frames;
+    atomic_zero_copy_counters&         _counters;
 };
 
 class nirio_zero_copy_impl : public nirio_zero_copy {
@@ -126,7 +133,8 @@ public:
     nirio_zero_copy_impl(
         uhd::niusrprio::niusrprio_session::sptr fpga_session,
         uint32_t instance,
-        const zero_copy_xport_params& xport_params
+        const zero_copy_xport_params& xport_params,
+        const device_addr_t &hints
     ):
         _fpga_session(fpga_session),
         _fifo_instance(instance),
@@ -140,8 +148,8 @@ public:
         UHD_LOG << boost::format("nirio zero-copy TX transport configured with frame size = %u, #frames = %u, buffer size = %u\n")
                     % _xport_params.send_frame_size % _xport_params.num_send_frames % (_xport_params.send_frame_size * _xport_params.num_send_frames);
 
-        _recv_buffer_pool = buffer_pool::make(_xport_params.num_recv_frames, _xport_params.recv_frame_size);
-        _send_buffer_pool = buffer_pool::make(_xport_params.num_send_frames, _xport_params.send_frame_size);
+        _recv_buffer_pool = buffer_pool::make(_xport_params.num_recv_frames, _xport_params.recv_frame_size, hints);
+        _send_buffer_pool = buffer_pool::make(_xport_params.num_send_frames, _xport_params.send_frame_size, hints);
 
         nirio_status status = 0;
         size_t actual_depth = 0, actual_size = 0;
@@ -201,13 +209,13 @@ public:
                 //allocate re-usable managed receive buffers
                 for (size_t i = 0; i < get_num_recv_frames(); i++){
                     _mrb_pool.push_back(boost::shared_ptr<nirio_zero_copy_mrb>(new nirio_zero_copy_mrb(
-                        *_recv_fifo, get_recv_frame_size())));
+                        *_recv_fifo, get_recv_frame_size(), _counters)));
                 }
 
                 //allocate re-usable managed send buffers
                 for (size_t i = 0; i < get_num_send_frames(); i++){
                     _msb_pool.push_back(boost::shared_ptr<nirio_zero_copy_msb>(new nirio_zero_copy_msb(
-                        *_send_fifo, get_send_frame_size())));
+                        *_send_fifo, get_send_frame_size(), _counters)));
                 }
             }
         } else {
@@ -240,7 +248,9 @@ public:
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
         if (_next_recv_buff_index == _xport_params.num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        managed_recv_buffer::sptr buff = _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const {return _xport_params.num_recv_frames;}
@@ -253,12 +263,16 @@ public:
     managed_send_buffer::sptr get_send_buff(double timeout)
     {
         if (_next_send_buff_index == _xport_params.num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _xport_params.num_send_frames;}
     size_t get_send_frame_size(void) const {return _xport_params.send_frame_size;}
 
+    zero_copy_counters get_counters(void) const {return _counters.snapshot();}
+
 private:
 
     UHD_INLINE niriok_proxy::sptr _proxy() { return _fpga_session->get_kernel_proxy(); }
@@ -330,6 +344,9 @@ private:
         }
     }
 
+    //counters -> declared first, the managed buffers refer to them
+    atomic_zero_copy_counters _counters;
+
     //memory management -> buffers and fifos
     niusrprio::niusrprio_session::sptr _fpga_session;
     uint32_t _fifo_instance;
@@ -400,6 +417,6 @@ nirio_zero_copy::sptr nirio_zero_copy::make(
         xport_params.num_send_frames = usr_num_send_frames;
     }
 
-    return nirio_zero_copy::sptr(new nirio_zero_copy_impl(fpga_session, instance, xport_params));
+    return nirio_zero_copy::sptr(new nirio_zero_copy_impl(fpga_session, instance, xport_params, hints));
 }
 
@@ -18,6 +18,7 @@
 #ifndef INCLUDED_LIBUHD_TRANSPORT_SUPER_RECV_PACKET_HANDLER_HPP
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_RECV_PACKET_HANDLER_HPP
 
+#include "convert_pool.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
@@ -29,13 +30,12 @@
 #include <uhd/types/metadata.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <uhd/transport/zero_copy.hpp>
-#include <boost/dynamic_bitset.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
 #include <boost/format.hpp>
 #include <boost/bind.hpp>
 #include <boost/make_shared.hpp>
-#include <boost/thread/barrier.hpp>
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
@@ -48,6 +48,9 @@
 
 namespace uhd{ namespace transport{ namespace sph{
 
+//! Default nsamps_per_buff from where recv() uses non-temporal stores
+static const size_t DEFAULT_NT_STORES_NSAMPS = 1 << 20;
+
 UHD_INLINE boost::uint32_t get_context_code(
     const boost::uint32_t *vrt_hdr, const vrt::if_packet_info_t &if_packet_info
 ){
@@ -60,6 +63,57 @@ UHD_INLINE boost::uint32_t get_context_code(
 typedef boost::function<void(void)> handle_overflow_type;
 static inline void handle_overflow_nop(void){}
 
+/***********************************************************************
+ * Zero-copy receive buffers:
+ * Holds the managed buffers of one aligned packet per channel,
+ * the frames go back to the transport with the last reference.
+ **********************************************************************/
+class recv_zero_copy_buffs_impl : public rx_zero_copy_buffs{
+public:
+    typedef boost::shared_ptr<recv_zero_copy_buffs_impl> sptr;
+
+    recv_zero_copy_buffs_impl(const size_t size, const size_t nsamps):
+        _buffs(size), _payloads(size, NULL), _nsamps(nsamps)
+    {
+        /* NOP */
+    }
+
+    size_t get_num_channels(void) const{
+        return _payloads.size();
+    }
+
+    size_t get_num_samps(void) const{
+        return _nsamps;
+    }
+
+    const void *get(const size_t chan) const{
+        return _payloads.at(chan);
+    }
+
+    void release(void){
+        for (size_t i = 0; i < _buffs.size(); i++){
+            _buffs[i].reset();
+            _payloads[i] = NULL;
+        }
+    }
+
+    //! Take over the buffer of a channel from the packet handler
+    void lend(const size_t chan, managed_recv_buffer::sptr &buff, const void *payload){
+        _buffs[chan].swap(buff);
+        _payloads[chan] = payload;
+    }
+
+    //! Lend fewer samples, like a recv() that clips the count
+    void clip(const size_t nsamps){
+        _nsamps = std::min(_nsamps, nsamps);
+    }
+
+private:
+    std::vector<managed_recv_buffer::sptr> _buffs;
+    std::vector<const void *> _payloads;
+    size_t _nsamps;
+};
+
 /***********************************************************************
  * Super receive packet handler
  *
@@ -81,6 +135,8 @@ public:
      */
     recv_packet_handler(const size_t size = 1):
         _queue_error_for_next_call(false),
+        _bytes_per_cpu_item(0),
+        _num_alignment_drops(0),
         _buffers_infos_index(0)
     {
         #ifdef  ERROR_INJECT_DROPPED_PACKETS
@@ -91,23 +147,16 @@ public:
         set_alignment_failure_threshold(1000);
     }
 
-    ~recv_packet_handler(void){
-        _task_barrier.interrupt();
-        _task_handlers.clear();
-    }
-
     //! Resize the number of transport channels
     void resize(const size_t size){
         if (this->size() == size) return;
-        _task_handlers.clear();
         _props.resize(size);
+        _alignment_drops.assign(size, 0);
+        _num_alignment_drops = 0;
         //re-initialize all buffers infos by re-creating the vector
         _buffers_infos = std::vector<buffers_info_type>(4, buffers_info_type(size));
-        _task_barrier.resize(size);
-        _task_handlers.resize(size);
-        for (size_t i = 1/*skip 0*/; i < size; i++){
-            _task_handlers[i] = task::make(boost::bind(&recv_packet_handler::converter_thread_task, this, i));
-        };
+        //the channels are converted in parallel on the shared pool
+        if (size > 1 and not _convert_pool) _convert_pool = convert_pool::get_shared();
     }
 
     //! Get the channel width of this handler
@@ -175,15 +224,50 @@ public:
         if (do_init) handle_flowctrl(0);
     }
 
-    //! Set the conversion routine for all channels
-    void set_converter(const uhd::convert::id_type &id){
+    /*!
+     * Set the conversion routine for all channels.
+     *
+     * Large receive buffers are written with non-temporal stores when
+     * there is such a converter, so the samples do not evict the packet
+     * buffers from the cache. Stream args:
+     * - nt_stores: 1 to always use them, 0 to never use them
+     * - nt_stores_nsamps: nsamps_per_buff from where they are used
+     *
+     * The stream args can also set an IQ and DC correction for each channel,
+     * which is then applied during the conversion (see correction_type).
+     *
+     * \param id the conversion routine id
+     * \param args the stream args (stream_args_t::args)
+     */
+    void set_converter(const uhd::convert::id_type &id, const uhd::device_addr_t &args = uhd::device_addr_t()){
         _num_outputs = id.num_outputs;
-        _converter = uhd::convert::get_converter(id)();
+        _default_converter = uhd::convert::get_converter(id)();
+        _nt_converter.reset();
+        _nt_stores_nsamps = args.cast<size_t>("nt_stores_nsamps", DEFAULT_NT_STORES_NSAMPS);
+        if (args.has_key("nt_stores")) _nt_stores_nsamps = (args.cast<int>("nt_stores", 0) != 0)? 0 : size_t(~0);
+        if (_nt_stores_nsamps != size_t(~0)) try{
+            _nt_converter = uhd::convert::get_converter(id, uhd::convert::PRIORITY_NON_TEMPORAL)();
+        }
+        catch(const uhd::key_error &){
+            //no streaming store converter for this id, use the default one
+        }
+        _converter = _default_converter;
+        _correcting_converters = uhd::convert::make_correcting_converters(id, args, this->size());
         this->set_scale_factor(1/32767.); //update after setting converter
         _bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.input_format);
         _bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.output_format);
     }
 
+    //! Get the size of a sample in the CPU format, 0 before the converter is set
+    size_t get_bytes_per_cpu_item(void) const{
+        return _bytes_per_cpu_item;
+    }
+
+    //! Get the packets discarded on a channel to align the last receive
+    size_t get_alignment_drops(const size_t chan) const{
+        return _alignment_drops.at(chan);
+    }
+
     //! Set the transport channel's overflow handler
     void set_overflow_handler(const size_t xport_chan, const handle_overflow_type &handle_overflow){
         _props.at(xport_chan).handle_overflow = handle_overflow;
@@ -191,7 +275,11 @@ public:
 
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
-        _converter->set_scalar(scale_factor);
+        _default_converter->set_scalar(scale_factor);
+        if (_nt_converter) _nt_converter->set_scalar(scale_factor);
+        BOOST_FOREACH(uhd::convert::converter::sptr &c, _correcting_converters){
+            c->set_scalar(scale_factor);
+        }
     }
 
     //! Set the callback to issue stream commands
@@ -221,6 +309,8 @@ public:
         const double timeout,
         const bool one_packet
     ){
+        this->reset_alignment_drops();
+
         //handle metadata queued from a previous receive
         if (_queue_error_for_next_call){
             _queue_error_for_next_call = false;
@@ -230,6 +320,9 @@ public:
             if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return 0;
         }
 
+        //write large buffers with non-temporal stores
+        _converter = (_nt_converter and nsamps_per_buff >= _nt_stores_nsamps)? _nt_converter : _default_converter;
+
         size_t accum_num_samps = recv_one_packet(
             buffs, nsamps_per_buff, metadata, timeout
         );
@@ -264,6 +357,58 @@ public:
         return accum_num_samps;
     }
 
+    /*******************************************************************
+     * Receive zero-copy:
+     * Lend the payloads of the next aligned packets to the caller.
+     * A fragment left by recv() is lent from its current position.
+     ******************************************************************/
+    UHD_INLINE recv_zero_copy_buffs_impl::sptr recv_zero_copy(
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        //the payload of a transport interleaves the samples of its outputs
+        if (_num_outputs != 1){
+            throw uhd::not_implemented_error("cannot lend buffers with several channels per transport, use recv()");
+        }
+
+        this->reset_alignment_drops();
+
+        //handle metadata queued from a previous receive
+        if (_queue_error_for_next_call){
+            _queue_error_for_next_call = false;
+            metadata = _queue_metadata;
+            if (_queue_metadata.error_code != rx_metadata_t::ERROR_CODE_TIMEOUT) return recv_zero_copy_buffs_impl::sptr();
+        }
+
+        //get the next buffer if the current one has expired
+        if (get_curr_buffer_info().data_bytes_to_copy == 0)
+        {
+            //perform receive with alignment logic
+            get_aligned_buffs(timeout);
+        }
+
+        buffers_info_type &info = get_curr_buffer_info();
+        metadata = info.metadata;
+        if (info.data_bytes_to_copy == 0) return recv_zero_copy_buffs_impl::sptr();
+
+        //interpolate the time spec (useful when this is a fragment)
+        metadata.time_spec += time_spec_t::from_ticks(info.fragment_offset_in_samps, _samp_rate);
+        metadata.more_fragments = false;
+        metadata.fragment_offset = info.fragment_offset_in_samps;
+
+        //hand over the managed buffers, the handler is done with this packet
+        const size_t nsamps = info.data_bytes_to_copy/_bytes_per_otw_item;
+        recv_zero_copy_buffs_impl::sptr buffs =
+            boost::make_shared<recv_zero_copy_buffs_impl>(this->size(), nsamps);
+        for (size_t i = 0; i < this->size(); i++){
+            buffs->lend(i, info[i].buff, info[i].copy_buff);
+        }
+        info.data_bytes_to_copy = 0;
+        info.fragment_offset_in_samps += nsamps;
+
+        return buffs;
+    }
+
 private:
     vrt_unpacker_type _vrt_unpacker;
     size_t _header_offset_words32;
@@ -288,7 +433,12 @@ private:
     size_t _num_outputs;
     size_t _bytes_per_otw_item; //used in conversion
     size_t _bytes_per_cpu_item; //used in conversion
+    std::vector<size_t> _alignment_drops; //packets discarded per channel in this receive
+    size_t _num_alignment_drops; //packets discarded over all channels in this receive
     uhd::convert::converter::sptr _converter; //used in conversion
+    uhd::convert::converter::sptr _default_converter, _nt_converter;
+    std::vector<uhd::convert::converter::sptr> _correcting_converters; //one per channel
+    size_t _nt_stores_nsamps;
 
     //! information stored for a received buffer
     struct per_buffer_info_type{
@@ -310,14 +460,17 @@ private:
     struct buffers_info_type : std::vector<per_buffer_info_type> {
         buffers_info_type(const size_t size):
             std::vector<per_buffer_info_type>(size),
-            indexes_todo(size, true),
             alignment_time_valid(false),
             data_bytes_to_copy(0),
             fragment_offset_in_samps(0)
-        {/* NOP */}
+        {
+            indexes_todo.reserve(size);
+            indexes_aligned.reserve(size);
+            this->reset_indexes();
+        }
         void reset()
         {
-            indexes_todo.set();
+            this->reset_indexes();
             alignment_time = time_spec_t(0.0);
             alignment_time_valid = false;
             data_bytes_to_copy = 0;
@@ -326,7 +479,15 @@ private:
             for (size_t i = 0; i < size(); i++)
                 at(i).reset();
         }
-        boost::dynamic_bitset<> indexes_todo; //used in alignment logic
+        void reset_indexes()
+        {
+            //a stack, the lowest index is processed first
+            indexes_todo.clear();
+            for (size_t i = size(); i > 0; i--) indexes_todo.push_back(i-1);
+            indexes_aligned.clear();
+        }
+        std::vector<size_t> indexes_todo; //used in alignment logic
+        std::vector<size_t> indexes_aligned; //used in alignment logic
         time_spec_t alignment_time; //used in alignment logic
         bool alignment_time_valid; //used in alignment logic
         size_t data_bytes_to_copy; //keeps track of state
@@ -464,30 +625,63 @@ private:
     /*******************************************************************
      * Alignment check:
      * Check the received packet for alignment and mark accordingly.
+     * The index being checked is always at the top of the todo stack.
      ******************************************************************/
     UHD_INLINE void alignment_check(
         const size_t index, buffers_info_type &info
     ){
         //if alignment time was not valid or if the sequence id is newer:
         //  use this index's time as the alignment time
-        //  reset the indexes list and remove this index
         if (not info.alignment_time_valid or info[index].time > info.alignment_time){
-            info.alignment_time_valid = true;
-            info.alignment_time = info[index].time;
-            info.indexes_todo.set();
-            info.indexes_todo.reset(index);
-            info.data_bytes_to_copy = info[index].ifpi.num_payload_bytes;
+            this->alignment_restart(index, info);
         }
 
         //if the sequence id matches:
         //  remove this index from the list and continue
         else if (info[index].time == info.alignment_time){
-            info.indexes_todo.reset(index);
+            info.indexes_todo.pop_back();
+            info.indexes_aligned.push_back(index);
         }
 
         //if the sequence id is older:
-        //  continue with the same index to try again
-        //else if (info[index].time < info.alignment_time)...
+        //  the packet is discarded, continue with the same index to try again
+        else{
+            this->alignment_drop(index);
+        }
+    }
+
+    /*******************************************************************
+     * Alignment restart:
+     * Align on the time of the packet at this index.
+     * The packets already aligned to the old time are discarded
+     * and their indexes go back on the list, all in a single pass.
+     ******************************************************************/
+    UHD_INLINE void alignment_restart(
+        const size_t index, buffers_info_type &info
+    ){
+        info.alignment_time_valid = true;
+        info.alignment_time = info[index].time;
+        info.data_bytes_to_copy = info[index].ifpi.num_payload_bytes;
+        info.indexes_todo.pop_back();
+        for (size_t i = 0; i < info.indexes_aligned.size(); i++){
+            const size_t stale_index = info.indexes_aligned[i];
+            info.indexes_todo.push_back(stale_index);
+            this->alignment_drop(stale_index);
+        }
+        info.indexes_aligned.clear();
+        info.indexes_aligned.push_back(index);
+    }
+
+    UHD_INLINE void alignment_drop(const size_t index){
+        _alignment_drops[index]++;
+        _num_alignment_drops++;
+    }
+
+    //! Start the drop counts of a receive call, cleared only when used
+    UHD_INLINE void reset_alignment_drops(void){
+        if (_num_alignment_drops == 0) return;
+        std::fill(_alignment_drops.begin(), _alignment_drops.end(), 0);
+        _num_alignment_drops = 0;
     }
 
     /*******************************************************************
@@ -511,10 +705,10 @@ private:
         // - Handle the packet type yielded by the receive.
         // - Check the timestamps for alignment conditions.
         size_t iterations = 0;
-        while (curr_info.indexes_todo.any()){
+        while (not curr_info.indexes_todo.empty()){
 
             //get the index to process for this iteration
-            const size_t index = curr_info.indexes_todo.find_first();
+            const size_t index = curr_info.indexes_todo.back();
             packet_type packet;
 
             //receive a single packet from the transport
@@ -604,6 +798,8 @@ private:
         curr_info.metadata.start_of_burst = curr_info[0].ifpi.sob;
         curr_info.metadata.end_of_burst = curr_info[0].ifpi.eob;
         curr_info.metadata.error_code = rx_metadata_t::ERROR_CODE_NONE;
+        curr_info.metadata.has_recv_time = curr_info[0].buff->has_recv_time();
+        curr_info.metadata.recv_time = curr_info[0].buff->get_recv_time();
 
     }
 
@@ -646,7 +842,8 @@ private:
         _convert_bytes_to_copy = bytes_to_copy;
 
         //perform N channels of conversion
-        converter_thread_task(0);
+        if (_convert_pool) _convert_pool->run(&recv_packet_handler::convert_job, this, this->size());
+        else this->convert_channel(0);
 
         //update the copy buffer's availability
         info.data_bytes_to_copy -= bytes_to_copy;
@@ -660,14 +857,16 @@ private:
     }
 
     /*******************************************************************
-     * Perform one thread's work of the conversion task.
-     * The entry and exit use a dual synchronization barrier,
-     * to wait for data to become ready and block until completion.
+     * Perform the conversion of one channel:
+     * Called on the receiving thread or a worker of the convert pool.
      ******************************************************************/
-    UHD_INLINE void converter_thread_task(const size_t index)
+    static void convert_job(void *handler, const size_t index)
     {
-        _task_barrier.wait();
+        static_cast<recv_packet_handler *>(handler)->convert_channel(index);
+    }
 
+    UHD_INLINE void convert_channel(const size_t index)
+    {
         //shortcut references to local data structures
         buffers_info_type &buff_info = get_curr_buffer_info();
         per_buffer_info_type &info = buff_info[index];
@@ -682,7 +881,9 @@ private:
         const ref_vector<void *> out_buffs(io_buffs, _num_outputs);
 
         //perform the conversion operation
-        _converter->conv(info.copy_buff, out_buffs, _convert_nsamps);
+        const uhd::convert::converter::sptr &converter = (_correcting_converters.empty())?
+            _converter : _correcting_converters[index];
+        converter->conv(info.copy_buff, out_buffs, _convert_nsamps);
 
         //advance the pointer for the source buffer
         info.copy_buff += _convert_bytes_to_copy;
@@ -691,13 +892,10 @@ private:
         if (buff_info.data_bytes_to_copy == _convert_bytes_to_copy){
             info.buff.reset(); //effectively a release
         }
-
-        if (index == 0) _task_barrier.wait_others();
     }
 
-    //! Shared variables for the worker threads
-    reusable_barrier _task_barrier;
-    std::vector<task::sptr> _task_handlers;
+    //! Shared variables for the conversion jobs
+    convert_pool::sptr _convert_pool;
     size_t _convert_nsamps;
     const rx_streamer::buffs_type *_convert_buffs;
     size_t _convert_buffer_offset_bytes;
@@ -778,6 +976,14 @@ public:
         return _max_num_samps;
     }
 
+    size_t get_cpu_item_size(void) const{
+        return this->get_bytes_per_cpu_item();
+    }
+
+    size_t get_alignment_drops(const size_t chan) const{
+        return recv_packet_handler::get_alignment_drops(chan);
+    }
+
     size_t recv(
         const rx_streamer::buffs_type &buffs,
         const size_t nsamps_per_buff,
@@ -788,6 +994,13 @@ public:
         return recv_packet_handler::recv(buffs, nsamps_per_buff, metadata, timeout, one_packet);
     }
 
+    rx_zero_copy_buffs::sptr recv_zero_copy(
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        return recv_packet_handler::recv_zero_copy(metadata, timeout);
+    }
+
     void issue_stream_cmd(const stream_cmd_t &stream_cmd)
     {
         return recv_packet_handler::issue_stream_cmd(stream_cmd);
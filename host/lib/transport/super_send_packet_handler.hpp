@@ -18,6 +18,7 @@
 #ifndef INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP
 #define INCLUDED_LIBUHD_TRANSPORT_SUPER_SEND_PACKET_HANDLER_HPP
 
+#include "convert_pool.hpp"
 #include <uhd/config.hpp>
 #include <uhd/exception.hpp>
 #include <uhd/convert.hpp>
@@ -32,7 +33,10 @@
 #include <boost/thread/thread_time.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
+#include <boost/format.hpp>
+#include <boost/make_shared.hpp>
 #include <iostream>
+#include <cstring>
 #include <vector>
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
@@ -48,6 +52,48 @@ namespace uhd {
 namespace transport {
 namespace sph {
 
+/***********************************************************************
+ * Zero-copy send buffers:
+ * Points at the payload regions of the send buffers that the
+ * packet handler holds for each channel until they are committed.
+ **********************************************************************/
+class send_zero_copy_buffs_impl : public tx_zero_copy_buffs{
+public:
+    send_zero_copy_buffs_impl(const size_t size, const size_t nsamps):
+        _payloads(size, NULL), _nsamps(nsamps)
+    {
+        /* NOP */
+    }
+
+    size_t get_num_channels(void) const{
+        return _payloads.size();
+    }
+
+    size_t get_num_samps(void) const{
+        return _nsamps;
+    }
+
+    void *get(const size_t chan) const{
+        return _payloads.at(chan);
+    }
+
+    void lend(const size_t chan, char *payload){
+        _payloads[chan] = payload;
+    }
+
+    bool is_lent(void) const{
+        return _payloads.front() != NULL;
+    }
+
+    void clear(void){
+        std::fill(_payloads.begin(), _payloads.end(), static_cast<char *>(NULL));
+    }
+
+private:
+    std::vector<char *> _payloads;
+    const size_t _nsamps;
+};
+
 /***********************************************************************
  * Super send packet handler
  *
@@ -58,6 +104,7 @@ namespace sph {
 class send_packet_handler{
 public:
     typedef boost::function<managed_send_buffer::sptr(double)> get_buff_type;
+    typedef boost::function<void(void)> flush_type;
     typedef boost::function<bool(uhd::async_metadata_t &, const double)> async_receiver_type;
     typedef void(*vrt_packer_type)(boost::uint32_t *, vrt::if_packet_info_t &);
     //typedef boost::function<void(boost::uint32_t *, vrt::if_packet_info_t &)> vrt_packer_type;
@@ -73,23 +120,14 @@ public:
         this->resize(size);
     }
 
-    ~send_packet_handler(void){
-        _task_barrier.interrupt();
-        _task_handlers.clear();
-    }
-
     //! Resize the number of transport channels
     void resize(const size_t size){
         if (this->size() == size) return;
-        _task_handlers.clear();
         _props.resize(size);
         static const boost::uint64_t zero = 0;
         _zero_buffs.resize(size, &zero);
-        _task_barrier.resize(size);
-        _task_handlers.resize(size);
-        for (size_t i = 1/*skip 0*/; i < size; i++){
-            _task_handlers[i] = task::make(boost::bind(&send_packet_handler::converter_thread_task, this, i));
-        };
+        //the channels are converted in parallel on the shared pool
+        if (size > 1 and not _convert_pool) _convert_pool = convert_pool::get_shared();
     }
 
     //! Get the channel width of this handler
@@ -133,10 +171,31 @@ public:
         _props.at(xport_chan).get_buff = get_buff;
     }
 
-    //! Set the conversion routine for all channels
-    void set_converter(const uhd::convert::id_type &id){
+    /*!
+     * Set the function to flush the committed buffers of a transport.
+     * It is called at the end of a burst and after timed sends,
+     * so that transports which send in batches do not hold back
+     * the last packets of a burst or packets that must arrive in time.
+     * \param xport_chan which transport channel
+     * \param flush the flush function
+     */
+    void set_xport_chan_flush(const size_t xport_chan, const flush_type &flush){
+        _props.at(xport_chan).flush = flush;
+    }
+
+    /*!
+     * Set the conversion routine for all channels.
+     *
+     * The stream args can set an IQ and DC correction for each channel,
+     * which is then applied during the conversion (see correction_type).
+     *
+     * \param id the conversion routine id
+     * \param args the stream args (stream_args_t::args)
+     */
+    void set_converter(const uhd::convert::id_type &id, const uhd::device_addr_t &args = uhd::device_addr_t()){
         _num_inputs = id.num_inputs;
         _converter = uhd::convert::get_converter(id)();
+        _correcting_converters = uhd::convert::make_correcting_converters(id, args, this->size());
         this->set_scale_factor(32767.); //update after setting converter
         _bytes_per_otw_item = uhd::convert::get_bytes_per_item(id.output_format);
         _bytes_per_cpu_item = uhd::convert::get_bytes_per_item(id.input_format);
@@ -154,6 +213,9 @@ public:
     //! Set the scale factor used in float conversion
     void set_scale_factor(const double scale_factor){
         _converter->set_scalar(scale_factor);
+        BOOST_FOREACH(uhd::convert::converter::sptr &c, _correcting_converters){
+            c->set_scalar(scale_factor);
+        }
     }
 
     //! Set the callback to get async messages
@@ -174,7 +236,7 @@ public:
     /*******************************************************************
      * Send:
      * The entry point for the fast-path send calls.
-     * Dispatch into combinations of single packet send calls.
+     * Flush the transports at the end of a burst and after timed sends.
      ******************************************************************/
     UHD_INLINE size_t send(
         const uhd::tx_streamer::buffs_type &buffs,
@@ -182,8 +244,128 @@ public:
         const uhd::tx_metadata_t &metadata,
         const double timeout
     ){
-        //translate the metadata to vrt if packet info
+        if (_zc_buffs) _zc_buffs->clear(); //the held buffers are used up here
+        const size_t nsamps_sent = this->send_packets(buffs, nsamps_per_buff, metadata, timeout);
+        if (metadata.end_of_burst or metadata.has_time_spec) this->flush_all();
+        return nsamps_sent;
+    }
+
+    /*******************************************************************
+     * Zero-copy send:
+     * Lend the payload regions of a send buffer per channel.
+     * The payload follows a header without time stamp,
+     * the header is packed in front of it at commit.
+     ******************************************************************/
+    UHD_INLINE tx_zero_copy_buffs::sptr acquire_send_buffs(const double timeout){
+        //get a buffer for each channel or timeout
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            if (not props.buff) props.buff = props.get_buff(timeout);
+            if (not props.buff) return tx_zero_copy_buffs::sptr(); //timeout
+        }
+
+        if (not _zc_buffs) _zc_buffs = boost::make_shared<send_zero_copy_buffs_impl>(this->size(), _max_samples_per_packet);
+        for (size_t i = 0; i < this->size(); i++){
+            boost::uint32_t *otw_mem = _props[i].buff->cast<boost::uint32_t *>() + _header_offset_words32;
+            _zc_buffs->lend(i, reinterpret_cast<char *>(otw_mem + this->get_num_header_words32(i, false)));
+        }
+        return _zc_buffs;
+    }
+
+    UHD_INLINE size_t commit_send_buffs(
+        const tx_zero_copy_buffs::sptr &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata
+    ){
+        if (not _zc_buffs or buffs != _zc_buffs or not _zc_buffs->is_lent()){
+            throw uhd::runtime_error("commit_send_buffs() needs the buffers of the last acquire_send_buffs()");
+        }
+        if (nsamps_per_buff > _max_samples_per_packet){
+            throw uhd::value_error(str(boost::format(
+                "commit_send_buffs() of %u samples, the buffers hold %u samples"
+            ) % nsamps_per_buff % _max_samples_per_packet));
+        }
+
+        //TODO remove this code when sample counts of zero are supported by hardware
+        #ifndef SSPH_DONT_PAD_TO_ONE
+            //like send(): a start of burst without samples is cached
+            //and applied to the next commit, the buffers stay lent for it
+            if (nsamps_per_buff == 0 and metadata.start_of_burst){
+                _metadata_cache = metadata;
+                _cached_metadata = true;
+                return 0;
+            }
+        #endif
+
+        vrt::if_packet_info_t if_packet_info;
+        this->load_if_packet_info(if_packet_info, metadata, nsamps_per_buff);
+
+        //the hardware needs one sample in the packet (see send_packets())
+        #ifndef SSPH_DONT_PAD_TO_ONE
+            const size_t nsamps = std::max<size_t>(nsamps_per_buff, 1);
+        #else
+            const size_t nsamps = nsamps_per_buff;
+        #endif
+        if_packet_info.num_payload_bytes = nsamps*_num_inputs*_bytes_per_otw_item;
+        if_packet_info.num_payload_words32 = (if_packet_info.num_payload_bytes + 3/*round up*/)/sizeof(boost::uint32_t);
+        if_packet_info.packet_count = _next_packet_seq;
+
+        for (size_t i = 0; i < this->size(); i++){
+            managed_send_buffer::sptr &buff = _props[i].buff;
+            boost::uint32_t *otw_mem = buff->cast<boost::uint32_t *>() + _header_offset_words32;
+            char *payload = static_cast<char *>(_zc_buffs->get(i));
+            if (nsamps_per_buff == 0) std::memset(payload, 0, if_packet_info.num_payload_bytes);
+
+            //a time stamp makes the header longer than the lent layout
+            char *header_end = reinterpret_cast<char *>(otw_mem + this->get_num_header_words32(i, if_packet_info.has_tsf));
+            if (header_end != payload) std::memmove(header_end, payload, if_packet_info.num_payload_bytes);
+
+            //pack metadata into a vrt header and commit
+            if_packet_info.has_sid = _props[i].has_sid;
+            if_packet_info.sid = _props[i].sid;
+            _vrt_packer(otw_mem, if_packet_info);
+            buff->commit((_header_offset_words32 + if_packet_info.num_packet_words32)*sizeof(boost::uint32_t));
+            buff.reset(); //effectively a release
+        }
+        _zc_buffs->clear();
+        _next_packet_seq++; //increment sequence after commits
+
+        if (metadata.end_of_burst or metadata.has_time_spec) this->flush_all();
+        return nsamps_per_buff;
+    }
+
+private:
+
+    //! Flush the committed buffers of all transports
+    UHD_INLINE void flush_all(void){
+        BOOST_FOREACH(xport_chan_props_type &props, _props){
+            if (props.flush) props.flush();
+        }
+    }
+
+    //! Get the length of the vrt header for a channel's packets
+    UHD_INLINE size_t get_num_header_words32(const size_t xport_chan, const bool has_tsf){
         vrt::if_packet_info_t if_packet_info;
+        if_packet_info.has_sid = _props[xport_chan].has_sid;
+        if_packet_info.has_cid = false;
+        if_packet_info.has_tlr = _has_tlr;
+        if_packet_info.has_tsi = false;
+        if_packet_info.has_tsf = has_tsf;
+        boost::uint32_t hdr_mem[vrt::max_if_hdr_words32 + 1/*tlr*/];
+        _vrt_packer(hdr_mem, if_packet_info);
+        return if_packet_info.num_header_words32;
+    }
+
+    /*******************************************************************
+     * Load if packet info:
+     * Translate the metadata to vrt if packet info.
+     * A start of burst cached by a send() without samples
+     * is applied to the first packet that has samples.
+     ******************************************************************/
+    UHD_INLINE void load_if_packet_info(
+        vrt::if_packet_info_t &if_packet_info,
+        const uhd::tx_metadata_t &metadata,
+        const size_t nsamps_per_buff
+    ){
         if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
         //if_packet_info.has_sid = false; //set per channel
         if_packet_info.has_cid = false;
@@ -210,6 +392,21 @@ public:
             if_packet_info.eob     = _metadata_cache.end_of_burst;
             _cached_metadata = false;
         }
+    }
+
+    /*******************************************************************
+     * Send packets:
+     * Dispatch into combinations of single packet send calls.
+     ******************************************************************/
+    UHD_INLINE size_t send_packets(
+        const uhd::tx_streamer::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata,
+        const double timeout
+    ){
+        //translate the metadata to vrt if packet info
+        vrt::if_packet_info_t if_packet_info;
+        this->load_if_packet_info(if_packet_info, metadata, nsamps_per_buff);
 
         if (nsamps_per_buff <= _max_samples_per_packet){
 
@@ -278,14 +475,13 @@ public:
 		return nsamps_sent;
     }
 
-private:
-
     vrt_packer_type _vrt_packer;
     size_t _header_offset_words32;
     double _tick_rate, _samp_rate;
     struct xport_chan_props_type{
         xport_chan_props_type(void):has_sid(false),sid(0){}
         get_buff_type get_buff;
+        flush_type flush;
         bool has_sid;
         boost::uint32_t sid;
         managed_send_buffer::sptr buff;
@@ -295,6 +491,7 @@ private:
     size_t _bytes_per_otw_item; //used in conversion
     size_t _bytes_per_cpu_item; //used in conversion
     uhd::convert::converter::sptr _converter; //used in conversion
+    std::vector<uhd::convert::converter::sptr> _correcting_converters; //one per channel
     size_t _max_samples_per_packet;
     std::vector<const void *> _zero_buffs;
     size_t _next_packet_seq;
@@ -302,6 +499,7 @@ private:
     async_receiver_type _async_receiver;
     bool _cached_metadata;
     uhd::tx_metadata_t _metadata_cache;
+    boost::shared_ptr<send_zero_copy_buffs_impl> _zc_buffs;
 
 #ifdef UHD_TXRX_DEBUG_PRINTS
     struct dbg_send_stat_t {
@@ -377,21 +575,24 @@ private:
         _convert_if_packet_info = &if_packet_info;
 
         //perform N channels of conversion
-        converter_thread_task(0);
+        if (_convert_pool) _convert_pool->run(&send_packet_handler::convert_job, this, this->size());
+        else this->convert_channel(0);
 
         _next_packet_seq++; //increment sequence after commits
         return nsamps_per_buff;
     }
 
     /*******************************************************************
-     * Perform one thread's work of the conversion task.
-     * The entry and exit use a dual synchronization barrier,
-     * to wait for data to become ready and block until completion.
+     * Perform the conversion of one channel:
+     * Called on the sending thread or a worker of the convert pool.
      ******************************************************************/
-    UHD_INLINE void converter_thread_task(const size_t index)
+    static void convert_job(void *handler, const size_t index)
     {
-        _task_barrier.wait();
+        static_cast<send_packet_handler *>(handler)->convert_channel(index);
+    }
 
+    UHD_INLINE void convert_channel(const size_t index)
+    {
         //shortcut references to local data structures
         managed_send_buffer::sptr &buff = _props[index].buff;
         vrt::if_packet_info_t if_packet_info = *_convert_if_packet_info;
@@ -413,19 +614,18 @@ private:
         otw_mem += if_packet_info.num_header_words32;
 
         //perform the conversion operation
-        _converter->conv(in_buffs, otw_mem, _convert_nsamps);
+        const uhd::convert::converter::sptr &converter = (_correcting_converters.empty())?
+            _converter : _correcting_converters[index];
+        converter->conv(in_buffs, otw_mem, _convert_nsamps);
 
         //commit the samples to the zero-copy interface
         const size_t num_vita_words32 = _header_offset_words32+if_packet_info.num_packet_words32;
         buff->commit(num_vita_words32*sizeof(boost::uint32_t));
         buff.reset(); //effectively a release
-
-        if (index == 0) _task_barrier.wait_others();
     }
 
-    //! Shared variables for the worker threads
-    reusable_barrier _task_barrier;
-    std::vector<task::sptr> _task_handlers;
+    //! Shared variables for the conversion jobs
+    convert_pool::sptr _convert_pool;
     size_t _convert_nsamps;
     const tx_streamer::buffs_type *_convert_buffs;
     size_t _convert_buffer_offset_bytes;
@@ -463,6 +663,19 @@ public:
         return send_packet_handler::recv_async_msg(async_metadata, timeout);
     }
 
+    tx_zero_copy_buffs::sptr acquire_send_buffs(const double timeout)
+    {
+        return send_packet_handler::acquire_send_buffs(timeout);
+    }
+
+    size_t commit_send_buffs(
+        const tx_zero_copy_buffs::sptr &buffs,
+        const size_t nsamps_per_buff,
+        const uhd::tx_metadata_t &metadata
+    ){
+        return send_packet_handler::commit_send_buffs(buffs, nsamps_per_buff, metadata);
+    }
+
 private:
     size_t _max_num_samps;
 };
@@ -16,15 +16,22 @@
 //
 
 #include "udp_common.hpp"
+#include "io_uring_zero_copy.hpp"
+#include "zero_copy_counters.hpp"
 #include <uhd/transport/tcp_zero_copy.hpp>
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/atomic.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/exception.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <algorithm>
 #include <vector>
+#include <cstring>
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -32,6 +39,7 @@ namespace asio = boost::asio;
 
 static const size_t DEFAULT_NUM_FRAMES = 32;
 static const size_t DEFAULT_FRAME_SIZE = 2048;
+static const size_t DEFAULT_RECV_RING_SIZE = 512*1024;
 
 /***********************************************************************
  * Reusable managed receiver buffer:
@@ -39,15 +47,16 @@ static const size_t DEFAULT_FRAME_SIZE = 2048;
  **********************************************************************/
 class tcp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    tcp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    tcp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _counters(counters) { /*NOP*/ }
 
     void release(void){
+        count_recv_release(_counters);
         _claimer.release();
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.recv_wait_time)) return sptr();
 
         #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
         _len = ::recv(_sock_fd, (char *)_mem, _frame_size, MSG_DONTWAIT);
@@ -57,7 +66,12 @@ public:
         }
         #endif
 
-        if (wait_for_recv_ready(_sock_fd, timeout)){
+        bool ready = false;
+        {
+            counted_wait wait(_counters.recv_wait_time);
+            ready = wait_for_recv_ready(_sock_fd, timeout);
+        }
+        if (ready){
             _len = ::recv(_sock_fd, (char *)_mem, _frame_size, 0);
             index++; //advances the caller's buffer
             return make(this, _mem, size_t(_len));
@@ -73,6 +87,199 @@ private:
     size_t _frame_size;
     ssize_t _len;
     simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+/***********************************************************************
+ * Framed receive ring:
+ *  - large reads fill a ring with the byte stream from the socket
+ *  - the stream is split in place into packets with the length field
+ *    of the packet header (CHDR in bytes, VRT in 32-bit words)
+ *  - the wrapped part of a packet that straddles the end of the ring
+ *    is copied to the spare space after the ring (a bounce copy)
+ *  - the ring space of a packet is read into again after the caller
+ *    released it and all of the packets before it
+ **********************************************************************/
+class tcp_zero_copy_ring_mrb : public managed_recv_buffer{
+public:
+    tcp_zero_copy_ring_mrb(atomic_zero_copy_counters &counters):
+        _end(0), _counters(counters) { /*NOP*/ }
+
+    void release(void){
+        count_recv_release(_counters);
+        _claimer.release();
+    }
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len, const boost::uint64_t end){
+        _claimer.claim_with_wait(0.0); //not held, the ring only hands out released buffers
+        _end = end;
+        return make(this, mem, len);
+    }
+
+    //! Wait for the caller to release the buffer
+    UHD_INLINE bool wait_for_release(const double timeout){
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.recv_wait_time)) return false;
+        _claimer.release();
+        return true;
+    }
+
+    //! The stream position after the packet
+    UHD_INLINE boost::uint64_t end(void) const{
+        return _end;
+    }
+
+private:
+    boost::uint64_t _end;
+    simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+class tcp_zero_copy_recv_ring{
+public:
+    typedef boost::shared_ptr<tcp_zero_copy_recv_ring> sptr;
+
+    tcp_zero_copy_recv_ring(
+        int sock_fd,
+        const std::string &framing,
+        const size_t ring_size,
+        const size_t num_frames,
+        const size_t frame_size,
+        const device_addr_t &hints,
+        atomic_zero_copy_counters &counters
+    ):
+        _sock_fd(sock_fd),
+        _len_in_words(framing == "vrt" or framing == "vrt_le"),
+        _little_endian(framing == "chdr_le" or framing == "vrt_le"),
+        _ring_size(std::max(ring_size, (num_frames + 1)*frame_size)), //room for a packet while the caller holds all buffers
+        _frame_size(frame_size),
+        _pool(buffer_pool::make(1, _ring_size + _frame_size, hints)), //spare space for the bounce copy
+        _ring(static_cast<char *>(_pool->at(0))),
+        _head(0), _tail(0), _parse(0),
+        _next_mrb(0), _num_held(0),
+        _counters(counters)
+    {
+        if (not _len_in_words and not _little_endian and framing != "chdr") throw uhd::value_error(
+            "tcp framing must be chdr, chdr_le, vrt, or vrt_le, got " + framing
+        );
+        for (size_t i = 0; i < num_frames; i++){
+            _mrbs.push_back(boost::make_shared<tcp_zero_copy_ring_mrb>(counters));
+        }
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(const double timeout){
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        size_t len = 0;
+        while (not this->packet_ready(len)){
+            if (not this->read(remaining(exit_time))) return managed_recv_buffer::sptr();
+        }
+
+        //the caller holds all of the buffers -> wait for the oldest one
+        if (_num_held == _mrbs.size() and not this->reclaim_oldest(remaining(exit_time))){
+            return managed_recv_buffer::sptr();
+        }
+
+        //bounce copy -> the packet continues in the spare space after the ring
+        const size_t offset = size_t(_parse % _ring_size);
+        if (offset + len > _ring_size){
+            std::memcpy(_ring + _ring_size, _ring, offset + len - _ring_size);
+        }
+        _parse += len;
+
+        tcp_zero_copy_ring_mrb &mrb = *_mrbs[_next_mrb];
+        _next_mrb = (_next_mrb + 1) % _mrbs.size();
+        _num_held++;
+        return mrb.get_new(_ring + offset, len, _parse);
+    }
+
+private:
+    static double remaining(const time_spec_t &exit_time){
+        return std::max(0.0, (exit_time - time_spec_t::get_system_time()).get_real_secs());
+    }
+
+    //! Is the next packet complete in the ring? Then get its length.
+    bool packet_ready(size_t &len){
+        const boost::uint64_t num_bytes = _head - _parse;
+        if (num_bytes < sizeof(boost::uint32_t)) return false;
+
+        //the header may straddle the end of the ring as well
+        boost::uint32_t header = 0;
+        char *header_bytes = reinterpret_cast<char *>(&header);
+        for (size_t i = 0; i < sizeof(header); i++){
+            header_bytes[i] = _ring[size_t((_parse + i) % _ring_size)];
+        }
+        header = (_little_endian)? uhd::wtohx(header) : uhd::ntohx(header);
+        len = size_t(header & 0xffff);
+        if (_len_in_words) len *= sizeof(boost::uint32_t);
+
+        if (len < sizeof(header) or len > _frame_size) throw uhd::io_error(str(boost::format(
+            "tcp framing lost: packet length %d is outside of 4 to %d bytes (recv_frame_size)"
+        ) % len % _frame_size));
+        return num_bytes >= len;
+    }
+
+    //! Read as much of the stream as fits into the free ring space
+    bool read(const double timeout){
+        this->reclaim_released();
+        if (this->free_space() == 0 and not this->reclaim_oldest(timeout)) return false;
+
+        const size_t offset = size_t(_head % _ring_size);
+        const size_t max_len = std::min(this->free_space(), _ring_size - offset);
+        ssize_t ret = -1;
+        #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
+        ret = ::recv(_sock_fd, _ring + offset, max_len, MSG_DONTWAIT);
+        #endif
+        if (ret < 0){
+            bool ready = false;
+            {
+                counted_wait wait(_counters.recv_wait_time);
+                ready = wait_for_recv_ready(_sock_fd, timeout);
+            }
+            if (not ready) return false;
+            ret = ::recv(_sock_fd, _ring + offset, max_len, 0);
+        }
+        if (ret == 0) throw uhd::io_error("tcp connection closed by the remote end");
+        if (ret < 0) return false;
+        _head += boost::uint64_t(ret);
+        return true;
+    }
+
+    UHD_INLINE size_t free_space(void) const{
+        return _ring_size - size_t(_head - _tail);
+    }
+
+    UHD_INLINE tcp_zero_copy_ring_mrb &oldest(void){
+        return *_mrbs[(_next_mrb + _mrbs.size() - _num_held) % _mrbs.size()];
+    }
+
+    //! Free the ring space of the released packets, in order
+    void reclaim_released(void){
+        while (_num_held != 0 and this->oldest().wait_for_release(0.0)){
+            _tail = this->oldest().end();
+            _num_held--;
+        }
+    }
+
+    //! Wait for the caller to release the oldest packet and free its ring space
+    bool reclaim_oldest(const double timeout){
+        if (_num_held == 0 or not this->oldest().wait_for_release(timeout)) return false;
+        _tail = this->oldest().end();
+        _num_held--;
+        return true;
+    }
+
+    const int _sock_fd;
+    const bool _len_in_words, _little_endian;
+    const size_t _ring_size, _frame_size;
+    buffer_pool::sptr _pool;
+    char *_ring;
+
+    //stream positions: read into the ring, freed by the caller, handed out to the caller
+    boost::uint64_t _head, _tail, _parse;
+
+    //the buffers are handed out and freed in order
+    std::vector<boost::shared_ptr<tcp_zero_copy_ring_mrb> > _mrbs;
+    size_t _next_mrb, _num_held;
+    atomic_zero_copy_counters &_counters;
 };
 
 /***********************************************************************
@@ -81,20 +288,23 @@ private:
  **********************************************************************/
 class tcp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    tcp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    tcp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size, const bool framed, atomic_zero_copy_counters &counters):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _framed(framed), _counters(counters) { /*NOP*/ }
 
     void release(void){
+        count_send_commit(_counters, size());
         //Retry logic because send may fail with ENOBUFS.
         //This is known to occur at least on some OSX systems.
         //But it should be safe to always check for the error.
         while (true)
         {
-            this->commit(_frame_size); //always full size frames to avoid pkt coalescing
+            //always full size frames to avoid pkt coalescing, unless the receiver splits the stream
+            if (not _framed) this->commit(_frame_size);
             const ssize_t ret = ::send(_sock_fd, (const char *)_mem, size(), 0);
             if (ret == ssize_t(size())) break;
             if (ret == -1 and errno == ENOBUFS)
             {
+                _counters.send_retries++;
                 boost::this_thread::sleep(boost::posix_time::microseconds(1));
                 continue; //try to send again
             }
@@ -104,7 +314,7 @@ public:
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.send_wait_time)) return sptr();
         index++; //advances the caller's buffer
         return make(this, _mem, _frame_size);
     }
@@ -113,7 +323,9 @@ private:
     void *_mem;
     int _sock_fd;
     size_t _frame_size;
+    bool _framed;
     simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
 };
 
 tcp_zero_copy::~tcp_zero_copy(void){
@@ -140,8 +352,8 @@ public:
         _num_recv_frames(size_t(hints.cast<double>("num_recv_frames", DEFAULT_NUM_FRAMES))),
         _send_frame_size(size_t(hints.cast<double>("send_frame_size", DEFAULT_FRAME_SIZE))),
         _num_send_frames(size_t(hints.cast<double>("num_send_frames", DEFAULT_NUM_FRAMES))),
-        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size)),
+        _recv_buffer_pool(buffer_pool::make(_num_recv_frames, _recv_frame_size, hints)),
+        _send_buffer_pool(buffer_pool::make(_num_send_frames, _send_frame_size, hints)),
         _next_recv_buff_index(0), _next_send_buff_index(0)
     {
         UHD_LOG << boost::format("Creating tcp transport for %s %s") % addr % port << std::endl;
@@ -163,16 +375,40 @@ public:
         //allocate re-usable managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::make_shared<tcp_zero_copy_asio_mrb>(
-                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size()
+                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size(), _counters
             ));
         }
 
+        //framing -> packets are split out of a ring filled with large reads
+        const std::string framing = hints.get("framing", "");
+        if (not framing.empty()) _recv_ring.reset(new tcp_zero_copy_recv_ring(
+            _sock_fd, framing, size_t(hints.cast<double>("recv_ring_size", DEFAULT_RECV_RING_SIZE)),
+            get_num_recv_frames(), get_recv_frame_size(), hints, _counters
+        ));
+
         //allocate re-usable managed send buffers
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(boost::make_shared<tcp_zero_copy_asio_msb>(
-                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size()
+                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size(), not framing.empty(), _counters
             ));
         }
+
+        //io_uring -> fixed buffer reads and writes instead of recv and send calls
+        if (hints.cast<int>("recv_io_uring", 0) != 0 and _recv_ring){
+            UHD_MSG(warning) << "recv_io_uring is not used with framing." << std::endl;
+        }
+        else if (hints.cast<int>("recv_io_uring", 0) != 0) try{
+            _recv_uring = io_uring_recv_xport::make(_sock_fd, _recv_buffer_pool, get_recv_frame_size(), _counters);
+        }
+        catch(const uhd::exception &e){
+            UHD_MSG(warning) << "Receiving without io_uring: " << e.what() << std::endl;
+        }
+        if (hints.cast<int>("send_io_uring", 0) != 0) try{
+            _send_uring = io_uring_send_xport::make(_sock_fd, _send_buffer_pool, get_send_frame_size(), true, _counters);
+        }
+        catch(const uhd::exception &e){
+            UHD_MSG(warning) << "Sending without io_uring: " << e.what() << std::endl;
+        }
     }
 
     /*******************************************************************
@@ -180,8 +416,15 @@ public:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
-        if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        managed_recv_buffer::sptr buff;
+        if (_recv_uring) buff = _recv_uring->get_recv_buff(timeout);
+        else if (_recv_ring) buff = _recv_ring->get_recv_buff(timeout);
+        else{
+            if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
+            buff = _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        }
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
@@ -192,14 +435,27 @@ public:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
-        if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff;
+        if (_send_uring) buff = _send_uring->get_send_buff(timeout);
+        else{
+            if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
+            buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        }
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    zero_copy_counters get_counters(void) const{
+        return _counters.snapshot();
+    }
+
 private:
+    //counters -> declared first, the buffers and rings below refer to them
+    atomic_zero_copy_counters _counters;
+
     //memory management -> buffers and fifos
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
@@ -212,6 +468,13 @@ private:
     asio::io_service        _io_service;
     boost::shared_ptr<asio::ip::tcp::socket> _socket;
     int                     _sock_fd;
+
+    //framed receive -> the ring of the byte stream
+    tcp_zero_copy_recv_ring::sptr _recv_ring;
+
+    //io_uring -> declared after the socket so the rings go away first
+    io_uring_recv_xport::sptr _recv_uring;
+    io_uring_send_xport::sptr _send_uring;
 };
 
 /***********************************************************************
@@ -19,7 +19,10 @@
 #define INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP
 
 #include <uhd/config.hpp>
+#include <uhd/types/time_spec.hpp>
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <cerrno>
 
 namespace uhd{ namespace transport{
 
@@ -55,6 +58,30 @@ namespace uhd{ namespace transport{
         return TEMP_FAILURE_RETRY(::select(sock_fd+1, &rset, NULL, NULL, &tv)) > 0;
     }
 
+    /*!
+     * Wait for the socket to become ready for a receive operation:
+     * Poll the socket without blocking for up to spin_time first,
+     * which avoids the wake up latency of select when data is close.
+     * \param sock_fd the open socket file descriptor
+     * \param timeout the timeout duration in seconds
+     * \param spin_time the polling duration in seconds
+     * \return true when the socket is ready for receive
+     */
+    UHD_INLINE bool wait_for_recv_ready(int sock_fd, double timeout, const double spin_time){
+        #ifdef MSG_DONTWAIT //poll with non-blocking recv() if supported
+        if (spin_time > 0.0){
+            const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(std::min(spin_time, timeout));
+            do{
+                char byte;
+                if (::recv(sock_fd, &byte, sizeof(byte), MSG_PEEK | MSG_DONTWAIT) >= 0) return true;
+                if (errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR) return true; //recv reports the error
+            } while (time_spec_t::get_system_time() < exit_time);
+            timeout = std::max(0.0, timeout - spin_time);
+        }
+        #endif
+        return wait_for_recv_ready(sock_fd, timeout);
+    }
+
 }} //namespace uhd::transport
 
 #endif /* INCLUDED_LIBUHD_TRANSPORT_VRT_PACKET_HANDLER_HPP */
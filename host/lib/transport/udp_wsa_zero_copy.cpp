@@ -16,6 +16,7 @@
 //
 
 #include "udp_common.hpp"
+#include "zero_copy_counters.hpp"
 #include <uhd/transport/udp_zero_copy.hpp>
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include <uhd/transport/buffer_pool.hpp>
@@ -79,14 +80,14 @@ struct uhd_wsa_control{
  **********************************************************************/
 class udp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size):
-        _sock_fd(sock_fd), _frame_size(frame_size)
+    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _sock_fd(sock_fd), _frame_size(frame_size), _counters(counters)
     {
         _wsa_buff.buf = reinterpret_cast<char *>(mem);
         ZeroMemory(&_overlapped, sizeof(_overlapped));
         _overlapped.hEvent = WSACreateEvent();
         UHD_ASSERT_THROW(_overlapped.hEvent != WSA_INVALID_EVENT);
-        this->release(); //makes buffer available via get_new
+        this->post_recv(); //makes buffer available via get_new
     }
 
     ~udp_zero_copy_asio_mrb(void){
@@ -94,15 +95,18 @@ public:
     }
 
     void release(void){
-        _wsa_buff.len = _frame_size;
-        _flags = 0;
-        WSARecv(_sock_fd, &_wsa_buff, 1, &_wsa_buff.len, &_flags, &_overlapped, NULL);
+        count_recv_release(_counters);
+        this->post_recv();
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        const DWORD result = WSAWaitForMultipleEvents(
-            1, &_overlapped.hEvent, true, DWORD(timeout*1000), true
-        );
+        DWORD result;
+        {
+            counted_wait wait(_counters.recv_wait_time);
+            result = WSAWaitForMultipleEvents(
+                1, &_overlapped.hEvent, true, DWORD(timeout*1000), true
+            );
+        }
         if (result == WSA_WAIT_TIMEOUT) return managed_recv_buffer::sptr();
         index++; //advances the caller's buffer
 
@@ -113,11 +117,18 @@ public:
     }
 
 private:
+    void post_recv(void){
+        _wsa_buff.len = _frame_size;
+        _flags = 0;
+        WSARecv(_sock_fd, &_wsa_buff, 1, &_wsa_buff.len, &_flags, &_overlapped, NULL);
+    }
+
     int _sock_fd;
     const size_t _frame_size;
     WSAOVERLAPPED _overlapped;
     WSABUF _wsa_buff;
     DWORD _flags;
+    atomic_zero_copy_counters &_counters;
 };
 
 /***********************************************************************
@@ -127,8 +138,8 @@ private:
  **********************************************************************/
 class udp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size):
-        _sock_fd(sock_fd), _frame_size(frame_size)
+    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size, atomic_zero_copy_counters &counters):
+        _sock_fd(sock_fd), _frame_size(frame_size), _counters(counters)
     {
         _wsa_buff.buf = reinterpret_cast<char *>(mem);
         ZeroMemory(&_overlapped, sizeof(_overlapped));
@@ -142,14 +153,19 @@ public:
     }
 
     void release(void){
+        count_send_commit(_counters, size());
         _wsa_buff.len = size();
         WSASend(_sock_fd, &_wsa_buff, 1, NULL, 0, &_overlapped, NULL);
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        const DWORD result = WSAWaitForMultipleEvents(
-            1, &_overlapped.hEvent, true, DWORD(timeout*1000), true
-        );
+        DWORD result;
+        {
+            counted_wait wait(_counters.send_wait_time);
+            result = WSAWaitForMultipleEvents(
+                1, &_overlapped.hEvent, true, DWORD(timeout*1000), true
+            );
+        }
         if (result == WSA_WAIT_TIMEOUT) return managed_send_buffer::sptr();
         index++; //advances the caller's buffer
 
@@ -163,6 +179,7 @@ private:
     const size_t _frame_size;
     WSAOVERLAPPED _overlapped;
     WSABUF _wsa_buff;
+    atomic_zero_copy_counters &_counters;
 };
 
 /***********************************************************************
@@ -189,8 +206,8 @@ public:
         _num_recv_frames(xport_params.num_recv_frames),
         _send_frame_size(xport_params.send_frame_size),
         _num_send_frames(xport_params.num_send_frames),
-        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size)),
+        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size, hints)),
+        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size, hints)),
         _next_recv_buff_index(0), _next_send_buff_index(0)
     {
         #ifdef CHECK_REG_SEND_THRESH
@@ -236,14 +253,14 @@ public:
         //allocate re-usable managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::shared_ptr<udp_zero_copy_asio_mrb>(
-                new udp_zero_copy_asio_mrb(_recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size())
+                new udp_zero_copy_asio_mrb(_recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size(), _counters)
             ));
         }
 
         //allocate re-usable managed send buffers
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(boost::shared_ptr<udp_zero_copy_asio_msb>(
-                new udp_zero_copy_asio_msb(_send_buffer_pool->at(i), _sock_fd, get_send_frame_size())
+                new udp_zero_copy_asio_msb(_send_buffer_pool->at(i), _sock_fd, get_send_frame_size(), _counters)
             ));
         }
     }
@@ -258,7 +275,9 @@ public:
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
         if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
-        return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        managed_recv_buffer::sptr buff = _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
@@ -270,12 +289,18 @@ public:
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
         if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    zero_copy_counters get_counters(void) const{
+        return _counters.snapshot();
+    }
+
     //! Read back the socket's buffer space reserved for receives
     size_t get_recv_buff_size(void) {
         int recv_buff_size = 0;
@@ -307,6 +332,9 @@ public:
     }
 
 private:
+    //counters -> declared first, the buffers below refer to them
+    atomic_zero_copy_counters _counters;
+
     //memory management -> buffers and fifos
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
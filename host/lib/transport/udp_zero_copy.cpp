@@ -16,16 +16,57 @@
 //
 
 #include "udp_common.hpp"
+#include "io_uring_zero_copy.hpp"
+#include "zero_copy_counters.hpp"
 #include <uhd/transport/udp_zero_copy.hpp>
 #include <uhd/transport/udp_simple.hpp> //mtu
 #include <uhd/transport/buffer_pool.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/atomic.hpp>
+#include <uhd/utils/tasks.hpp>
+#include <uhd/utils/safe_call.hpp>
 #include <boost/format.hpp>
 #include <boost/make_shared.hpp>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 #include <boost/thread/thread.hpp> //sleep
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <algorithm>
 #include <vector>
+#include <cstring>
+#if defined(HAVE_RECVMMSG) || defined(HAVE_SENDMMSG) || defined(HAVE_SO_TIMESTAMPING)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#ifdef HAVE_UDP_GSO
+#include <netinet/udp.h> //UDP_SEGMENT, UDP_GRO
+
+//limits of one segmented datagram: the kernel's segment count and the ip length
+static const size_t GSO_MAX_SEGMENTS = 64;
+static const size_t GSO_MAX_BYTES = 65000;
+
+//! The largest datagram the kernel can coalesce on receive
+static const size_t GRO_BUFF_SIZE = 65536;
+
+//! The number of datagram buffers, each one holds many frames
+static const size_t GRO_NUM_BUFFS = 16;
+#endif
+
+#ifdef HAVE_SO_TIMESTAMPING
+#include <linux/net_tstamp.h> //SOF_TIMESTAMPING_*
+#include <time.h> //timespec
+
+//! Control message space for a receive timestamp, SO_TIMESTAMPING gives three times
+#define TIMESTAMP_CONTROL_SPACE CMSG_SPACE(3*sizeof(timespec))
+
+union udp_timestamp_control{
+    cmsghdr hdr;
+    char buff[TIMESTAMP_CONTROL_SPACE];
+};
+#endif
 
 using namespace uhd;
 using namespace uhd::transport;
@@ -61,32 +102,67 @@ static void check_registry_for_fast_send_threshold(const size_t mtu){
 }
 #endif /*HAVE_ATLBASE_H*/
 
+#ifdef HAVE_SO_TIMESTAMPING
+/*!
+ * Find the kernel receive timestamp in the control messages of a received message.
+ * SO_TIMESTAMPING gives the software time first and the raw hardware time last,
+ * the hardware time is used when the network device provides it.
+ * \return true when the message has a timestamp
+ */
+static bool parse_recv_timestamp(msghdr &msg, time_spec_t &time){
+    for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)){
+        if (cm->cmsg_level != SOL_SOCKET) continue;
+        timespec ts[3];
+        if (cm->cmsg_type == SCM_TIMESTAMPNS){
+            std::memcpy(&ts[0], CMSG_DATA(cm), sizeof(ts[0]));
+        }
+        else if (cm->cmsg_type == SCM_TIMESTAMPING){
+            std::memcpy(ts, CMSG_DATA(cm), sizeof(ts));
+            if (ts[2].tv_sec != 0 or ts[2].tv_nsec != 0) ts[0] = ts[2];
+        }
+        else continue;
+        time = time_spec_t(ts[0].tv_sec, ts[0].tv_nsec, 1e9);
+        return true;
+    }
+    return false;
+}
+#endif /*HAVE_SO_TIMESTAMPING*/
+
+//! Wait for the socket to become readable, the time blocked is counted
+static UHD_INLINE bool counted_wait_for_recv_ready(
+    int sock_fd, const double timeout, const double spin_time, atomic_zero_copy_counters &counters
+){
+    counted_wait wait(counters.recv_wait_time);
+    return wait_for_recv_ready(sock_fd, timeout, spin_time);
+}
+
 /***********************************************************************
  * Reusable managed receiver buffer:
  *  - get_new performs the recv operation
  **********************************************************************/
 class udp_zero_copy_asio_mrb : public managed_recv_buffer{
 public:
-    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _len(0) { /*NOP*/ }
+    udp_zero_copy_asio_mrb(void *mem, int sock_fd, const size_t frame_size, const double spin_time, const bool timestamps, atomic_zero_copy_counters &counters):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _spin_time(spin_time), _timestamps(timestamps), _len(0), _counters(counters) { /*NOP*/ }
 
     void release(void){
+        count_recv_release(_counters);
         _claimer.release();
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.recv_wait_time)) return sptr();
 
         #ifdef MSG_DONTWAIT //try a non-blocking recv() if supported
-        _len = ::recv(_sock_fd, (char *)_mem, _frame_size, MSG_DONTWAIT);
+        _len = this->recv(MSG_DONTWAIT);
         if (_len > 0){
             index++; //advances the caller's buffer
             return make(this, _mem, size_t(_len));
         }
         #endif
 
-        if (wait_for_recv_ready(_sock_fd, timeout)){
-            _len = ::recv(_sock_fd, (char *)_mem, _frame_size, 0);
+        if (counted_wait_for_recv_ready(_sock_fd, timeout, _spin_time, _counters)){
+            _len = this->recv(0);
             UHD_ASSERT_THROW(_len > 0); // TODO: Handle case of recv error
             index++; //advances the caller's buffer
             return make(this, _mem, size_t(_len));
@@ -96,52 +172,597 @@ public:
         return sptr(); //null for timeout
     }
 
+    /*!
+     * Receive a frame into the memory of the buffer,
+     * with the arrival time when receive timestamps are enabled.
+     */
+    UHD_INLINE ssize_t recv(const int flags){
+        #ifdef HAVE_SO_TIMESTAMPING
+        if (_timestamps){
+            iovec iov;
+            iov.iov_base = _mem;
+            iov.iov_len = _frame_size;
+            udp_timestamp_control control;
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control.buff;
+            msg.msg_controllen = sizeof(control.buff);
+
+            const ssize_t len = ::recvmsg(_sock_fd, &msg, flags);
+            time_spec_t time;
+            if (len > 0 and parse_recv_timestamp(msg, time)) this->set_recv_time(time);
+            else this->clear_recv_time(); //the frame is reused
+            return len;
+        }
+        #endif
+        return ::recv(_sock_fd, (char *)_mem, _frame_size, flags);
+    }
+
+    /*!
+     * Batched receive support:
+     * The transport claims the buffer, receives into its memory,
+     * and hands it out with the length of the received frame.
+     */
+    UHD_INLINE bool claim(const double timeout){
+        return this->claim(timeout, _counters.recv_wait_time);
+    }
+
+    UHD_INLINE bool claim(const double timeout, atomic_counter &wait_time){
+        return claim_with_counted_wait(_claimer, timeout, wait_time);
+    }
+
+    UHD_INLINE void unclaim(void){
+        _claimer.release();
+    }
+
+    UHD_INLINE void *mem(void) const{
+        return _mem;
+    }
+
+    UHD_INLINE sptr get_received(const size_t len){
+        return make(this, _mem, len);
+    }
+
 private:
     void *_mem;
     int _sock_fd;
     size_t _frame_size;
+    double _spin_time;
+    bool _timestamps;
     ssize_t _len;
     simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+#ifdef HAVE_UDP_GSO
+/***********************************************************************
+ * Receive offload buffer:
+ *  - one receive fills the buffer with a datagram that the kernel
+ *    may have coalesced from several frames of the same size (UDP_GRO)
+ *  - the frames are handed out one at a time as managed buffers,
+ *    the buffer is free again when all of them were released
+ **********************************************************************/
+class udp_zero_copy_gro_buff;
+
+class udp_zero_copy_gro_mrb : public managed_recv_buffer{
+public:
+    udp_zero_copy_gro_mrb(udp_zero_copy_gro_buff *buff): _buff(buff) { /*NOP*/ }
+
+    void release(void);
+
+    UHD_INLINE sptr get_new(void *mem, const size_t len){
+        return make(this, mem, len);
+    }
+
+private:
+    udp_zero_copy_gro_buff *_buff;
+};
+
+class udp_zero_copy_gro_buff{
+public:
+    udp_zero_copy_gro_buff(void *mem, int sock_fd, const double spin_time, atomic_zero_copy_counters &counters):
+        _mem(mem), _sock_fd(sock_fd), _spin_time(spin_time), _len(0), _seg_size(0), _num_segs(0), _next_seg(0),
+        _has_recv_time(false), _counters(counters) { /*NOP*/ }
+
+    //! True when all frames of the last datagram were handed out
+    UHD_INLINE bool empty(void) const{
+        return _next_seg == _num_segs;
+    }
+
+    UHD_INLINE bool recv(const double timeout){
+        //the claim and the wait for the socket share the timeout
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.recv_wait_time)) return false;
+
+        ssize_t len = this->recv_gro(MSG_DONTWAIT);
+        if (len <= 0){
+            const double remaining = std::max(0.0, (exit_time - time_spec_t::get_system_time()).get_real_secs());
+            if (counted_wait_for_recv_ready(_sock_fd, remaining, _spin_time, _counters)){
+                len = this->recv_gro(MSG_DONTWAIT);
+            }
+        }
+
+        //an error, like a refused connection, is returned like a timeout
+        if (len < 0 and errno != EAGAIN and errno != EWOULDBLOCK){
+            UHD_LOG << "udp_zero_copy recvmsg failed: " << std::strerror(errno) << std::endl;
+        }
+        if (len <= 0){
+            _claimer.release(); //undo claim
+            return false;
+        }
+
+        _num_segs = (_len + _seg_size - 1)/_seg_size;
+        _next_seg = 0;
+        _num_released.write(0);
+        while (_mrbs.size() < _num_segs){
+            _mrbs.push_back(boost::make_shared<udp_zero_copy_gro_mrb>(this));
+        }
+        return true;
+    }
+
+    UHD_INLINE managed_recv_buffer::sptr get_next(void){
+        const size_t offset = _next_seg*_seg_size;
+        const size_t len = std::min(_seg_size, _len - offset);
+        managed_recv_buffer::sptr buff = _mrbs[_next_seg++]->get_new(static_cast<char *>(_mem) + offset, len);
+        if (_has_recv_time) buff->set_recv_time(_recv_time); //the frames arrived together
+        else buff->clear_recv_time();
+        return buff;
+    }
+
+    //! Called by the frames, the last one frees the buffer
+    UHD_INLINE void release_segment(void){
+        count_recv_release(_counters);
+        if (_num_released.inc() + 1 == _num_segs) _claimer.release();
+    }
+
+private:
+    ssize_t recv_gro(const int flags){
+        iovec iov;
+        iov.iov_base = _mem;
+        iov.iov_len = GRO_BUFF_SIZE;
+        union{
+            cmsghdr hdr;
+            #ifdef HAVE_SO_TIMESTAMPING
+            char buff[CMSG_SPACE(sizeof(int)) + TIMESTAMP_CONTROL_SPACE];
+            #else
+            char buff[CMSG_SPACE(sizeof(int))];
+            #endif
+        } control;
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buff;
+        msg.msg_controllen = sizeof(control.buff);
+
+        const ssize_t len = ::recvmsg(_sock_fd, &msg, flags);
+        if (len <= 0) return len;
+
+        //the segment size is only given for coalesced datagrams
+        _len = size_t(len);
+        _seg_size = _len;
+        for (cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)){
+            if (cm->cmsg_level != SOL_UDP or cm->cmsg_type != UDP_GRO) continue;
+            int gso_size = 0;
+            std::memcpy(&gso_size, CMSG_DATA(cm), sizeof(gso_size));
+            if (gso_size > 0) _seg_size = size_t(gso_size);
+        }
+        #ifdef HAVE_SO_TIMESTAMPING
+        _has_recv_time = parse_recv_timestamp(msg, _recv_time);
+        #endif
+        return len;
+    }
+
+    void *_mem;
+    int _sock_fd;
+    double _spin_time;
+    size_t _len, _seg_size, _num_segs, _next_seg;
+    std::vector<boost::shared_ptr<udp_zero_copy_gro_mrb> > _mrbs;
+    bool _has_recv_time;
+    time_spec_t _recv_time;
+    atomic_uint32_t _num_released;
+    simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+void udp_zero_copy_gro_mrb::release(void){
+    _buff->release_segment();
+}
+#endif /*HAVE_UDP_GSO*/
+
+/***********************************************************************
+ * Receive thread:
+ *  - the thread receives into the frames in order, ahead of the caller,
+ *    and waits for the caller when it has filled all of the frames
+ *  - a frame is published with a lock-free counter, the caller only
+ *    blocks on the condition variable when no frame is ready
+ **********************************************************************/
+class udp_zero_copy_recv_thread{
+public:
+    typedef boost::shared_ptr<udp_zero_copy_recv_thread> sptr;
+
+    udp_zero_copy_recv_thread(
+        int sock_fd,
+        const std::vector<boost::shared_ptr<udp_zero_copy_asio_mrb> > &mrb_pool,
+        const double spin_time,
+        atomic_zero_copy_counters &counters
+    ):
+        _sock_fd(sock_fd), _mrb_pool(mrb_pool), _spin_time(spin_time),
+        _recv_lens(mrb_pool.size(), 0), _thread_index(0), _error_backoff(0.0),
+        _next_index(0), _num_taken(0), _counters(counters)
+    {
+        _task = task::make(boost::bind(&udp_zero_copy_recv_thread::recv_frame, this));
+    }
+
+    ~udp_zero_copy_recv_thread(void){
+        _task.reset(); //the thread stops within a wait period
+        UHD_LOG << boost::format("udp_zero_copy receive thread waited %f seconds for free frames") % (_full_wait_time.read()/1e9) << std::endl;
+    }
+
+    managed_recv_buffer::sptr get_recv_buff(const double timeout){
+        if (not this->wait_for_frame(timeout)) return managed_recv_buffer::sptr();
+        const size_t index = _next_index;
+        _next_index = (_next_index + 1) % _mrb_pool.size();
+        _num_taken++;
+        return _mrb_pool[index]->get_received(_recv_lens[index]);
+    }
+
+private:
+    //! The thread waits in short periods so it can be stopped
+    static double wait_period(void){
+        return 0.1;
+    }
+
+    UHD_INLINE bool frame_ready(void){
+        return _num_received.read() != _num_taken;
+    }
+
+    bool wait_for_frame(const double timeout){
+        if (this->frame_ready()) return true;
+
+        //the increment of the waiting count orders it before the check,
+        //the receive thread increments the count and then checks the waiting
+        counted_wait wait(_counters.recv_wait_time);
+        boost::mutex::scoped_lock lock(_mutex);
+        _num_waiting.inc();
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+        while (not this->frame_ready()){
+            if (not _cond.timed_wait(lock, exit_time)) break;
+        }
+        _num_waiting.dec();
+        return this->frame_ready();
+    }
+
+    //! The task function, receives one frame
+    void recv_frame(void){
+        //the wait for a frame the caller still holds is not the caller's wait
+        const boost::shared_ptr<udp_zero_copy_asio_mrb> &mrb = _mrb_pool[_thread_index];
+        if (not mrb->claim(wait_period(), _full_wait_time)) return; //the caller has all frames
+
+        ssize_t len = 0;
+        while (len <= 0){
+            len = mrb->recv(MSG_DONTWAIT);
+            if (len > 0) break;
+            if (boost::this_thread::interruption_requested()){
+                mrb->unclaim();
+                return;
+            }
+            if (len < 0 and errno != EAGAIN and errno != EWOULDBLOCK and errno != EINTR){
+                this->back_off_on_error();
+            }
+            else wait_for_recv_ready(_sock_fd, wait_period(), _spin_time);
+        }
+        _error_backoff = 0.0;
+
+        _recv_lens[_thread_index] = size_t(len);
+        _thread_index = (_thread_index + 1) % _mrb_pool.size();
+        _num_received.inc();
+        if (_num_waiting.read() != 0){
+            boost::mutex::scoped_lock lock(_mutex);
+            _cond.notify_one();
+        }
+    }
+
+    /*!
+     * A receive error returns from the wait for the socket at once:
+     * retry at once after the first error, and then after a pause
+     * that doubles up to a wait period, so that the thread does not spin.
+     */
+    void back_off_on_error(void){
+        if (_error_backoff == 0.0){
+            UHD_LOG << "udp_zero_copy receive thread recv failed: " << std::strerror(errno) << std::endl;
+            _error_backoff = 100e-6;
+            return;
+        }
+        boost::this_thread::sleep(boost::posix_time::microseconds(long(_error_backoff*1e6)));
+        _error_backoff = std::min(2*_error_backoff, wait_period());
+    }
+
+    const int _sock_fd;
+    const std::vector<boost::shared_ptr<udp_zero_copy_asio_mrb> > _mrb_pool;
+    const double _spin_time;
+    std::vector<size_t> _recv_lens;
+
+    //written by the receive thread
+    size_t _thread_index;
+    atomic_uint32_t _num_received;
+    atomic_counter _full_wait_time; //waiting for the caller to release a frame
+    double _error_backoff;
+
+    //written by the caller
+    size_t _next_index;
+    boost::uint32_t _num_taken;
+    atomic_zero_copy_counters &_counters;
+    atomic_uint32_t _num_waiting;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+
+    task::sptr _task; //declared last so the thread stops first
+};
+
+/***********************************************************************
+ * Send a frame, with retry logic because send may fail with ENOBUFS.
+ * This is known to occur at least on some OSX systems.
+ * But it should be safe to always check for the error.
+ **********************************************************************/
+static void send_with_retry(int sock_fd, const void *mem, const size_t len, atomic_zero_copy_counters &counters){
+    while (true)
+    {
+        const ssize_t ret = ::send(sock_fd, (const char *)mem, len, 0);
+        if (ret == ssize_t(len)) break;
+        if (ret == -1 and errno == ENOBUFS)
+        {
+            counters.send_retries++;
+            boost::this_thread::sleep(boost::posix_time::microseconds(1));
+            continue; //try to send again
+        }
+        UHD_ASSERT_THROW(ret == ssize_t(len));
+    }
+}
+
+class udp_zero_copy_asio_msb;
+
+/***********************************************************************
+ * Batched send:
+ *  - committed send buffers are queued
+ *  - the queue is sent with one sendmmsg() call when it is full,
+ *    when flush() is called, or from a task when the frames at the
+ *    front of the queue have waited for longer than the timeout
+ *  - with segmentation offload (UDP_SEGMENT), a run of frames of the
+ *    same size is handed to the kernel as one message and the kernel
+ *    splits it into one datagram per frame
+ **********************************************************************/
+class udp_zero_copy_send_batch{
+public:
+    typedef boost::shared_ptr<udp_zero_copy_send_batch> sptr;
+
+    udp_zero_copy_send_batch(int sock_fd, const size_t batch_size, const double timeout, const bool gso, atomic_zero_copy_counters &counters):
+        _sock_fd(sock_fd), _batch_size(batch_size), _timeout(timeout), _gso(gso),
+        _num_flushes(0), _counters(counters)
+    {
+        _queue.reserve(_batch_size);
+        #ifdef HAVE_SENDMMSG
+        _send_iovs.resize(_batch_size);
+        _send_msgs.resize(_batch_size);
+        _send_msg_frames.resize(_batch_size);
+        #endif
+        #ifdef HAVE_UDP_GSO
+        _send_controls.resize(_batch_size);
+        #endif
+        _flush_task = task::make(boost::bind(&udp_zero_copy_send_batch::flush_on_timeout, this));
+    }
+
+    ~udp_zero_copy_send_batch(void){
+        _flush_task.reset(); //stop the task before the queue goes away
+        UHD_SAFE_CALL(this->flush();)
+    }
+
+    void push(udp_zero_copy_asio_msb *msb);
+
+    void flush(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        this->flush_queue();
+    }
+
+private:
+    void flush_queue(void);
+    size_t setup_msgs(const size_t first);
+
+    void flush_on_timeout(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        //sleep until the first frame of a batch is queued
+        while (_queue.empty()) _pending_cond.wait(lock);
+
+        //flush the batch when it is not sent within the timeout
+        const size_t num_flushes = _num_flushes;
+        const boost::system_time exit_time = boost::get_system_time() + boost::posix_time::microseconds(long(_timeout*1e6));
+        while (_num_flushes == num_flushes){
+            if (not _pending_cond.timed_wait(lock, exit_time)) this->flush_queue();
+        }
+    }
+
+    const int _sock_fd;
+    const size_t _batch_size;
+    const double _timeout;
+    bool _gso;
+    boost::mutex _mutex;
+    boost::condition_variable _pending_cond;
+    std::vector<udp_zero_copy_asio_msb *> _queue;
+    size_t _num_flushes;
+    atomic_zero_copy_counters &_counters;
+    #ifdef HAVE_SENDMMSG
+    std::vector<iovec> _send_iovs;
+    std::vector<mmsghdr> _send_msgs;
+    std::vector<size_t> _send_msg_frames; //number of frames per message
+    #endif
+    #ifdef HAVE_UDP_GSO
+    union gso_control_type{
+        cmsghdr hdr;
+        char buff[CMSG_SPACE(sizeof(boost::uint16_t))];
+    };
+    std::vector<gso_control_type> _send_controls;
+    #endif
+    task::sptr _flush_task;
 };
 
 /***********************************************************************
  * Reusable managed send buffer:
- *  - commit performs the send operation
+ *  - commit performs the send operation,
+ *    or queues the frame when sending in batches
  **********************************************************************/
 class udp_zero_copy_asio_msb : public managed_send_buffer{
 public:
-    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size):
-        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size) { /*NOP*/ }
+    udp_zero_copy_asio_msb(void *mem, int sock_fd, const size_t frame_size, udp_zero_copy_send_batch *batch, atomic_zero_copy_counters &counters):
+        _mem(mem), _sock_fd(sock_fd), _frame_size(frame_size), _batch(batch), _counters(counters) { /*NOP*/ }
 
     void release(void){
-        //Retry logic because send may fail with ENOBUFS.
-        //This is known to occur at least on some OSX systems.
-        //But it should be safe to always check for the error.
-        while (true)
-        {
-            const ssize_t ret = ::send(_sock_fd, (const char *)_mem, size(), 0);
-            if (ret == ssize_t(size())) break;
-            if (ret == -1 and errno == ENOBUFS)
-            {
-                boost::this_thread::sleep(boost::posix_time::microseconds(1));
-                continue; //try to send again
-            }
-            UHD_ASSERT_THROW(ret == ssize_t(size()));
+        count_send_commit(_counters, size());
+        if (_batch != NULL){
+            _batch->push(this); //released when the batch is sent
+            return;
         }
+        send_with_retry(_sock_fd, _mem, size(), _counters);
         _claimer.release();
     }
 
     UHD_INLINE sptr get_new(const double timeout, size_t &index){
-        if (not _claimer.claim_with_wait(timeout)) return sptr();
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.send_wait_time)) return sptr();
         index++; //advances the caller's buffer
         return make(this, _mem, _frame_size);
     }
 
+    //! Called by the batch after the frame was sent
+    UHD_INLINE void sent(void){
+        _claimer.release();
+    }
+
+    UHD_INLINE const void *mem(void) const{
+        return _mem;
+    }
+
 private:
     void *_mem;
     int _sock_fd;
     size_t _frame_size;
+    udp_zero_copy_send_batch *_batch;
     simple_claimer _claimer;
+    atomic_zero_copy_counters &_counters;
+};
+
+void udp_zero_copy_send_batch::push(udp_zero_copy_asio_msb *msb){
+    boost::mutex::scoped_lock lock(_mutex);
+    _queue.push_back(msb);
+    if (_queue.size() >= _batch_size) this->flush_queue();
+    else if (_queue.size() == 1) _pending_cond.notify_one(); //starts the flush timeout
+}
+
+void udp_zero_copy_send_batch::flush_queue(void){
+    if (_queue.empty()) return;
+    _num_flushes++;
+
+    #ifdef HAVE_SENDMMSG
+    for (size_t i = 0; i < _queue.size(); i++){
+        _send_iovs[i].iov_base = const_cast<void *>(_queue[i]->mem());
+        _send_iovs[i].iov_len = _queue[i]->size();
+    }
+
+    //sendmmsg may send fewer messages than requested, send the rest again
+    size_t num_sent = 0;
+    while (num_sent < _queue.size()){
+        const size_t num_msgs = this->setup_msgs(num_sent);
+        const int ret = ::sendmmsg(_sock_fd, &_send_msgs[0], num_msgs, 0);
+        if (ret > 0){
+            for (size_t i = 0; i < size_t(ret); i++) num_sent += _send_msg_frames[i];
+            continue;
+        }
+        if (ret == -1 and errno == ENOBUFS){
+            _counters.send_retries++;
+            boost::this_thread::sleep(boost::posix_time::microseconds(1));
+            continue; //try to send again
+        }
+        #ifdef HAVE_UDP_GSO
+        //frames larger than the path mtu can not be segmented
+        if (ret == -1 and errno == EINVAL and _gso){
+            UHD_MSG(warning) << "UDP segmentation offload failed, sending one frame per datagram." << std::endl;
+            _gso = false;
+            continue; //try to send again
+        }
+        #endif
+        UHD_ASSERT_THROW(ret > 0);
+    }
+    #else
+    BOOST_FOREACH(udp_zero_copy_asio_msb *msb, _queue){
+        send_with_retry(_sock_fd, msb->mem(), msb->size(), _counters);
+    }
+    #endif /*HAVE_SENDMMSG*/
+
+    BOOST_FOREACH(udp_zero_copy_asio_msb *msb, _queue) msb->sent();
+    _queue.clear();
+}
+
+#ifdef HAVE_SENDMMSG
+/*!
+ * Setup the message headers for the queued frames from first on.
+ * Without segmentation offload there is one message per frame.
+ * With it, a message holds a run of frames of the same size,
+ * only the last frame of a run may be shorter.
+ * \return the number of messages
+ */
+size_t udp_zero_copy_send_batch::setup_msgs(const size_t first){
+    size_t num_msgs = 0;
+    for (size_t i = first; i < _queue.size(); num_msgs++){
+        size_t num_frames = 1;
+        #ifdef HAVE_UDP_GSO
+        const size_t seg_size = _queue[i]->size();
+        size_t num_bytes = seg_size;
+        while (
+            _gso and i + num_frames < _queue.size() and
+            num_frames < GSO_MAX_SEGMENTS and
+            _queue[i + num_frames - 1]->size() == seg_size and
+            _queue[i + num_frames]->size() <= seg_size and
+            num_bytes + _queue[i + num_frames]->size() <= GSO_MAX_BYTES
+        ) num_bytes += _queue[i + num_frames++]->size();
+        #endif
+
+        mmsghdr &msg = _send_msgs[num_msgs];
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_hdr.msg_iov = &_send_iovs[i];
+        msg.msg_hdr.msg_iovlen = num_frames;
+        _send_msg_frames[num_msgs] = num_frames;
+
+        #ifdef HAVE_UDP_GSO
+        if (num_frames > 1){
+            msg.msg_hdr.msg_control = _send_controls[num_msgs].buff;
+            msg.msg_hdr.msg_controllen = sizeof(_send_controls[num_msgs].buff);
+            cmsghdr *cm = CMSG_FIRSTHDR(&msg.msg_hdr);
+            cm->cmsg_level = SOL_UDP;
+            cm->cmsg_type = UDP_SEGMENT;
+            cm->cmsg_len = CMSG_LEN(sizeof(boost::uint16_t));
+            const boost::uint16_t gso_size = boost::uint16_t(seg_size);
+            std::memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+        }
+        #endif
+
+        i += num_frames;
+    }
+    return num_msgs;
+}
+#endif /*HAVE_SENDMMSG*/
+
+/***********************************************************************
+ * Options of the UDP transport, parsed from the device address hints
+ **********************************************************************/
+struct udp_zero_copy_asio_params{
+    size_t recv_batch, send_batch;
+    double send_batch_timeout;
+    bool send_gso, recv_gro;
+    bool recv_io_uring, send_io_uring;
+    double recv_spin_time;
+    int recv_busy_poll;
+    bool recv_thread;
+    std::string recv_timestamps;
 };
 
 /***********************************************************************
@@ -158,15 +779,21 @@ public:
     udp_zero_copy_asio_impl(
         const std::string &addr,
         const std::string &port,
-        const zero_copy_xport_params& xport_params
+        const zero_copy_xport_params& xport_params,
+        const udp_zero_copy_asio_params &params,
+        const device_addr_t &hints
     ):
         _recv_frame_size(xport_params.recv_frame_size),
         _num_recv_frames(xport_params.num_recv_frames),
         _send_frame_size(xport_params.send_frame_size),
         _num_send_frames(xport_params.num_send_frames),
-        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size)),
-        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size)),
-        _next_recv_buff_index(0), _next_send_buff_index(0)
+        _recv_buffer_pool(buffer_pool::make(xport_params.num_recv_frames, xport_params.recv_frame_size, hints)),
+        _send_buffer_pool(buffer_pool::make(xport_params.num_send_frames, xport_params.send_frame_size, hints)),
+        _next_recv_buff_index(0), _next_send_buff_index(0),
+        _recv_batch(params.recv_batch), _num_recv_ready(0),
+        _recv_spin_time(params.recv_spin_time),
+        _recv_timestamps(false),
+        _gro_index(0)
     {
         UHD_LOG << boost::format("Creating udp transport for %s %s") % addr % port << std::endl;
 
@@ -185,21 +812,107 @@ public:
         _socket->connect(receiver_endpoint);
         _sock_fd = _socket->native();
 
+        //busy polling -> a blocking receive polls the network device
+        if (params.recv_busy_poll > 0){
+            #ifdef SO_BUSY_POLL
+            if (::setsockopt(_sock_fd, SOL_SOCKET, SO_BUSY_POLL, &params.recv_busy_poll, sizeof(params.recv_busy_poll)) != 0){
+                UHD_MSG(warning) << "Failed to enable busy polling on the socket: " << std::strerror(errno) << std::endl
+                                 << "Raising recv_busy_poll_us above net.core.busy_read needs the CAP_NET_ADMIN capability." << std::endl;
+            }
+            #else
+            UHD_MSG(warning) << "recv_busy_poll_us is not supported on this platform." << std::endl;
+            #endif
+        }
+
+        //receive timestamps -> the kernel records the arrival time of each frame
+        if (params.recv_timestamps == "hw") _recv_timestamps = this->enable_recv_timestamps(true);
+        else if (params.recv_timestamps != "0") _recv_timestamps = this->enable_recv_timestamps(false);
+
         //allocate re-usable managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::make_shared<udp_zero_copy_asio_mrb>(
-                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size()
+                _recv_buffer_pool->at(i), _sock_fd, get_recv_frame_size(), _recv_spin_time, _recv_timestamps, _counters
             ));
         }
 
+        //io_uring -> fixed buffer reads and writes instead of recv and send calls
+        if (params.recv_io_uring) try{
+            _recv_uring = io_uring_recv_xport::make(_sock_fd, _recv_buffer_pool, get_recv_frame_size(), _counters);
+        }
+        catch(const uhd::exception &e){
+            UHD_MSG(warning) << "Receiving without io_uring: " << e.what() << std::endl;
+        }
+        if (params.send_io_uring) try{
+            _send_uring = io_uring_send_xport::make(_sock_fd, _send_buffer_pool, get_send_frame_size(), false, _counters);
+        }
+        catch(const uhd::exception &e){
+            UHD_MSG(warning) << "Sending without io_uring: " << e.what() << std::endl;
+        }
+
+        //receive thread -> frames are received ahead of the caller
+        if (params.recv_thread and not _recv_uring) _recv_thread.reset(new udp_zero_copy_recv_thread(
+            _sock_fd, _mrb_pool, _recv_spin_time, _counters
+        ));
+
+        #ifdef HAVE_RECVMMSG
+        //message headers for the batched receive, one per frame of a batch
+        _recv_lens.resize(get_num_recv_frames(), 0);
+        _recv_iovs.resize(_recv_batch);
+        _recv_msgs.resize(_recv_batch);
+        #ifdef HAVE_SO_TIMESTAMPING
+        if (_recv_timestamps) _recv_controls.resize(_recv_batch);
+        #endif
+        #endif
+
+        //receive offload -> a few datagram sized buffers that hold several frames each
+        #ifdef HAVE_UDP_GSO
+        if (params.recv_gro and not _recv_uring and not _recv_thread and enable_udp_option(UDP_GRO, 1, "receive")){
+            _gro_buffer_pool = buffer_pool::make(GRO_NUM_BUFFS, GRO_BUFF_SIZE, hints);
+            for (size_t i = 0; i < GRO_NUM_BUFFS; i++){
+                _gro_buffs.push_back(boost::make_shared<udp_zero_copy_gro_buff>(
+                    _gro_buffer_pool->at(i), _sock_fd, _recv_spin_time, _counters
+                ));
+            }
+        }
+        const bool gso = params.send_gso and enable_udp_option(UDP_SEGMENT, 0, "send");
+        #else
+        const bool gso = false;
+        if (params.send_gso or params.recv_gro) UHD_MSG(warning)
+            << "UDP segmentation offload is not supported on this platform." << std::endl;
+        #endif /*HAVE_UDP_GSO*/
+
+        //the send buffers queue committed frames when sending in batches
+        if (params.send_batch > 1 and not _send_uring) _send_batch.reset(
+            new udp_zero_copy_send_batch(_sock_fd, params.send_batch, params.send_batch_timeout, gso, _counters)
+        );
+
         //allocate re-usable managed send buffers
         for (size_t i = 0; i < get_num_send_frames(); i++){
             _msb_pool.push_back(boost::make_shared<udp_zero_copy_asio_msb>(
-                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size()
+                _send_buffer_pool->at(i), _sock_fd, get_send_frame_size(), _send_batch.get(), _counters
             ));
         }
     }
 
+    //! Enable the kernel receive timestamps, return false with a warning if unsupported
+    bool enable_recv_timestamps(const bool hardware){
+        #ifdef HAVE_SO_TIMESTAMPING
+        //hardware timestamps fall back to software ones when the device has none
+        const int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE
+                        | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        const int enable = 1;
+        const int ret = hardware?
+            ::setsockopt(_sock_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) :
+            ::setsockopt(_sock_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+        if (ret == 0) return true;
+        UHD_MSG(warning) << "Failed to enable receive timestamps on the socket: " << std::strerror(errno) << std::endl;
+        #else
+        UHD_MSG(warning) << "recv_timestamps is not supported on this platform." << std::endl;
+        (void)hardware;
+        #endif
+        return false;
+    }
+
     //get size for internal socket buffer
     template <typename Opt> size_t get_buff_size(void) const{
         Opt option;
@@ -219,10 +932,128 @@ public:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff = this->get_next_recv_buff(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_recv_buffer::sptr get_next_recv_buff(const double timeout){
+        if (_recv_uring) return _recv_uring->get_recv_buff(timeout);
+        if (_recv_thread) return _recv_thread->get_recv_buff(timeout);
+        #ifdef HAVE_UDP_GSO
+        if (not _gro_buffs.empty()) return this->get_recv_buff_gro(timeout);
+        #endif
+        #ifdef HAVE_RECVMMSG
+        if (_recv_batch > 1) return this->get_recv_buff_batched(timeout);
+        #endif
         if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
         return _mrb_pool[_next_recv_buff_index]->get_new(timeout, _next_recv_buff_index);
     }
 
+#ifdef HAVE_RECVMMSG
+    /*******************************************************************
+     * Batched receive implementation:
+     * Receive up to recv_batch frames with one recvmmsg() call into
+     * the buffers from the current index on, then hand out the
+     * received frames one at a time before the next call.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff_batched(const double timeout){
+        if (_num_recv_ready == 0 and not this->recv_batch(timeout)){
+            return managed_recv_buffer::sptr(); //null for timeout
+        }
+        if (_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
+        const size_t index = _next_recv_buff_index++;
+        _num_recv_ready--;
+        return _mrb_pool[index]->get_received(_recv_lens[index]);
+    }
+
+    bool recv_batch(const double timeout){
+        //the claim and the wait for the socket share the timeout
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+
+        //the next buffer is needed for any frame,
+        //the buffers after it are only used when they are free
+        const size_t first = _next_recv_buff_index % _num_recv_frames;
+        if (not _mrb_pool[first]->claim(timeout)) return false;
+        size_t num_claimed = 1;
+        while (num_claimed < _recv_batch){
+            if (not _mrb_pool[(first + num_claimed) % _num_recv_frames]->claim(0.0)) break;
+            num_claimed++;
+        }
+
+        for (size_t i = 0; i < num_claimed; i++){
+            _recv_iovs[i].iov_base = _mrb_pool[(first + i) % _num_recv_frames]->mem();
+            _recv_iovs[i].iov_len = _recv_frame_size;
+            std::memset(&_recv_msgs[i], 0, sizeof(_recv_msgs[i]));
+            _recv_msgs[i].msg_hdr.msg_iov = &_recv_iovs[i];
+            _recv_msgs[i].msg_hdr.msg_iovlen = 1;
+            #ifdef HAVE_SO_TIMESTAMPING
+            if (_recv_timestamps){
+                _recv_msgs[i].msg_hdr.msg_control = _recv_controls[i].buff;
+                _recv_msgs[i].msg_hdr.msg_controllen = sizeof(_recv_controls[i].buff);
+            }
+            #endif
+        }
+
+        //try a non-blocking receive first, then wait for the socket for the rest of the timeout
+        int ret = ::recvmmsg(_sock_fd, &_recv_msgs[0], num_claimed, MSG_DONTWAIT, NULL);
+        if (ret <= 0){
+            const double remaining = std::max(0.0, (exit_time - time_spec_t::get_system_time()).get_real_secs());
+            if (counted_wait_for_recv_ready(_sock_fd, remaining, _recv_spin_time, _counters)){
+                ret = ::recvmmsg(_sock_fd, &_recv_msgs[0], num_claimed, MSG_DONTWAIT, NULL);
+            }
+        }
+
+        //an error, like a refused connection, is returned like a timeout
+        if (ret < 0 and errno != EAGAIN and errno != EWOULDBLOCK){
+            UHD_LOG << "udp_zero_copy recvmmsg failed: " << std::strerror(errno) << std::endl;
+        }
+        const size_t num_recvd = (ret > 0)? size_t(ret) : 0;
+
+        //record the frame lengths and undo the claims of the unused buffers
+        for (size_t i = 0; i < num_claimed; i++){
+            const size_t index = (first + i) % _num_recv_frames;
+            if (i < num_recvd){
+                _recv_lens[index] = _recv_msgs[i].msg_len;
+                #ifdef HAVE_SO_TIMESTAMPING
+                time_spec_t time;
+                if (parse_recv_timestamp(_recv_msgs[i].msg_hdr, time)) _mrb_pool[index]->set_recv_time(time);
+                else _mrb_pool[index]->clear_recv_time();
+                #endif
+            }
+            else _mrb_pool[index]->unclaim();
+        }
+        _next_recv_buff_index = first;
+        _num_recv_ready = num_recvd;
+        return num_recvd != 0;
+    }
+#endif /*HAVE_RECVMMSG*/
+
+#ifdef HAVE_UDP_GSO
+    /*******************************************************************
+     * Receive offload implementation:
+     * Hand out the frames of the current datagram,
+     * then receive the next datagram into the next buffer.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff_gro(const double timeout){
+        if (_gro_buffs[_gro_index]->empty()){
+            const size_t next = (_gro_index + 1) % _gro_buffs.size();
+            if (not _gro_buffs[next]->recv(timeout)) return managed_recv_buffer::sptr();
+            _gro_index = next;
+        }
+        return _gro_buffs[_gro_index]->get_next();
+    }
+
+    //! Set a UDP level socket option, return false with a warning if unsupported
+    bool enable_udp_option(const int option, const int value, const std::string &what){
+        if (::setsockopt(_sock_fd, SOL_UDP, option, &value, sizeof(value)) == 0) return true;
+        UHD_MSG(warning) << boost::format(
+            "UDP %s offload is not supported by the kernel (%s), using one frame per datagram."
+        ) % what % std::strerror(errno) << std::endl;
+        return false;
+    }
+#endif /*HAVE_UDP_GSO*/
+
     size_t get_num_recv_frames(void) const {return _num_recv_frames;}
     size_t get_recv_frame_size(void) const {return _recv_frame_size;}
 
@@ -231,14 +1062,31 @@ public:
      * Block on the managed buffer's get call and advance the index.
      ******************************************************************/
     managed_send_buffer::sptr get_send_buff(double timeout){
-        if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
-        return _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        managed_send_buffer::sptr buff;
+        if (_send_uring) buff = _send_uring->get_send_buff(timeout);
+        else{
+            if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
+            buff = _msb_pool[_next_send_buff_index]->get_new(timeout, _next_send_buff_index);
+        }
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const {return _num_send_frames;}
     size_t get_send_frame_size(void) const {return _send_frame_size;}
 
+    void flush_send_buffs(void){
+        if (_send_batch) _send_batch->flush();
+    }
+
+    zero_copy_counters get_counters(void) const{
+        return _counters.snapshot();
+    }
+
 private:
+    //counters -> declared first, the buffers and threads below refer to them
+    atomic_zero_copy_counters _counters;
+
     //memory management -> buffers and fifos
     const size_t _recv_frame_size, _num_recv_frames;
     const size_t _send_frame_size, _num_send_frames;
@@ -247,10 +1095,45 @@ private:
     std::vector<boost::shared_ptr<udp_zero_copy_asio_mrb> > _mrb_pool;
     size_t _next_recv_buff_index, _next_send_buff_index;
 
+    //batched receive -> frames received but not handed out yet
+    const size_t _recv_batch;
+    size_t _num_recv_ready;
+
+    //the time to poll the socket before a receive blocks
+    const double _recv_spin_time;
+
+    //the frames get the kernel receive time
+    bool _recv_timestamps;
+    #ifdef HAVE_RECVMMSG
+    std::vector<size_t> _recv_lens;
+    std::vector<iovec> _recv_iovs;
+    std::vector<mmsghdr> _recv_msgs;
+    #ifdef HAVE_SO_TIMESTAMPING
+    std::vector<udp_timestamp_control> _recv_controls;
+    #endif
+    #endif
+
+    //receive offload -> buffers for coalesced datagrams
+    size_t _gro_index;
+    #ifdef HAVE_UDP_GSO
+    buffer_pool::sptr _gro_buffer_pool;
+    std::vector<boost::shared_ptr<udp_zero_copy_gro_buff> > _gro_buffs;
+    #endif
+
     //asio guts -> socket and service
     asio::io_service        _io_service;
     socket_sptr             _socket;
     int                     _sock_fd;
+
+    //io_uring -> declared after the socket so the rings go away first
+    io_uring_recv_xport::sptr _recv_uring;
+    io_uring_send_xport::sptr _send_uring;
+
+    //receive thread -> declared after the socket so the thread stops first
+    udp_zero_copy_recv_thread::sptr _recv_thread;
+
+    //batched send -> declared last so it is flushed before the rest goes away
+    udp_zero_copy_send_batch::sptr _send_batch;
 };
 
 /***********************************************************************
@@ -302,6 +1185,58 @@ udp_zero_copy::sptr udp_zero_copy::make(
     xport_params.send_frame_size = size_t(hints.cast<double>("send_frame_size", default_buff_args.send_frame_size));
     xport_params.num_send_frames = size_t(hints.cast<double>("num_send_frames", default_buff_args.num_send_frames));
 
+    //the options of the transport
+    udp_zero_copy_asio_params params;
+
+    //number of frames to receive with one system call
+    params.recv_batch = size_t(hints.cast<double>("recv_batch", 1));
+    params.recv_batch = std::max<size_t>(1, std::min(params.recv_batch, xport_params.num_recv_frames));
+    #ifndef HAVE_RECVMMSG
+    if (params.recv_batch > 1){
+        UHD_MSG(warning) << "recv_batch is not supported on this platform, receiving one frame at a time." << std::endl;
+        params.recv_batch = 1;
+    }
+    #endif
+
+    //segmentation offload -> the kernel splits and coalesces datagrams
+    params.send_gso = hints.cast<int>("send_gso", 0) != 0;
+    params.recv_gro = hints.cast<int>("recv_gro", 0) != 0;
+    if (params.recv_gro and params.recv_batch > 1){
+        UHD_MSG(warning) << "recv_batch is not used with recv_gro." << std::endl;
+    }
+
+    //io_uring -> reads and writes are posted on a ring, batching and offload are not used
+    params.recv_io_uring = hints.cast<int>("recv_io_uring", 0) != 0;
+    params.send_io_uring = hints.cast<int>("send_io_uring", 0) != 0;
+
+    //busy polling -> poll the socket, and optionally the device, before blocking
+    params.recv_spin_time = std::max(0.0, hints.cast<double>("recv_spin_us", 0.0))/1e6;
+    params.recv_busy_poll = int(hints.cast<double>("recv_busy_poll_us", 0.0));
+
+    //receive thread -> a thread per transport receives ahead of the caller
+    params.recv_thread = hints.cast<int>("recv_thread", 0) != 0;
+    if (params.recv_thread and (params.recv_gro or params.recv_batch > 1)){
+        UHD_MSG(warning) << "recv_batch and recv_gro are not used with recv_thread." << std::endl;
+    }
+
+    //receive timestamps -> "1" or "sw" for the kernel's software time, "hw" for the device's time
+    params.recv_timestamps = hints.get("recv_timestamps", "0");
+    if (params.recv_timestamps != "0" and params.recv_io_uring){
+        UHD_MSG(warning) << "recv_timestamps is not used with recv_io_uring." << std::endl;
+    }
+
+    //number of frames to send with one system call, segmentation offload needs a batch,
+    //at most one less than the number of frames so that a buffer is always free
+    params.send_batch = size_t(hints.cast<double>("send_batch", params.send_gso? 32 : 1));
+    params.send_batch = std::max<size_t>(1, std::min(params.send_batch, xport_params.num_send_frames - 1));
+    params.send_batch_timeout = hints.cast<double>("send_batch_timeout", 0.001);
+    #ifndef HAVE_SENDMMSG
+    if (params.send_batch > 1){
+        UHD_MSG(warning) << "send_batch is not supported on this platform, sending one frame at a time." << std::endl;
+        params.send_batch = 1;
+    }
+    #endif
+
     //extract buffer size hints from the device addr
     size_t usr_recv_buff_size = size_t(hints.cast<double>("recv_buff_size", 0.0));
     size_t usr_send_buff_size = size_t(hints.cast<double>("send_buff_size", 0.0));
@@ -323,7 +1258,7 @@ udp_zero_copy::sptr udp_zero_copy::make(
     }
 
     udp_zero_copy_asio_impl::sptr udp_trans(
-        new udp_zero_copy_asio_impl(addr, port, xport_params)
+        new udp_zero_copy_asio_impl(addr, port, xport_params, params, hints)
     );
 
     //call the helper to resize send and recv buffers
@@ -0,0 +1,193 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#ifndef INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_COUNTERS_HPP
+#define INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_COUNTERS_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/version.hpp>
+#if BOOST_VERSION >= 105300
+#  include <boost/atomic.hpp>
+#  define UHD_ZERO_COPY_COUNTERS_ATOMIC
+#else
+#  include <boost/thread/mutex.hpp>
+#endif
+
+namespace uhd{ namespace transport{
+
+    /*!
+     * A 64-bit counter that the threads of a transport update
+     * while another thread reads it, the value never tears.
+     * The updates are relaxed, they only order the counter itself.
+     */
+    class atomic_counter : boost::noncopyable{
+    public:
+        atomic_counter(void): _value(0){
+            /* NOP */
+        }
+
+        UHD_INLINE void operator+=(const boost::uint64_t n){
+            #ifdef UHD_ZERO_COPY_COUNTERS_ATOMIC
+            _value.fetch_add(n, boost::memory_order_relaxed);
+            #else
+            boost::mutex::scoped_lock lock(_mutex);
+            _value += n;
+            #endif
+        }
+
+        UHD_INLINE void operator++(int){
+            *this += 1;
+        }
+
+        //! Raise the counter to n when it is smaller
+        UHD_INLINE void raise(const boost::uint64_t n){
+            #ifdef UHD_ZERO_COPY_COUNTERS_ATOMIC
+            boost::uint64_t value = _value.load(boost::memory_order_relaxed);
+            while (value < n and not _value.compare_exchange_weak(value, n, boost::memory_order_relaxed)){}
+            #else
+            boost::mutex::scoped_lock lock(_mutex);
+            if (_value < n) _value = n;
+            #endif
+        }
+
+        UHD_INLINE boost::uint64_t read(void) const{
+            #ifdef UHD_ZERO_COPY_COUNTERS_ATOMIC
+            return _value.load(boost::memory_order_relaxed);
+            #else
+            boost::mutex::scoped_lock lock(_mutex);
+            return _value;
+            #endif
+        }
+
+    private:
+        #ifdef UHD_ZERO_COPY_COUNTERS_ATOMIC
+        boost::atomic<boost::uint64_t> _value;
+        #else
+        mutable boost::mutex _mutex;
+        boost::uint64_t _value;
+        #endif
+    };
+
+    /*!
+     * The counters of a transport, see zero_copy_counters.
+     * Any thread of the transport may update them,
+     * get_counters() returns a snapshot from the caller's thread.
+     * The wait times are counted in nanoseconds.
+     */
+    struct atomic_zero_copy_counters : boost::noncopyable{
+        atomic_counter recv_packets, recv_bytes, recv_timeouts, recv_retries;
+        atomic_counter recv_frames_released, recv_frames_in_use_max, recv_wait_time;
+        atomic_counter send_frames, send_packets, send_bytes, send_timeouts, send_retries;
+        atomic_counter send_frames_in_use_max, send_wait_time;
+
+        //! Read every counter into a copy
+        zero_copy_counters snapshot(void) const{
+            zero_copy_counters counters;
+            counters.recv_packets = recv_packets.read();
+            counters.recv_bytes = recv_bytes.read();
+            counters.recv_timeouts = recv_timeouts.read();
+            counters.recv_retries = recv_retries.read();
+            counters.recv_frames_released = recv_frames_released.read();
+            counters.recv_frames_in_use_max = size_t(recv_frames_in_use_max.read());
+            counters.recv_wait_time = recv_wait_time.read()/1e9;
+            counters.send_frames = send_frames.read();
+            counters.send_packets = send_packets.read();
+            counters.send_bytes = send_bytes.read();
+            counters.send_timeouts = send_timeouts.read();
+            counters.send_retries = send_retries.read();
+            counters.send_frames_in_use_max = size_t(send_frames_in_use_max.read());
+            counters.send_wait_time = send_wait_time.read()/1e9;
+            return counters;
+        }
+    };
+
+    //! Raise a maximum of the frames in use to the difference of two counters
+    UHD_INLINE void count_in_use(atomic_counter &in_use_max, const atomic_counter &taken, const atomic_counter &returned){
+        const boost::uint64_t num_taken = taken.read(), num_returned = returned.read();
+        if (num_taken > num_returned) in_use_max.raise(num_taken - num_returned);
+    }
+
+    //! Count the result of a get_recv_buff call
+    UHD_INLINE void count_recv_buff(atomic_zero_copy_counters &counters, const managed_recv_buffer::sptr &buff){
+        if (not buff){
+            counters.recv_timeouts++;
+            return;
+        }
+        counters.recv_packets++;
+        counters.recv_bytes += buff->size();
+        count_in_use(counters.recv_frames_in_use_max, counters.recv_packets, counters.recv_frames_released);
+    }
+
+    //! Count a receive buffer that the caller released
+    UHD_INLINE void count_recv_release(atomic_zero_copy_counters &counters){
+        counters.recv_frames_released++;
+    }
+
+    //! Count the result of a get_send_buff call
+    UHD_INLINE void count_send_buff(atomic_zero_copy_counters &counters, const managed_send_buffer::sptr &buff){
+        if (not buff){
+            counters.send_timeouts++;
+            return;
+        }
+        counters.send_frames++;
+        count_in_use(counters.send_frames_in_use_max, counters.send_frames, counters.send_packets);
+    }
+
+    //! Count a send buffer that the caller committed
+    UHD_INLINE void count_send_commit(atomic_zero_copy_counters &counters, const size_t num_bytes){
+        counters.send_packets++;
+        counters.send_bytes += num_bytes;
+    }
+
+    /*!
+     * Add the time from construction to destruction to a wait time counter.
+     * Put it around the calls where the caller blocks, the clock is only read when it is used.
+     */
+    class counted_wait : boost::noncopyable{
+    public:
+        counted_wait(atomic_counter &wait_time):
+            _wait_time(wait_time), _start(time_spec_t::get_system_time())
+        {
+            /* NOP */
+        }
+
+        ~counted_wait(void){
+            _wait_time += boost::uint64_t((time_spec_t::get_system_time() - _start).to_ticks(1e9));
+        }
+
+    private:
+        atomic_counter &_wait_time;
+        const time_spec_t _start;
+    };
+
+    /*!
+     * Claim a buffer, waiting up to the timeout for it to become free.
+     * Only the time of a claim that has to wait is counted.
+     */
+    UHD_INLINE bool claim_with_counted_wait(simple_claimer &claimer, const double timeout, atomic_counter &wait_time){
+        if (claimer.claim_with_wait(0.0)) return true;
+        counted_wait wait(wait_time);
+        return claimer.claim_with_wait(timeout);
+    }
+
+}} //namespace uhd::transport
+
+#endif /* INCLUDED_LIBUHD_TRANSPORT_ZERO_COPY_COUNTERS_HPP */
@@ -44,6 +44,9 @@ std::string rx_metadata_t::to_pp_string(bool compact) const
         if (error_code != ERROR_CODE_NONE) {
             ss << strerror() << "\n";
         }
+        if (has_recv_time) {
+            ss << "Host arrival time: " << recv_time.get_real_secs() << " s\n";
+        }
     } else {
         ss << "Has timespec: " << (has_time_spec ? "Yes" : "No")
            << "\tTime of first sample: " << time_spec.get_real_secs()
@@ -53,6 +56,9 @@ std::string rx_metadata_t::to_pp_string(bool compact) const
            << "\tEnd of burst: " << (end_of_burst ? "Yes" : "No")
            << "\nError Code: " << strerror()
            << "\tOut of sequence: " << (out_of_sequence ? "Yes" : "No");
+        if (has_recv_time) {
+            ss << "\nHost arrival time: " << recv_time.get_real_secs();
+        }
     }
 
     return ss.str();
@@ -18,6 +18,7 @@
 #include "apply_corrections.hpp"
 #include "b100_impl.hpp"
 #include "b100_regs.hpp"
+#include "xport_counters.hpp"
 #include <uhd/transport/usb_control.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/cast.hpp>
@@ -258,6 +259,10 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     data_xport_args["num_recv_frames"] = device_addr.get("num_recv_frames", "16");
     data_xport_args["send_frame_size"] = device_addr.get("send_frame_size", "16384");
     data_xport_args["num_send_frames"] = device_addr.get("num_send_frames", "16");
+    BOOST_FOREACH(const std::string &key, device_addr.keys()){
+        if (key.find("buff_") == 0) data_xport_args[key] = device_addr[key]; //buffer pool allocation policies
+        if (key.find("_xfers_in_flight") != std::string::npos) data_xport_args[key] = device_addr[key];
+    }
 
     //let packet padder know the LUT size in number of words32
     const size_t rx_lut_size = size_t(data_xport_args.cast<double>("recv_frame_size", 0.0));
@@ -280,6 +285,8 @@ b100_impl::b100_impl(const device_addr_t &device_addr){
     const fs_path mb_path = "/mboards/0";
     _tree->create<std::string>(mb_path / "name").set("B100");
     _tree->create<std::string>(mb_path / "codename").set("B-Hundo");
+    publish_xport_counters(_tree, mb_path / "xports" / "ctrl", _ctrl_transport);
+    publish_xport_counters(_tree, mb_path / "xports" / "data", _data_transport);
     _tree->create<std::string>(mb_path / "load_eeprom")
         .subscribe(boost::bind(&fx2_ctrl::usrp_load_eeprom, _fx2_ctrl, _1));
 
@@ -219,6 +219,11 @@ public:
         return std::min(_frame_boundary, _internal_zc->get_send_frame_size());
     }
 
+    //! The counters of the USB transfers that carry the packets
+    zero_copy_counters get_counters(void) const{
+        return _internal_zc->get_counters();
+    }
+
 private:
     zero_copy_if::sptr _internal_zc;
     size_t _frame_boundary;
@@ -17,6 +17,7 @@
 
 #include "b200_impl.hpp"
 #include "b200_regs.hpp"
+#include "xport_counters.hpp"
 #include <uhd/config.hpp>
 #include <uhd/transport/usb_control.hpp>
 #include <uhd/utils/msg.hpp>
@@ -441,6 +442,10 @@ b200_impl::b200_impl(const device_addr_t &device_addr) :
     data_xport_args["num_recv_frames"] = device_addr.get("num_recv_frames", "16");
     data_xport_args["send_frame_size"] = device_addr.get("send_frame_size", "8192");
     data_xport_args["num_send_frames"] = device_addr.get("num_send_frames", "16");
+    BOOST_FOREACH(const std::string &key, device_addr.keys()){
+        if (key.find("buff_") == 0) data_xport_args[key] = device_addr[key]; //buffer pool allocation policies
+        if (key.find("_xfers_in_flight") != std::string::npos) data_xport_args[key] = device_addr[key];
+    }
 
     _data_transport = usb_zero_copy::make(
         handle,        // identifier
@@ -450,6 +455,8 @@ b200_impl::b200_impl(const device_addr_t &device_addr) :
     );
     while (_data_transport->get_recv_buff(0.0)){} //flush ctrl xport
     _demux = recv_packet_demuxer_3000::make(_data_transport);
+    publish_xport_counters(_tree, mb_path / "xports" / "ctrl", _ctrl_transport);
+    publish_xport_counters(_tree, mb_path / "xports" / "data", _data_transport);
 
     ////////////////////////////////////////////////////////////////////
     // create time and clock control objects
@@ -164,6 +164,7 @@ namespace uhd{ namespace usrp{
         {
             return _xport->get_send_buff(timeout);
         }
+        transport::zero_copy_counters get_counters(void) const {return _xport->get_counters();}
 
         recv_packet_demuxer_3000::sptr _demux;
         transport::zero_copy_if::sptr _xport;
@@ -0,0 +1,39 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "xport_counters.hpp"
+#include <boost/weak_ptr.hpp>
+#include <boost/bind.hpp>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static zero_copy_counters get_xport_counters(boost::weak_ptr<zero_copy_if> xport_wptr){
+    zero_copy_if::sptr xport = xport_wptr.lock();
+    if (not xport) return zero_copy_counters();
+    return xport->get_counters();
+}
+
+void uhd::usrp::publish_xport_counters(
+    property_tree::sptr tree,
+    const fs_path &path,
+    zero_copy_if::sptr xport
+){
+    if (tree->exists(path)) tree->remove(path);
+    tree->create<zero_copy_counters>(path)
+        .publish(boost::bind(&get_xport_counters, boost::weak_ptr<zero_copy_if>(xport)));
+}
@@ -0,0 +1,42 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_COMMON_XPORT_COUNTERS_HPP
+#define INCLUDED_LIBUHD_USRP_COMMON_XPORT_COUNTERS_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/property_tree.hpp>
+#include <uhd/transport/zero_copy.hpp>
+
+namespace uhd{ namespace usrp{
+
+    /*!
+     * Publish the counters of a transport in the property tree,
+     * ex: /mboards/0/xports/rx0 for the first receive transport.
+     * The node only holds a weak reference to the transport,
+     * the counters read back as zero when the transport is gone.
+     * An existing node from an earlier transport is replaced.
+     */
+    void publish_xport_counters(
+        property_tree::sptr tree,
+        const fs_path &path,
+        transport::zero_copy_if::sptr xport
+    );
+
+}} //namespace uhd::usrp
+
+#endif /* INCLUDED_LIBUHD_USRP_COMMON_XPORT_COUNTERS_HPP */
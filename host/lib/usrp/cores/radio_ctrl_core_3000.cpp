@@ -21,7 +21,7 @@
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/byteswap.hpp>
 #include <uhd/utils/safe_call.hpp>
-#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/spsc_bounded_buffer.hpp>
 #include <uhd/transport/vrt_if_packet.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
@@ -333,7 +333,8 @@ private:
     double _tick_rate;
     double _timeout;
     std::queue<size_t> _outstanding_seqs;
-    bounded_buffer<resp_buff_type> _resp_queue;
+    //pushed by the async task, popped under _mutex
+    spsc_bounded_buffer<resp_buff_type> _resp_queue;
     const size_t _resp_queue_size;
 };
 
@@ -17,6 +17,7 @@
 
 #include "e100_ctrl.hpp"
 #include "e100_regs.hpp"
+#include "../../transport/zero_copy_counters.hpp"
 #include <uhd/exception.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
@@ -265,10 +266,11 @@ struct e100_simpl_mrb : managed_recv_buffer
 {
     usrp_e_ctl32 data;
     e100_ctrl *ctrl;
+    atomic_zero_copy_counters *counters;
 
     void release(void)
     {
-        //NOP
+        count_recv_release(*counters);
     }
 
     sptr get_new(void)
@@ -292,9 +294,11 @@ struct e100_simpl_msb : managed_send_buffer
 {
     usrp_e_ctl32 data;
     e100_ctrl *ctrl;
+    atomic_zero_copy_counters *counters;
 
     void release(void)
     {
+        count_send_commit(*counters, this->size());
         const size_t max_words32 = 8; //.LAST_ADDR(10'h00f)) resp_fifo_to_gpmc
 
         //load the data struct
@@ -390,7 +394,10 @@ public:
         pollfd pfd;
         pfd.fd = _irq_fd;
         pfd.events = POLLPRI | POLLERR;
-        ::poll(&pfd, 1, long(timeout*1000)/*ms*/);
+        {
+            counted_wait wait(_counters.recv_wait_time);
+            ::poll(&pfd, 1, long(timeout*1000)/*ms*/);
+        }
 
         //perform a GPIO read again for result
         return this->resp_read();
@@ -398,19 +405,24 @@ public:
 
     managed_recv_buffer::sptr get_recv_buff(double timeout)
     {
-        if (not this->resp_wait(timeout))
+        managed_recv_buffer::sptr buff;
+        if (this->resp_wait(timeout))
         {
-            return managed_recv_buffer::sptr();
+            _mrb.ctrl = this;
+            _mrb.counters = &_counters;
+            buff = _mrb.get_new();
         }
-
-        _mrb.ctrl = this;
-        return _mrb.get_new();
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     managed_send_buffer::sptr get_send_buff(double)
     {
         _msb.ctrl = this;
-        return _msb.get_new();
+        _msb.counters = &_counters;
+        managed_send_buffer::sptr buff = _msb.get_new();
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const{
@@ -429,7 +441,12 @@ public:
         return sizeof(_msb.data.buf);
     }
 
+    zero_copy_counters get_counters(void) const{
+        return _counters.snapshot();
+    }
+
 private:
+    atomic_zero_copy_counters _counters;
     int _node_fd;
     int _irq_fd;
     boost::mutex _ioctl_mutex;
@@ -16,6 +16,7 @@
 //
 
 #include "e100_ctrl.hpp"
+#include "../../transport/zero_copy_counters.hpp"
 #include <uhd/transport/zero_copy.hpp>
 #include <uhd/utils/log.hpp>
 #include <uhd/exception.hpp>
@@ -38,11 +39,12 @@ static const size_t poll_breakout = 10; //how many poll timeouts constitute a fu
  **********************************************************************/
 class e100_mmap_zero_copy_mrb : public managed_recv_buffer{
 public:
-    e100_mmap_zero_copy_mrb(void *mem, ring_buffer_info *info):
-        _mem(mem), _info(info) { /* NOP */ }
+    e100_mmap_zero_copy_mrb(void *mem, ring_buffer_info *info, atomic_zero_copy_counters &counters):
+        _mem(mem), _info(info), _counters(counters) { /* NOP */ }
 
     void release(void){
         if (fp_verbose) UHD_LOGV(always) << "recv buff: release" << std::endl;
+        count_recv_release(_counters);
         _info->flags = RB_KERNEL; //release the frame
     }
 
@@ -57,6 +59,7 @@ public:
 private:
     void *_mem;
     ring_buffer_info *_info;
+    atomic_zero_copy_counters &_counters;
 };
 
 /***********************************************************************
@@ -65,11 +68,12 @@ private:
  **********************************************************************/
 class e100_mmap_zero_copy_msb : public managed_send_buffer{
 public:
-    e100_mmap_zero_copy_msb(void *mem, ring_buffer_info *info, size_t len, int fd):
-        _mem(mem), _info(info), _len(len), _fd(fd) { /* NOP */ }
+    e100_mmap_zero_copy_msb(void *mem, ring_buffer_info *info, size_t len, int fd, atomic_zero_copy_counters &counters):
+        _mem(mem), _info(info), _len(len), _fd(fd), _counters(counters) { /* NOP */ }
 
     void release(void){
         if (fp_verbose) UHD_LOGV(always) << "send buff: commit " << size() << std::endl;
+        count_send_commit(_counters, size());
         _info->len = _len;//size();
         _info->flags = RB_USER; //release the frame
         if (::write(_fd, NULL, 0) < 0){ //notifies the kernel
@@ -90,6 +94,7 @@ private:
     ring_buffer_info *_info;
     size_t _len;
     int _fd;
+    atomic_zero_copy_counters &_counters;
 };
 
 /***********************************************************************
@@ -156,7 +161,7 @@ public:
         //initialize the managed receive buffers
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _mrb_pool.push_back(boost::make_shared<e100_mmap_zero_copy_mrb>(
-                recv_buff + get_recv_frame_size()*i, (*recv_info) + i
+                recv_buff + get_recv_frame_size()*i, (*recv_info) + i, _counters
             ));
         }
 
@@ -164,7 +169,7 @@ public:
         for (size_t i = 0; i < get_num_recv_frames(); i++){
             _msb_pool.push_back(boost::make_shared<e100_mmap_zero_copy_msb>(
                 send_buff + get_send_frame_size()*i, (*send_info) + i,
-                get_send_frame_size(), _fd
+                get_send_frame_size(), _fd, _counters
             ));
         }
     }
@@ -175,11 +180,18 @@ public:
     }
 
     managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff = this->get_next_recv_buff(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_recv_buffer::sptr get_next_recv_buff(const double timeout){
         if (fp_verbose) UHD_LOGV(always) << "get_recv_buff: " << _recv_index << std::endl;
         e100_mmap_zero_copy_mrb &mrb = *_mrb_pool[_recv_index];
 
         //poll/wait for a ready frame
         if (not mrb.ready()){
+            counted_wait wait(_counters.recv_wait_time);
             for (size_t i = 0; i < poll_breakout; i++){
                 pollfd pfd;
                 pfd.fd = _fd;
@@ -207,6 +219,12 @@ public:
     }
 
     managed_send_buffer::sptr get_send_buff(double timeout){
+        managed_send_buffer::sptr buff = this->get_next_send_buff(timeout);
+        count_send_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_send_buffer::sptr get_next_send_buff(const double timeout){
         if (fp_verbose) UHD_LOGV(always) << "get_send_buff: " << _send_index << std::endl;
         e100_mmap_zero_copy_msb &msb = *_msb_pool[_send_index];
 
@@ -215,6 +233,7 @@ public:
             pollfd pfd;
             pfd.fd = _fd;
             pfd.events = POLLOUT;
+            counted_wait wait(_counters.send_wait_time);
             ssize_t poll_ret = ::poll(&pfd, 1, size_t(timeout*1e3));
             if (fp_verbose) UHD_LOGV(always) << "  POLLOUT: " << poll_ret << std::endl;
             if (poll_ret <= 0) return managed_send_buffer::sptr();
@@ -235,7 +254,14 @@ public:
         return _frame_size;
     }
 
+    zero_copy_counters get_counters(void) const{
+        return _counters.snapshot();
+    }
+
 private:
+    //counters -> declared first, the managed buffers refer to them
+    atomic_zero_copy_counters _counters;
+
     //file descriptor for mmap
     int _fd;
 
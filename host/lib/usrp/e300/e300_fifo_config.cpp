@@ -77,6 +77,7 @@ static UHD_INLINE size_t ZF_STREAM_OFF(const size_t which)
 }
 
 #include "e300_fifo_config.hpp"
+#include "../../transport/zero_copy_counters.hpp"
 #include <sys/mman.h> //mmap
 #include <fcntl.h> //open, close
 #include <poll.h> //poll
@@ -158,11 +159,14 @@ UHD_INLINE boost::uint32_t zf_peek32(const boost::uint32_t addr)
  **********************************************************************/
 struct e300_fifo_mb : managed_buffer
 {
-    e300_fifo_mb(const __mem_addrz_t &addrs, const size_t len):
-        ctrl_base(addrs.ctrl), phys_mem(addrs.phys), mem((void *)addrs.data), len(len){}
+    e300_fifo_mb(const __mem_addrz_t &addrs, const size_t len, const bool is_recv):
+        ctrl_base(addrs.ctrl), phys_mem(addrs.phys), mem((void *)addrs.data), len(len),
+        is_recv(is_recv), counters(NULL){}
 
     void release(void)
     {
+        if (counters != NULL and is_recv) count_recv_release(*counters);
+        else if (counters != NULL) count_send_commit(*counters, this->size());
         UHD_ASSERT_THROW(zf_peek32(ctrl_base+ARBITER_RB_ADDR_SPACE) > 0);
         UHD_ASSERT_THROW(zf_peek32(ctrl_base+ARBITER_RB_SIZE_SPACE) > 0);
         zf_poke32(ctrl_base + ARBITER_WR_ADDR, phys_mem);
@@ -179,6 +183,8 @@ struct e300_fifo_mb : managed_buffer
     const size_t phys_mem;
     void *const mem;
     const size_t len;
+    const bool is_recv;
+    atomic_zero_copy_counters *counters; //null while the buffers are set up
 };
 
 /***********************************************************************
@@ -216,12 +222,13 @@ public:
             __mem_addrz_t mb_addrs = addrs;
             mb_addrs.phys += (i*frame_size);
             mb_addrs.data += (i*frame_size);
-            boost::shared_ptr<e300_fifo_mb> mb(new e300_fifo_mb(mb_addrs, frame_size));
+            boost::shared_ptr<e300_fifo_mb> mb(new e300_fifo_mb(mb_addrs, frame_size, auto_release));
 
             //setup the buffers so they are "positioned for use"
             const size_t sts_good = (1 << 7) | (_addrs.which & 0xf);
             if (auto_release) mb->get_new<managed_recv_buffer>(); //release for read
             else zf_poke32(_addrs.ctrl + ARBITER_WR_STS, sts_good); //poke an ok into the sts fifo
+            mb->counters = &_counters;
 
             _buffs.push_back(mb);
         }
@@ -248,6 +255,7 @@ public:
                     _index = 0;
                 return _buffs[_index++]->get_new<T>();
             }
+            counted_wait wait((_buffs.front()->is_recv)? _counters.recv_wait_time : _counters.send_wait_time);
             _waiter->wait(timeout);
             //boost::this_thread::sleep(boost::posix_time::milliseconds(1));
         }
@@ -258,7 +266,9 @@ public:
 
     managed_recv_buffer::sptr get_recv_buff(const double timeout)
     {
-        return this->get_buff<managed_recv_buffer>(timeout);
+        managed_recv_buffer::sptr buff = this->get_buff<managed_recv_buffer>(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_recv_frames(void) const
@@ -273,7 +283,9 @@ public:
 
     managed_send_buffer::sptr get_send_buff(const double timeout)
     {
-        return this->get_buff<managed_send_buffer>(timeout);
+        managed_send_buffer::sptr buff = this->get_buff<managed_send_buffer>(timeout);
+        count_send_buff(_counters, buff);
+        return buff;
     }
 
     size_t get_num_send_frames(void) const
@@ -286,7 +298,13 @@ public:
         return _frame_size;
     }
 
+    zero_copy_counters get_counters(void) const
+    {
+        return _counters.snapshot();
+    }
+
 private:
+    atomic_zero_copy_counters _counters;
     boost::shared_ptr<void> _allocator;
     const __mem_addrz_t _addrs;
     const size_t _num_frames;
@@ -24,6 +24,7 @@
 #include "e300_sensor_manager.hpp"
 #include "e300_common.hpp"
 #include "e300_remote_codec_ctrl.hpp"
+#include "xport_counters.hpp"
 
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/log.hpp>
@@ -949,6 +950,7 @@ void e300_impl::_setup_radio(const size_t dspno)
         ctrl_xports.recv,
         ctrl_sid,
         dspno ? "1" : "0");
+    publish_xport_counters(_tree, mb_path / "xports" / str(boost::format("ctrl%d") % dspno), ctrl_xports.recv);
     this->_register_loopback_self_test(perif.ctrl);
     perif.atr = gpio_core_200_32wo::make(perif.ctrl, TOREG(SR_GPIO));
 
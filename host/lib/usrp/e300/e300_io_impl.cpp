@@ -19,6 +19,7 @@
 #include "e300_impl.hpp"
 #include "e300_fpga_defs.hpp"
 #include "validate_subdev_spec.hpp"
+#include "xport_counters.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include "async_packet_handler.hpp"
@@ -451,6 +452,7 @@ rx_streamer::sptr e300_impl::get_rx_stream(const uhd::stream_args_t &args_)
            E300_RADIO_DEST_PREFIX_RX,
            _data_xport_params,
            data_sid);
+        publish_xport_counters(_tree, str(boost::format("/mboards/0/xports/rx%u") % radio_index), data_xports.recv);
 
         //calculate packet size
         static const size_t hdr_size = 0
@@ -478,7 +480,7 @@ rx_streamer::sptr e300_impl::get_rx_stream(const uhd::stream_args_t &args_)
         id.num_inputs = 1;
         id.output_format = args.cpu_format;
         id.num_outputs = 1;
-        my_streamer->set_converter(id);
+        my_streamer->set_converter(id, args.args);
 
         perif.framer->clear();
         perif.framer->set_nsamps_per_packet(spp); //seems to be a good place to set this
@@ -565,6 +567,7 @@ tx_streamer::sptr e300_impl::get_tx_stream(const uhd::stream_args_t &args_)
            E300_RADIO_DEST_PREFIX_TX,
            _data_xport_params,
            data_sid);
+        publish_xport_counters(_tree, str(boost::format("/mboards/0/xports/tx%u") % radio_index), data_xports.send);
 
         //calculate packet size
         static const size_t hdr_size = 0
@@ -592,7 +595,7 @@ tx_streamer::sptr e300_impl::get_tx_stream(const uhd::stream_args_t &args_)
         id.num_inputs = 1;
         id.output_format = args.otw_format + "_item32_le";
         id.num_outputs = 1;
-        my_streamer->set_converter(id);
+        my_streamer->set_converter(id, args.args);
 
         perif.deframer->clear();
         perif.deframer->setup(args);
@@ -0,0 +1,278 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_impl.hpp"
+#include "validate_subdev_spec.hpp"
+#include <uhd/usrp/dboard_eeprom.hpp>
+#include <uhd/usrp/mboard_eeprom.hpp>
+#include <uhd/utils/static.hpp>
+#include <uhd/utils/msg.hpp>
+#include <uhd/exception.hpp>
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <cmath>
+
+using namespace uhd;
+using namespace uhd::usrp;
+
+static const meta_range_t SIM_FREQ_RANGE(0.0, 6e9);
+static const meta_range_t SIM_GAIN_RANGE(0.0, 31.5, 0.5);
+static const meta_range_t SIM_BANDWIDTH_RANGE(1e6, 160e6);
+
+/***********************************************************************
+ * Discovery over the device hint
+ **********************************************************************/
+static device_addrs_t sim_find(const device_addr_t &hint)
+{
+    //the simulated device is only found when asked for by type
+    if (not hint.has_key("type") or hint["type"] != "sim") return device_addrs_t();
+
+    device_addr_t new_addr;
+    new_addr["type"] = "sim";
+    new_addr["name"] = "sim";
+    new_addr["serial"] = "SIM0";
+    if (hint.has_key("name") and hint["name"] != new_addr["name"]) return device_addrs_t();
+    if (hint.has_key("serial") and hint["serial"] != new_addr["serial"]) return device_addrs_t();
+    return device_addrs_t(1, new_addr);
+}
+
+/***********************************************************************
+ * Make
+ **********************************************************************/
+static device::sptr sim_make(const device_addr_t &device_addr)
+{
+    return device::sptr(new sim_impl(device_addr));
+}
+
+UHD_STATIC_BLOCK(register_sim_device)
+{
+    device::register_device(&sim_find, &sim_make, device::USRP);
+}
+
+/***********************************************************************
+ * Structors
+ **********************************************************************/
+sim_impl::sim_impl(const device_addr_t &dev_addr)
+{
+    UHD_MSG(status) << "Simulated device initialization sequence..." << std::endl;
+    _type = device::USRP;
+    _clock = sim_clock::make();
+    _async_md = sim_async_queue::make(_clock, 1000/*messages deep*/);
+    _tree = property_tree::make();
+    _tree->create<std::string>("/name").set("Simulated Device");
+
+    _num_chans = dev_addr.cast<size_t>("num_chans", SIM_DEFAULT_NUM_CHANS);
+    if (_num_chans == 0) throw uhd::value_error("sim_impl: num_chans must be at least 1");
+    _seed = dev_addr.cast<boost::uint32_t>("seed", 0);
+    _tick_rate = dev_addr.cast<double>("master_clock_rate", SIM_DEFAULT_TICK_RATE);
+    _rx_xports.resize(_num_chans);
+    _tx_xports.resize(_num_chans);
+
+    //the transport and link error hints go to the streamers
+    _recv_args = _send_args = dev_addr;
+
+    const fs_path mb_path = "/mboards/0";
+    _tree->create<std::string>(mb_path / "name").set("SIM");
+
+    mboard_eeprom_t mb_eeprom;
+    mb_eeprom["name"] = "sim";
+    mb_eeprom["serial"] = "SIM0";
+    _tree->create<mboard_eeprom_t>(mb_path / "eeprom").set(mb_eeprom);
+
+    ////////////////////////////////////////////////////////////////////
+    // create the tick rate and time keeper
+    ////////////////////////////////////////////////////////////////////
+    _tree->create<double>(mb_path / "tick_rate")
+        .subscribe(boost::bind(&sim_impl::update_tick_rate, this, _1))
+        .set(_tick_rate);
+    _tree->create<time_spec_t>(mb_path / "time" / "now")
+        .publish(boost::bind(&sim_clock::get_time_now, _clock))
+        .subscribe(boost::bind(&sim_clock::set_time_now, _clock, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "pps")
+        .publish(boost::bind(&sim_clock::get_time_last_pps, _clock))
+        .subscribe(boost::bind(&sim_clock::set_time_next_pps, _clock, _1));
+    _tree->create<time_spec_t>(mb_path / "time" / "cmd"); //timed commands take effect at once
+
+    ////////////////////////////////////////////////////////////////////
+    // setup time and clock sources
+    ////////////////////////////////////////////////////////////////////
+    static const std::vector<std::string> sources = boost::assign::list_of("internal")("external");
+    _tree->create<std::string>(mb_path / "time_source" / "value").set("internal");
+    _tree->create<std::vector<std::string> >(mb_path / "time_source" / "options").set(sources);
+    _tree->create<std::string>(mb_path / "clock_source" / "value").set("internal");
+    _tree->create<std::vector<std::string> >(mb_path / "clock_source" / "options").set(sources);
+    _tree->create<sensor_value_t>(mb_path / "sensors" / "ref_locked")
+        .publish(boost::bind(&sim_impl::get_ref_locked, this));
+
+    ////////////////////////////////////////////////////////////////////
+    // create the daughterboard and codecs
+    ////////////////////////////////////////////////////////////////////
+    const fs_path db_path = mb_path / "dboards" / "A";
+    _tree->create<dboard_eeprom_t>(db_path / "rx_eeprom").set(dboard_eeprom_t());
+    _tree->create<dboard_eeprom_t>(db_path / "tx_eeprom").set(dboard_eeprom_t());
+    _tree->create<int>(mb_path / "rx_codecs" / "A" / "gains"); //phony property so this dir exists
+    _tree->create<int>(mb_path / "tx_codecs" / "A" / "gains"); //phony property so this dir exists
+    _tree->create<std::string>(mb_path / "rx_codecs" / "A" / "name").set("sim");
+    _tree->create<std::string>(mb_path / "tx_codecs" / "A" / "name").set("sim");
+
+    for (size_t i = 0; i < _num_chans; i++)
+    {
+        const std::string fe_name = boost::lexical_cast<std::string>(i);
+        BOOST_FOREACH(const std::string &tx_rx, std::vector<std::string>(boost::assign::list_of("rx")("tx")))
+        {
+            const fs_path fe_path = db_path / (tx_rx + "_frontends") / fe_name;
+            _tree->create<std::string>(fe_path / "name").set(str(boost::format("SIM %s") % (tx_rx == "rx"? "RX" : "TX")));
+            _tree->create<sensor_value_t>(fe_path / "sensors" / "lo_locked")
+                .set(sensor_value_t("LO", true, "locked", "unlocked"));
+            _tree->create<meta_range_t>(fe_path / "gains" / "PGA0" / "range").set(SIM_GAIN_RANGE);
+            _tree->create<double>(fe_path / "gains" / "PGA0" / "value")
+                .coerce(boost::bind(&meta_range_t::clip, SIM_GAIN_RANGE, _1, true))
+                .set(0.0);
+            _tree->create<meta_range_t>(fe_path / "freq" / "range").set(SIM_FREQ_RANGE);
+            _tree->create<double>(fe_path / "freq" / "value")
+                .coerce(boost::bind(&meta_range_t::clip, SIM_FREQ_RANGE, _1, false))
+                .set(1e9);
+            static const std::vector<std::string> antennas = boost::assign::list_of("TX/RX")("RX2");
+            _tree->create<std::vector<std::string> >(fe_path / "antenna" / "options")
+                .set(tx_rx == "rx"? antennas : std::vector<std::string>(1, antennas[0]));
+            _tree->create<std::string>(fe_path / "antenna" / "value").set(tx_rx == "rx"? "RX2" : "TX/RX");
+            _tree->create<meta_range_t>(fe_path / "bandwidth" / "range").set(SIM_BANDWIDTH_RANGE);
+            _tree->create<double>(fe_path / "bandwidth" / "value")
+                .coerce(boost::bind(&meta_range_t::clip, SIM_BANDWIDTH_RANGE, _1, false))
+                .set(SIM_BANDWIDTH_RANGE.stop());
+            _tree->create<std::string>(fe_path / "connection").set("IQ");
+            _tree->create<bool>(fe_path / "enabled").set(true);
+            _tree->create<bool>(fe_path / "use_lo_offset").set(false);
+        }
+
+        ////////////////////////////////////////////////////////////////
+        // create the dsps
+        ////////////////////////////////////////////////////////////////
+        const fs_path rx_dsp_path = mb_path / "rx_dsps" / fe_name;
+        _tree->create<meta_range_t>(rx_dsp_path / "rate" / "range")
+            .publish(boost::bind(&sim_impl::get_host_rates, this));
+        _tree->create<double>(rx_dsp_path / "rate" / "value")
+            .coerce(boost::bind(&sim_impl::set_host_rate, this, _1))
+            .subscribe(boost::bind(&sim_impl::update_rx_samp_rate, this, i, _1))
+            .set(1e6);
+        _tree->create<meta_range_t>(rx_dsp_path / "freq" / "range")
+            .publish(boost::bind(&sim_impl::get_dsp_freq_range, this));
+        _tree->create<double>(rx_dsp_path / "freq" / "value")
+            .coerce(boost::bind(&sim_impl::set_dsp_freq, this, _1))
+            .set(0.0);
+        _tree->create<stream_cmd_t>(rx_dsp_path / "stream_cmd")
+            .subscribe(boost::bind(&sim_impl::issue_stream_command, this, i, _1));
+
+        const fs_path tx_dsp_path = mb_path / "tx_dsps" / fe_name;
+        _tree->create<meta_range_t>(tx_dsp_path / "rate" / "range")
+            .publish(boost::bind(&sim_impl::get_host_rates, this));
+        _tree->create<double>(tx_dsp_path / "rate" / "value")
+            .coerce(boost::bind(&sim_impl::set_host_rate, this, _1))
+            .subscribe(boost::bind(&sim_impl::update_tx_samp_rate, this, i, _1))
+            .set(1e6);
+        _tree->create<meta_range_t>(tx_dsp_path / "freq" / "range")
+            .publish(boost::bind(&sim_impl::get_dsp_freq_range, this));
+        _tree->create<double>(tx_dsp_path / "freq" / "value")
+            .coerce(boost::bind(&sim_impl::set_dsp_freq, this, _1))
+            .set(0.0);
+    }
+
+    ////////////////////////////////////////////////////////////////////
+    // create frontend mapping
+    ////////////////////////////////////////////////////////////////////
+    subdev_spec_t fe_spec;
+    std::vector<size_t> default_map;
+    for (size_t i = 0; i < _num_chans; i++)
+    {
+        fe_spec.push_back(subdev_spec_pair_t("A", boost::lexical_cast<std::string>(i)));
+        default_map.push_back(i);
+    }
+    _tree->create<std::vector<size_t> >(mb_path / "rx_chan_dsp_mapping").set(default_map);
+    _tree->create<std::vector<size_t> >(mb_path / "tx_chan_dsp_mapping").set(default_map);
+    _tree->create<subdev_spec_t>(mb_path / "rx_subdev_spec")
+        .subscribe(boost::bind(&sim_impl::update_subdev_spec, this, "rx", _1))
+        .set(fe_spec);
+    _tree->create<subdev_spec_t>(mb_path / "tx_subdev_spec")
+        .subscribe(boost::bind(&sim_impl::update_subdev_spec, this, "tx", _1))
+        .set(fe_spec);
+}
+
+sim_impl::~sim_impl(void)
+{
+    /* NOP */
+}
+
+/***********************************************************************
+ * Property tree callbacks
+ **********************************************************************/
+meta_range_t sim_impl::get_host_rates(void)
+{
+    meta_range_t range;
+    for (size_t decim = SIM_MAX_DECIM; decim >= 1; decim--)
+    {
+        range.push_back(range_t(_tick_rate/decim));
+    }
+    return range;
+}
+
+double sim_impl::set_host_rate(const double rate)
+{
+    //the sample rate is the tick rate over an integer decimation
+    const size_t decim = size_t(boost::math::iround(_tick_rate/rate));
+    return _tick_rate/std::min(std::max<size_t>(decim, 1), SIM_MAX_DECIM);
+}
+
+meta_range_t sim_impl::get_dsp_freq_range(void)
+{
+    return meta_range_t(-_tick_rate/2, _tick_rate/2, _tick_rate/std::pow(2.0, 32));
+}
+
+double sim_impl::set_dsp_freq(const double freq)
+{
+    return this->get_dsp_freq_range().clip(freq, true);
+}
+
+void sim_impl::update_subdev_spec(const std::string &tx_rx, const subdev_spec_t &spec)
+{
+    UHD_ASSERT_THROW(tx_rx == "tx" or tx_rx == "rx");
+    const fs_path mb_path = "/mboards/0";
+
+    //sanity checking
+    validate_subdev_spec(_tree, spec, tx_rx);
+
+    //every frontend has its own dsp
+    std::vector<size_t> chan_to_dsp_map(spec.size(), 0);
+    for (size_t i = 0; i < spec.size(); i++)
+    {
+        chan_to_dsp_map[i] = boost::lexical_cast<size_t>(spec[i].sd_name);
+    }
+    _tree->access<std::vector<size_t> >(mb_path / (tx_rx + "_chan_dsp_mapping")).set(chan_to_dsp_map);
+}
+
+void sim_impl::issue_stream_command(const size_t dspno, const stream_cmd_t &stream_cmd)
+{
+    if (_rx_xports[dspno]) _rx_xports[dspno]->issue_stream_command(stream_cmd);
+}
+
+sensor_value_t sim_impl::get_ref_locked(void)
+{
+    return sensor_value_t("Ref", true, "locked", "unlocked");
+}
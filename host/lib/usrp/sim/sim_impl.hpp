@@ -0,0 +1,111 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_SIM_IMPL_HPP
+#define INCLUDED_SIM_IMPL_HPP
+
+#include "sim_xports.hpp"
+#include <uhd/property_tree.hpp>
+#include <uhd/device.hpp>
+#include <uhd/types/dict.hpp>
+#include <uhd/types/ranges.hpp>
+#include <uhd/types/sensors.hpp>
+#include <uhd/usrp/subdev_spec.hpp>
+#include <uhd/transport/vrt_if_packet.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <vector>
+
+static const double SIM_DEFAULT_TICK_RATE       = 200e6;        //Hz
+static const size_t SIM_DEFAULT_NUM_CHANS       = 2;
+static const size_t SIM_MAX_DECIM               = 1024;         //lowest rate is tick rate/1024
+
+static const size_t SIM_DATA_FRAME_SIZE         = 8000;         //bytes, like a 10GbE link
+static const size_t SIM_DATA_NUM_FRAMES         = 32;
+static const size_t SIM_RX_SW_BUFF_SIZE         = 0x2000000;    //32MiB of samples before an overflow
+static const size_t SIM_TX_HW_BUFF_SIZE         = 520*1024;     //as the X300 SRAM buffer
+
+static const size_t SIM_TX_MAX_HDR_LEN          =           // bytes
+      sizeof(boost::uint32_t)                              // Header
+    + sizeof(uhd::transport::vrt::if_packet_info_t().sid)  // SID
+    + sizeof(uhd::transport::vrt::if_packet_info_t().tsf); // Timestamp
+static const size_t SIM_RX_MAX_HDR_LEN          =           // bytes
+      sizeof(boost::uint32_t)                              // Header
+    + sizeof(uhd::transport::vrt::if_packet_info_t().sid)  // SID
+    + sizeof(uhd::transport::vrt::if_packet_info_t().tsf); // Timestamp
+
+/*!
+ * The simulated device (type=sim):
+ * A single motherboard with one daughterboard that has
+ * num_chans RX and TX frontends, each with its own DSP.
+ * The data path never leaves the process, the streamers
+ * run over sim transports that play the part of the radio.
+ */
+class sim_impl : public uhd::device
+{
+public:
+    sim_impl(const uhd::device_addr_t &);
+    ~sim_impl(void);
+
+    //the io interface
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t &);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t &);
+
+    //support old async call
+    bool recv_async_msg(uhd::async_metadata_t &, double);
+
+private:
+    uhd::device_addr_t _recv_args, _send_args;
+    boost::mutex _transport_setup_mutex;
+    sim_clock::sptr _clock;
+    sim_async_queue::sptr _async_md;
+    size_t _num_chans;
+    boost::uint32_t _seed;
+    double _tick_rate;
+
+    //the transports of the current streamers, per DSP
+    std::vector<sim_rx_xport::sptr> _rx_xports;
+    std::vector<sim_tx_xport::sptr> _tx_xports;
+    uhd::dict<size_t, boost::weak_ptr<uhd::rx_streamer> > _rx_streamers;
+    uhd::dict<size_t, boost::weak_ptr<uhd::tx_streamer> > _tx_streamers;
+
+    //property tree callbacks
+    uhd::meta_range_t get_host_rates(void);
+    double set_host_rate(const double rate);
+    uhd::meta_range_t get_dsp_freq_range(void);
+    double set_dsp_freq(const double freq);
+    void update_tick_rate(const double rate);
+    void update_rx_samp_rate(const size_t dspno, const double rate);
+    void update_tx_samp_rate(const size_t dspno, const double rate);
+    void update_subdev_spec(const std::string &tx_rx, const uhd::usrp::subdev_spec_t &spec);
+    void issue_stream_command(const size_t dspno, const uhd::stream_cmd_t &stream_cmd);
+    uhd::sensor_value_t get_ref_locked(void);
+
+    //overflow recovery impl
+    void handle_overflow(sim_rx_xport::sptr xport, boost::weak_ptr<uhd::rx_streamer> streamer);
+
+    //async messages of the transmit transports
+    void handle_async_msg(
+        boost::shared_ptr<sim_async_queue> async_queue,
+        const size_t stream_channel,
+        const size_t device_channel,
+        const uhd::async_metadata_t &metadata,
+        const uhd::time_spec_t &release_time
+    );
+};
+
+#endif /* INCLUDED_SIM_IMPL_HPP */
@@ -0,0 +1,328 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_impl.hpp"
+#include "xport_counters.hpp"
+#include "async_packet_handler.hpp"
+#include "../../transport/super_recv_packet_handler.hpp"
+#include "../../transport/super_send_packet_handler.hpp"
+#include <uhd/transport/chdr.hpp>
+#include <uhd/utils/log.hpp>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+
+using namespace uhd;
+using namespace uhd::usrp;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * update streamer rates
+ **********************************************************************/
+void sim_impl::update_tick_rate(const double rate)
+{
+    _tick_rate = rate;
+    for (size_t dspno = 0; dspno < _num_chans; dspno++)
+    {
+        if (_rx_xports[dspno]) _rx_xports[dspno]->set_tick_rate(rate);
+        if (_tx_xports[dspno]) _tx_xports[dspno]->set_tick_rate(rate);
+    }
+    BOOST_FOREACH(const size_t &dspno, _rx_streamers.keys())
+    {
+        boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+            boost::dynamic_pointer_cast<sph::recv_packet_streamer>(_rx_streamers[dspno].lock());
+        if (my_streamer) my_streamer->set_tick_rate(rate);
+    }
+    BOOST_FOREACH(const size_t &dspno, _tx_streamers.keys())
+    {
+        boost::shared_ptr<sph::send_packet_streamer> my_streamer =
+            boost::dynamic_pointer_cast<sph::send_packet_streamer>(_tx_streamers[dspno].lock());
+        if (my_streamer) my_streamer->set_tick_rate(rate);
+    }
+}
+
+void sim_impl::update_rx_samp_rate(const size_t dspno, const double rate)
+{
+    if (_rx_xports[dspno]) _rx_xports[dspno]->set_samp_rate(rate);
+    if (not _rx_streamers.has_key(dspno)) return;
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+        boost::dynamic_pointer_cast<sph::recv_packet_streamer>(_rx_streamers[dspno].lock());
+    if (my_streamer) my_streamer->set_samp_rate(rate);
+}
+
+void sim_impl::update_tx_samp_rate(const size_t dspno, const double rate)
+{
+    if (_tx_xports[dspno]) _tx_xports[dspno]->set_samp_rate(rate);
+    if (not _tx_streamers.has_key(dspno)) return;
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer =
+        boost::dynamic_pointer_cast<sph::send_packet_streamer>(_tx_streamers[dspno].lock());
+    if (my_streamer) my_streamer->set_samp_rate(rate);
+}
+
+/***********************************************************************
+ * Async Data
+ **********************************************************************/
+bool sim_impl::recv_async_msg(
+    async_metadata_t &async_metadata, double timeout
+){
+    return _async_md->pop_with_timed_wait(async_metadata, timeout);
+}
+
+void sim_impl::handle_async_msg(
+    boost::shared_ptr<sim_async_queue> async_queue,
+    const size_t stream_channel,
+    const size_t device_channel,
+    const async_metadata_t &metadata_,
+    const time_spec_t &release_time
+){
+    async_metadata_t metadata = metadata_;
+    metadata.channel = stream_channel;
+    async_queue->push(metadata, release_time);
+    metadata.channel = device_channel;
+    _async_md->push(metadata, release_time);
+    standard_async_msg_prints(metadata);
+}
+
+/***********************************************************************
+ * Receive streamer
+ **********************************************************************/
+rx_streamer::sptr sim_impl::get_rx_stream(const uhd::stream_args_t &args_)
+{
+    boost::mutex::scoped_lock lock(_transport_setup_mutex);
+    stream_args_t args = args_;
+
+    //setup defaults for unspecified values
+    if (not args.otw_format.empty() and args.otw_format != "sc16")
+    {
+        throw uhd::value_error("sim_impl::get_rx_stream only supports otw_format sc16");
+    }
+    args.otw_format = "sc16";
+    args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+
+    const fs_path mb_path = "/mboards/0";
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer;
+    for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
+    {
+        // Find the DSP that corresponds to this channel
+        const size_t chan = args.channels[stream_i];
+        const std::vector<size_t> dsp_map = _tree->access<std::vector<size_t> >(mb_path / "rx_chan_dsp_mapping").get();
+        if (chan >= dsp_map.size()) throw uhd::index_error(str(
+            boost::format("sim_impl::get_rx_stream - there is no RX channel %u") % chan
+        ));
+        const size_t dspno = dsp_map[chan];
+
+        //setup the transport hints (default to a large recv buff)
+        device_addr_t device_addr = _recv_args;
+        if (not device_addr.has_key("recv_buff_size"))
+        {
+            device_addr["recv_buff_size"] = boost::lexical_cast<std::string>(SIM_RX_SW_BUFF_SIZE);
+        }
+        device_addr["seed"] = boost::lexical_cast<std::string>(_seed + dspno); //channels drop differently
+
+        zero_copy_xport_params default_buff_args;
+        default_buff_args.recv_frame_size = device_addr.cast<size_t>("recv_frame_size", SIM_DATA_FRAME_SIZE);
+        default_buff_args.num_recv_frames = device_addr.cast<size_t>("num_recv_frames", SIM_DATA_NUM_FRAMES);
+        default_buff_args.send_frame_size = 0;
+        default_buff_args.num_send_frames = 0;
+
+        UHD_LOG << "creating rx stream " << device_addr.to_string() << std::endl;
+        sim_rx_xport::sptr xport = sim_rx_xport::make(_clock, default_buff_args, device_addr);
+        _rx_xports[dspno] = xport;
+        publish_xport_counters(_tree, mb_path / "xports" / str(boost::format("rx%d") % dspno), xport);
+
+        // To calculate the max number of samples per packet, we assume the maximum header length
+        // to avoid fragmentation should the entire header be used.
+        const size_t bpp = xport->get_recv_frame_size() - SIM_RX_MAX_HDR_LEN; // bytes per packet
+        const size_t bpi = convert::get_bytes_per_item(args.otw_format); // bytes per item
+        const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi)); // samples per packet
+
+        //make the new streamer given the samples per packet
+        if (not my_streamer) my_streamer = boost::make_shared<sph::recv_packet_streamer>(spp);
+        my_streamer->resize(args.channels.size());
+        my_streamer->set_vrt_unpacker(&vrt::chdr::if_hdr_unpack_be);
+
+        //set the converter
+        uhd::convert::id_type id;
+        id.input_format = args.otw_format + "_item32_be";
+        id.num_inputs = 1;
+        id.output_format = args.cpu_format;
+        id.num_outputs = 1;
+        my_streamer->set_converter(id, args.args);
+
+        xport->set_nsamps_per_packet(spp);
+        xport->set_sid(boost::uint32_t(dspno));
+
+        //Give the streamer a functor to get the recv_buffer
+        //bind requires a zero_copy_if::sptr to add a streamer->xport lifetime dependency
+        my_streamer->set_xport_chan_get_buff(
+            stream_i,
+            boost::bind(&zero_copy_if::get_recv_buff, xport, _1),
+            true /*flush*/
+        );
+        //Give the streamer a functor to handle overflows
+        //bind requires a weak_ptr to break the a streamer->streamer circular dependency
+        //Using "this" is OK because we know that sim_impl will outlive the streamer
+        my_streamer->set_overflow_handler(
+            stream_i,
+            boost::bind(&sim_impl::handle_overflow, this, xport, boost::weak_ptr<uhd::rx_streamer>(my_streamer))
+        );
+        //Give the streamer a functor issue stream cmd
+        my_streamer->set_issue_stream_cmd(
+            stream_i, boost::bind(&sim_rx_xport::issue_stream_command, xport, _1)
+        );
+
+        //Store a weak pointer to prevent a streamer->sim_impl->streamer circular dependency
+        _rx_streamers[dspno] = boost::weak_ptr<sph::recv_packet_streamer>(my_streamer);
+
+        //sets all tick and samp rates on this streamer
+        _tree->access<double>(mb_path / "tick_rate").update();
+        _tree->access<double>(mb_path / "rx_dsps" / boost::lexical_cast<std::string>(dspno) / "rate" / "value").update();
+    }
+
+    return my_streamer;
+}
+
+void sim_impl::handle_overflow(sim_rx_xport::sptr xport, boost::weak_ptr<uhd::rx_streamer> streamer)
+{
+    boost::shared_ptr<sph::recv_packet_streamer> my_streamer =
+            boost::dynamic_pointer_cast<sph::recv_packet_streamer>(streamer.lock());
+    if (not my_streamer) return; //If the rx_streamer has expired then overflow handling makes no sense.
+
+    if (my_streamer->get_num_channels() == 1)
+    {
+        xport->handle_overflow();
+        return;
+    }
+
+    /////////////////////////////////////////////////////////////
+    // MIMO overflow recovery time
+    /////////////////////////////////////////////////////////////
+    //find out if we were in continuous mode before stopping
+    const bool in_continuous_streaming_mode = xport->in_continuous_streaming_mode();
+    //stop streaming
+    my_streamer->issue_stream_cmd(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    //flush transports
+    my_streamer->flush_all(0.001);
+    //restart streaming
+    if (in_continuous_streaming_mode)
+    {
+        stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+        stream_cmd.stream_now = false;
+        stream_cmd.time_spec = _clock->get_time_now() + time_spec_t(0.01);
+        my_streamer->issue_stream_cmd(stream_cmd);
+    }
+}
+
+/***********************************************************************
+ * Transmit streamer
+ **********************************************************************/
+tx_streamer::sptr sim_impl::get_tx_stream(const uhd::stream_args_t &args_)
+{
+    boost::mutex::scoped_lock lock(_transport_setup_mutex);
+    stream_args_t args = args_;
+
+    //setup defaults for unspecified values
+    if (not args.otw_format.empty() and args.otw_format != "sc16")
+    {
+        throw uhd::value_error("sim_impl::get_tx_stream only supports otw_format sc16");
+    }
+    args.otw_format = "sc16";
+    args.channels = args.channels.empty()? std::vector<size_t>(1, 0) : args.channels;
+
+    //shared async queue for all channels in streamer
+    boost::shared_ptr<sim_async_queue> async_md = sim_async_queue::make(_clock, 1000/*messages deep*/);
+
+    const fs_path mb_path = "/mboards/0";
+    boost::shared_ptr<sph::send_packet_streamer> my_streamer;
+    for (size_t stream_i = 0; stream_i < args.channels.size(); stream_i++)
+    {
+        // Find the DSP that corresponds to this channel
+        const size_t chan = args.channels[stream_i];
+        const std::vector<size_t> dsp_map = _tree->access<std::vector<size_t> >(mb_path / "tx_chan_dsp_mapping").get();
+        if (chan >= dsp_map.size()) throw uhd::index_error(str(
+            boost::format("sim_impl::get_tx_stream - there is no TX channel %u") % chan
+        ));
+        const size_t dspno = dsp_map[chan];
+
+        //setup the transport hints (default to the X300 buffering)
+        device_addr_t device_addr = _send_args;
+        if (not device_addr.has_key("send_buff_size"))
+        {
+            device_addr["send_buff_size"] = boost::lexical_cast<std::string>(SIM_TX_HW_BUFF_SIZE);
+        }
+
+        zero_copy_xport_params default_buff_args;
+        default_buff_args.recv_frame_size = 0;
+        default_buff_args.num_recv_frames = 0;
+        default_buff_args.send_frame_size = device_addr.cast<size_t>("send_frame_size", SIM_DATA_FRAME_SIZE);
+        default_buff_args.num_send_frames = device_addr.cast<size_t>("num_send_frames", SIM_DATA_NUM_FRAMES);
+
+        UHD_LOG << "creating tx stream " << device_addr.to_string() << std::endl;
+        sim_tx_xport::sptr xport = sim_tx_xport::make(_clock, default_buff_args, device_addr);
+        _tx_xports[dspno] = xport;
+        publish_xport_counters(_tree, mb_path / "xports" / str(boost::format("tx%d") % dspno), xport);
+
+        // To calculate the max number of samples per packet, we assume the maximum header length
+        // to avoid fragmentation should the entire header be used.
+        const size_t bpp = xport->get_send_frame_size() - SIM_TX_MAX_HDR_LEN;
+        const size_t bpi = convert::get_bytes_per_item(args.otw_format);
+        const size_t spp = unsigned(args.args.cast<double>("spp", bpp/bpi));
+
+        //make the new streamer given the samples per packet
+        if (not my_streamer) my_streamer = boost::make_shared<sph::send_packet_streamer>(spp);
+        my_streamer->resize(args.channels.size());
+        my_streamer->set_vrt_packer(&vrt::chdr::if_hdr_pack_be);
+
+        //set the converter
+        uhd::convert::id_type id;
+        id.input_format = args.cpu_format;
+        id.num_inputs = 1;
+        id.output_format = args.otw_format + "_item32_be";
+        id.num_outputs = 1;
+        my_streamer->set_converter(id, args.args);
+
+        //Give the transport a functor to report the async messages
+        //Using "this" is OK because we know that sim_impl will outlive the streamer
+        xport->set_async_handler(
+            boost::bind(&sim_impl::handle_async_msg, this, async_md, stream_i, chan, _1, _2)
+        );
+
+        //Give the streamer a functor to get the send buffer
+        //xport (sptr) is required to add streamer->data-transport lifetime dependency
+        my_streamer->set_xport_chan_get_buff(
+            stream_i,
+            boost::bind(&zero_copy_if::get_send_buff, xport, _1)
+        );
+        //Give the streamer a functor handled received async messages
+        my_streamer->set_async_receiver(
+            boost::bind(&sim_async_queue::pop_with_timed_wait, async_md, _1, _2)
+        );
+        my_streamer->set_xport_chan_sid(stream_i, true, boost::uint32_t(dspno));
+        my_streamer->set_enable_trailer(false);
+
+        //Store a weak pointer to prevent a streamer->sim_impl->streamer circular dependency
+        _tx_streamers[dspno] = boost::weak_ptr<sph::send_packet_streamer>(my_streamer);
+
+        //sets all tick and samp rates on this streamer
+        _tree->access<double>(mb_path / "tick_rate").update();
+        _tree->access<double>(mb_path / "tx_dsps" / boost::lexical_cast<std::string>(dspno) / "rate" / "value").update();
+    }
+
+    return my_streamer;
+}
@@ -0,0 +1,758 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "sim_xports.hpp"
+#include "../../transport/zero_copy_counters.hpp"
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/transport/chdr.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/utils/msg.hpp>
+#include <boost/bind.hpp>
+#include <boost/format.hpp>
+#include <boost/function.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/math/special_functions/round.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <utility>
+#include <map>
+#include <vector>
+
+using namespace uhd;
+using namespace uhd::transport;
+
+static const size_t SIM_HDR_WORDS32 = 4; //header, sid and 64-bit timestamp
+static const boost::int16_t SIM_TONE_AMPL = 0x2000;
+
+static boost::posix_time::time_duration to_duration(const double secs){
+    return boost::posix_time::microseconds(long(std::ceil(secs*1e6)));
+}
+
+static boost::int64_t get_ticks_per_samp(const double tick_rate, const double samp_rate){
+    return std::max<boost::int64_t>(1, boost::math::llround(tick_rate/samp_rate));
+}
+
+/***********************************************************************
+ * Device clock
+ **********************************************************************/
+class sim_clock_impl : public sim_clock{
+public:
+    sim_clock_impl(void):
+        _offset(time_spec_t::get_system_time())
+    {
+        /* NOP */
+    }
+
+    time_spec_t get_time_now(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return time_spec_t::get_system_time() - _offset;
+    }
+
+    time_spec_t get_time_last_pps(void){
+        return time_spec_t(this->get_time_now().get_full_secs());
+    }
+
+    void set_time_now(const time_spec_t &time){
+        boost::mutex::scoped_lock lock(_mutex);
+        _offset = time_spec_t::get_system_time() - time;
+    }
+
+    void set_time_next_pps(const time_spec_t &time){
+        boost::mutex::scoped_lock lock(_mutex);
+        const time_spec_t system_time = time_spec_t::get_system_time();
+        const time_spec_t now = system_time - _offset;
+        //the device time is the new time on the next whole second
+        const time_spec_t to_next_pps = time_spec_t(now.get_full_secs() + 1) - now;
+        _offset = system_time + to_next_pps - time;
+    }
+
+private:
+    boost::mutex _mutex;
+    time_spec_t _offset;
+};
+
+sim_clock::sptr sim_clock::make(void){
+    return sptr(new sim_clock_impl());
+}
+
+/***********************************************************************
+ * Async message queue
+ **********************************************************************/
+class sim_async_queue_impl : public sim_async_queue{
+public:
+    sim_async_queue_impl(sim_clock::sptr clock, const size_t capacity):
+        _clock(clock), _capacity(capacity)
+    {
+        /* NOP */
+    }
+
+    void push(const async_metadata_t &metadata, const time_spec_t &release_time){
+        boost::mutex::scoped_lock lock(_mutex);
+        _queue.insert(std::make_pair(release_time, metadata));
+        if (_queue.size() > _capacity) _queue.erase(_queue.begin()); //pop on full
+        lock.unlock();
+        _cond.notify_one();
+    }
+
+    bool pop_with_timed_wait(async_metadata_t &metadata, const double timeout){
+        boost::mutex::scoped_lock lock(_mutex);
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        while (true){
+            double wait_time = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+            if (not _queue.empty()){
+                const time_spec_t to_release = _queue.begin()->first - _clock->get_time_now();
+                if (to_release <= time_spec_t(0.0)){
+                    metadata = _queue.begin()->second;
+                    _queue.erase(_queue.begin());
+                    return true;
+                }
+                wait_time = std::min(wait_time, to_release.get_real_secs());
+            }
+            if (wait_time <= 0.0) return false;
+            _cond.timed_wait(lock, to_duration(wait_time));
+        }
+    }
+
+private:
+    sim_clock::sptr _clock;
+    const size_t _capacity;
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    std::multimap<time_spec_t, async_metadata_t> _queue;
+};
+
+sim_async_queue::sptr sim_async_queue::make(sim_clock::sptr clock, const size_t capacity){
+    return sptr(new sim_async_queue_impl(clock, capacity));
+}
+
+/***********************************************************************
+ * Receive transport
+ **********************************************************************/
+class sim_rx_mrb : public managed_recv_buffer{
+public:
+    sim_rx_mrb(void *mem, atomic_zero_copy_counters &counters):
+        payload_dirty(true), _mem(mem), _counters(counters)
+    {
+        /* NOP */
+    }
+
+    void release(void){
+        count_recv_release(_counters);
+        _claimer.release();
+    }
+
+    UHD_INLINE bool claim(const double timeout){
+        return claim_with_counted_wait(_claimer, timeout, _counters.recv_wait_time);
+    }
+
+    UHD_INLINE void unclaim(void){
+        _claimer.release();
+    }
+
+    UHD_INLINE sptr get_new(const size_t len){
+        return make(this, _mem, len);
+    }
+
+    UHD_INLINE boost::uint32_t *mem(void){
+        return static_cast<boost::uint32_t *>(_mem);
+    }
+
+    bool payload_dirty; //!< the payload does not hold the sample pattern
+
+private:
+    void *_mem;
+    atomic_zero_copy_counters &_counters;
+    simple_claimer _claimer;
+};
+
+class sim_rx_xport_impl : public sim_rx_xport{
+public:
+    sim_rx_xport_impl(
+        sim_clock::sptr clock,
+        const zero_copy_xport_params &params,
+        const device_addr_t &hints
+    ):
+        _clock(clock),
+        _recv_frame_size(params.recv_frame_size),
+        _num_recv_frames(params.num_recv_frames),
+        _buffer_pool(buffer_pool::make(params.num_recv_frames, params.recv_frame_size, hints)),
+        _next_recv_buff_index(0),
+        _deferred_buff(NULL), _deferred_len(0),
+        _tick_rate(1.0), _samp_rate(1.0), _ticks_per_samp(1),
+        _spp((params.recv_frame_size/sizeof(boost::uint32_t)) - SIM_HDR_WORDS32),
+        _sid(0),
+        _buff_samps(hints.cast<size_t>("recv_buff_size", params.num_recv_frames*params.recv_frame_size)/sizeof(boost::uint32_t)),
+        _streaming(false), _continuous(false), _chain(false),
+        _ticks(0), _samps_left(0), _seq(0),
+        _error_code(0), _error_ticks(0),
+        _drop_rate(hints.cast<double>("drop_rate", 0.0)),
+        _reorder_rate(hints.cast<double>("reorder_rate", 0.0)),
+        _rng(hints.cast<boost::uint32_t>("seed", 0))
+    {
+        UHD_ASSERT_THROW(_recv_frame_size > SIM_HDR_WORDS32*sizeof(boost::uint32_t) + 2*sizeof(boost::uint32_t));
+        for (size_t i = 0; i < _num_recv_frames; i++){
+            _mrb_pool.push_back(boost::make_shared<sim_rx_mrb>(_buffer_pool->at(i), boost::ref(_counters)));
+        }
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     * A packet that was held back for reordering goes out first,
+     * else the next packet is produced into the next claimed frame.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double timeout){
+        managed_recv_buffer::sptr buff = this->get_next_recv_buff(timeout);
+        count_recv_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_recv_buffer::sptr get_next_recv_buff(const double timeout){
+        if (_deferred_buff != NULL){
+            sim_rx_mrb *buff = _deferred_buff;
+            _deferred_buff = NULL;
+            return buff->get_new(_deferred_len);
+        }
+
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        sim_rx_mrb *buff = this->claim_next_buff(timeout);
+        if (buff == NULL) return managed_recv_buffer::sptr();
+        bool reorder = false;
+        const size_t len = this->produce(*buff, exit_time, reorder);
+        if (len == 0){
+            buff->unclaim();
+            return managed_recv_buffer::sptr();
+        }
+
+        //injected reordering: the following packet goes out first
+        if (reorder){
+            const double next_timeout = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+            sim_rx_mrb *next_buff = this->claim_next_buff(std::max(next_timeout, 0.0));
+            if (next_buff != NULL){
+                bool unused = false;
+                const size_t next_len = this->produce(*next_buff, exit_time, unused);
+                if (next_len != 0){
+                    _deferred_buff = buff;
+                    _deferred_len = len;
+                    return next_buff->get_new(next_len);
+                }
+                next_buff->unclaim();
+            }
+        }
+        return buff->get_new(len);
+    }
+
+    size_t get_num_recv_frames(void) const {return _num_recv_frames;}
+    size_t get_recv_frame_size(void) const {return _recv_frame_size;}
+
+    /*******************************************************************
+     * Send implementation:
+     * The simulated radio takes no flow control packets.
+     ******************************************************************/
+    managed_send_buffer::sptr get_send_buff(double){
+        return managed_send_buffer::sptr();
+    }
+
+    size_t get_num_send_frames(void) const {return 0;}
+    size_t get_send_frame_size(void) const {return 0;}
+
+    zero_copy_counters get_counters(void) const {return _counters.snapshot();}
+
+    /*******************************************************************
+     * Framer controls
+     ******************************************************************/
+    void set_tick_rate(const double rate){
+        boost::mutex::scoped_lock lock(_mutex);
+        _tick_rate = rate;
+        _ticks_per_samp = get_ticks_per_samp(_tick_rate, _samp_rate);
+    }
+
+    void set_samp_rate(const double rate){
+        boost::mutex::scoped_lock lock(_mutex);
+        _samp_rate = rate;
+        _ticks_per_samp = get_ticks_per_samp(_tick_rate, _samp_rate);
+    }
+
+    void set_nsamps_per_packet(const size_t nsamps){
+        boost::mutex::scoped_lock lock(_mutex);
+        const size_t max_nsamps = (_recv_frame_size/sizeof(boost::uint32_t)) - SIM_HDR_WORDS32;
+        if (nsamps == 0 or nsamps > max_nsamps) throw uhd::value_error(str(boost::format(
+            "sim_rx_xport: %u samples per packet do not fit a %u byte frame"
+        ) % nsamps % _recv_frame_size));
+        _spp = nsamps;
+    }
+
+    void set_sid(const boost::uint32_t sid){
+        boost::mutex::scoped_lock lock(_mutex);
+        _sid = sid;
+    }
+
+    void issue_stream_command(const stream_cmd_t &stream_cmd){
+        boost::mutex::scoped_lock lock(_mutex);
+        if (stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS){
+            _cmds.clear();
+            _streaming = false;
+            _continuous = false;
+            _chain = false;
+            _ticks = this->get_ticks_now();
+        }
+        else _cmds.push_back(std::make_pair(stream_cmd, this->get_ticks_now()));
+        lock.unlock();
+        _cond.notify_one();
+    }
+
+    void handle_overflow(void){
+        if (this->in_continuous_streaming_mode()){
+            this->issue_stream_command(stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+        }
+    }
+
+    bool in_continuous_streaming_mode(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        return _continuous;
+    }
+
+private:
+    sim_clock::sptr _clock;
+    const size_t _recv_frame_size, _num_recv_frames;
+    buffer_pool::sptr _buffer_pool;
+    std::vector<boost::shared_ptr<sim_rx_mrb> > _mrb_pool;
+    size_t _next_recv_buff_index;
+    sim_rx_mrb *_deferred_buff;
+    size_t _deferred_len;
+    atomic_zero_copy_counters _counters;
+
+    boost::mutex _mutex;
+    boost::condition_variable _cond;
+    double _tick_rate, _samp_rate;
+    boost::int64_t _ticks_per_samp;
+    size_t _spp;
+    boost::uint32_t _sid;
+    const size_t _buff_samps;
+
+    //streaming state
+    std::deque<std::pair<stream_cmd_t, boost::int64_t> > _cmds; //with the time of arrival
+    bool _streaming, _continuous, _chain;
+    boost::int64_t _ticks; //time of the next sample
+    size_t _samps_left;
+    size_t _seq;
+    boost::uint32_t _error_code;
+    boost::int64_t _error_ticks;
+
+    //injected link errors
+    const double _drop_rate, _reorder_rate;
+    boost::mt19937 _rng;
+
+    UHD_INLINE sim_rx_mrb *claim_next_buff(const double timeout){
+        sim_rx_mrb *buff = _mrb_pool[_next_recv_buff_index].get();
+        if (not buff->claim(timeout)) return NULL;
+        if (++_next_recv_buff_index == _num_recv_frames) _next_recv_buff_index = 0;
+        return buff;
+    }
+
+    UHD_INLINE boost::int64_t get_ticks_now(void){
+        return _clock->get_time_now().to_ticks(_tick_rate);
+    }
+
+    UHD_INLINE double roll(void){
+        return double(_rng() - _rng.min())/(double(_rng.max() - _rng.min()) + 1.0);
+    }
+
+    //! Wait up to wait_time for a stream command, false when the exit time passed
+    bool wait(boost::mutex::scoped_lock &lock, const time_spec_t &exit_time, const double wait_time){
+        const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+        if (remaining <= 0.0) return false;
+        _cond.timed_wait(lock, to_duration(std::min(wait_time, remaining)));
+        return true;
+    }
+
+    void start_command(void){
+        const stream_cmd_t stream_cmd = _cmds.front().first;
+        //the command takes effect on arrival or after the previous one,
+        //not when the consumer gets around to this channel
+        //(an end in the future is left over from a time reset)
+        const boost::int64_t arrival_ticks = _cmds.front().second;
+        const boost::int64_t active_ticks = (_ticks > arrival_ticks and _ticks <= this->get_ticks_now())? _ticks : arrival_ticks;
+        _cmds.pop_front();
+
+        //a chained command continues with the next sample
+        boost::int64_t start_ticks = _chain? _ticks : active_ticks;
+        if (not stream_cmd.stream_now){
+            start_ticks = stream_cmd.time_spec.to_ticks(_tick_rate);
+            if (start_ticks < active_ticks){
+                _chain = false;
+                _error_code = rx_metadata_t::ERROR_CODE_LATE_COMMAND;
+                _error_ticks = active_ticks;
+                return;
+            }
+        }
+
+        _streaming = true;
+        _continuous = stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_START_CONTINUOUS;
+        _chain = stream_cmd.stream_mode == stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_MORE;
+        _samps_left = stream_cmd.num_samps;
+        _ticks = start_ticks;
+        if (not _continuous and _samps_left == 0) this->end_command();
+    }
+
+    void end_command(void){
+        _streaming = false;
+        if (_chain and _cmds.empty()){
+            _chain = false;
+            _error_code = rx_metadata_t::ERROR_CODE_BROKEN_CHAIN;
+            _error_ticks = _ticks;
+        }
+    }
+
+    size_t pack_error(sim_rx_mrb &buff){
+        vrt::if_packet_info_t if_packet_info;
+        if_packet_info.link_type = vrt::if_packet_info_t::LINK_TYPE_CHDR;
+        if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_ERROR;
+        if_packet_info.error = true;
+        if_packet_info.num_payload_words32 = 2;
+        if_packet_info.num_payload_bytes = if_packet_info.num_payload_words32*sizeof(boost::uint32_t);
+        if_packet_info.packet_count = _seq; //the data sequence goes on
+        if_packet_info.has_sid = true;
+        if_packet_info.sid = _sid;
+        if_packet_info.has_tsf = true;
+        if_packet_info.tsf = boost::uint64_t(_error_ticks);
+
+        boost::uint32_t *pkt = buff.mem();
+        vrt::chdr::if_hdr_pack_be(pkt, if_packet_info);
+        pkt[if_packet_info.num_header_words32+0] = uhd::htonx<boost::uint32_t>(_error_code);
+        pkt[if_packet_info.num_header_words32+1] = uhd::htonx<boost::uint32_t>(boost::uint32_t(_seq));
+        buff.payload_dirty = true;
+        _error_code = 0;
+        return if_packet_info.num_packet_words32*sizeof(boost::uint32_t);
+    }
+
+    size_t pack_data(sim_rx_mrb &buff, const size_t nsamps, const bool eob){
+        vrt::if_packet_info_t if_packet_info;
+        if_packet_info.link_type = vrt::if_packet_info_t::LINK_TYPE_CHDR;
+        if_packet_info.packet_type = vrt::if_packet_info_t::PACKET_TYPE_DATA;
+        if_packet_info.num_payload_words32 = nsamps;
+        if_packet_info.num_payload_bytes = nsamps*sizeof(boost::uint32_t);
+        if_packet_info.packet_count = _seq;
+        if_packet_info.eob = eob;
+        if_packet_info.has_sid = true;
+        if_packet_info.sid = _sid;
+        if_packet_info.has_tsf = true;
+        if_packet_info.tsf = boost::uint64_t(_ticks);
+
+        boost::uint32_t *pkt = buff.mem();
+        vrt::chdr::if_hdr_pack_be(pkt, if_packet_info);
+
+        //the payload is a quarter rate tone, written once per frame
+        if (buff.payload_dirty){
+            const size_t num_words = _recv_frame_size/sizeof(boost::uint32_t);
+            for (size_t i = SIM_HDR_WORDS32; i < num_words; i++){
+                const size_t k = i - SIM_HDR_WORDS32;
+                const boost::int16_t re = (k%4 == 0)? SIM_TONE_AMPL : ((k%4 == 2)? -SIM_TONE_AMPL : 0);
+                const boost::int16_t im = (k%4 == 1)? SIM_TONE_AMPL : ((k%4 == 3)? -SIM_TONE_AMPL : 0);
+                pkt[i] = uhd::htonx<boost::uint32_t>((boost::uint32_t(boost::uint16_t(re)) << 16) | boost::uint16_t(im));
+            }
+            buff.payload_dirty = false;
+        }
+        return if_packet_info.num_packet_words32*sizeof(boost::uint32_t);
+    }
+
+    /*!
+     * Produce the next packet into the buffer:
+     * Wait until the device sampled the packet or the exit time.
+     * \return the packet length in bytes, 0 for a timeout
+     */
+    size_t produce(sim_rx_mrb &buff, const time_spec_t &exit_time, bool &reorder){
+        boost::mutex::scoped_lock lock(_mutex);
+        while (true){
+            //error reports go out before further data
+            if (_error_code != 0) return this->pack_error(buff);
+
+            if (not _streaming){
+                if (not _cmds.empty()) this->start_command();
+                else if (not this->wait(lock, exit_time, (exit_time - time_spec_t::get_system_time()).get_real_secs())) return 0;
+                continue;
+            }
+
+            const size_t nsamps = _continuous? _spp : std::min(_spp, _samps_left);
+            const boost::int64_t end_ticks = _ticks + boost::int64_t(nsamps)*_ticks_per_samp;
+            const boost::int64_t now_ticks = this->get_ticks_now();
+
+            //the device has not sampled the packet yet
+            if (now_ticks < end_ticks){
+                if (not this->wait(lock, exit_time, double(end_ticks - now_ticks)/_tick_rate)) return 0;
+                continue;
+            }
+
+            //the consumer fell behind by more than the receive buffer
+            if (now_ticks - end_ticks > boost::int64_t(_buff_samps)*_ticks_per_samp){
+                _streaming = false;
+                _chain = false;
+                _cmds.clear();
+                _error_code = rx_metadata_t::ERROR_CODE_OVERFLOW;
+                _error_ticks = _ticks = now_ticks;
+                continue;
+            }
+
+            const bool more = _continuous or _samps_left > nsamps;
+            const bool drop = _drop_rate > 0.0 and this->roll() < _drop_rate;
+            const size_t len = drop? 0 : this->pack_data(buff, nsamps, not more and not _chain);
+
+            _seq = (_seq + 1) & 0xfff;
+            _ticks = end_ticks;
+            if (not _continuous){
+                _samps_left -= nsamps;
+                if (_samps_left == 0) this->end_command();
+            }
+
+            //injected drops: the packet is lost on the link
+            if (drop) continue;
+            reorder = more and _reorder_rate > 0.0 and this->roll() < _reorder_rate;
+            return len;
+        }
+    }
+};
+
+sim_rx_xport::sptr sim_rx_xport::make(
+    sim_clock::sptr clock,
+    const zero_copy_xport_params &params,
+    const device_addr_t &hints
+){
+    return sptr(new sim_rx_xport_impl(clock, params, hints));
+}
+
+/***********************************************************************
+ * Transmit transport
+ **********************************************************************/
+class sim_tx_msb : public managed_send_buffer{
+public:
+    typedef boost::function<void(const boost::uint32_t *, const size_t)> consume_type;
+
+    sim_tx_msb(void *mem, const size_t frame_size, const consume_type &consume, atomic_zero_copy_counters &counters):
+        _mem(mem), _frame_size(frame_size), _consume(consume), _counters(counters)
+    {
+        /* NOP */
+    }
+
+    void release(void){
+        if (size() != 0){
+            count_send_commit(_counters, size());
+            _consume(static_cast<const boost::uint32_t *>(_mem), size());
+        }
+        _claimer.release();
+    }
+
+    UHD_INLINE sptr get_new(const double timeout, size_t &index){
+        if (not claim_with_counted_wait(_claimer, timeout, _counters.send_wait_time)) return sptr();
+        index++; //advances the caller's buffer
+        return make(this, _mem, _frame_size);
+    }
+
+private:
+    void *_mem;
+    const size_t _frame_size;
+    consume_type _consume;
+    atomic_zero_copy_counters &_counters;
+    simple_claimer _claimer;
+};
+
+class sim_tx_xport_impl : public sim_tx_xport{
+public:
+    sim_tx_xport_impl(
+        sim_clock::sptr clock,
+        const zero_copy_xport_params &params,
+        const device_addr_t &hints
+    ):
+        _clock(clock),
+        _send_frame_size(params.send_frame_size),
+        _num_send_frames(params.num_send_frames),
+        _buffer_pool(buffer_pool::make(params.num_send_frames, params.send_frame_size, hints)),
+        _next_send_buff_index(0),
+        _tick_rate(1.0), _samp_rate(1.0), _ticks_per_samp(1),
+        _buff_samps(hints.cast<size_t>("send_buff_size", params.num_send_frames*params.send_frame_size)/sizeof(boost::uint32_t)),
+        _seq(0), _in_burst(false), _late(false),
+        _start_ticks(0), _end_ticks(0)
+    {
+        for (size_t i = 0; i < _num_send_frames; i++){
+            _msb_pool.push_back(boost::make_shared<sim_tx_msb>(
+                _buffer_pool->at(i), _send_frame_size,
+                boost::bind(&sim_tx_xport_impl::consume, this, _1, _2), boost::ref(_counters)
+            ));
+        }
+    }
+
+    /*******************************************************************
+     * Receive implementation:
+     * The async messages go to the async handler instead.
+     ******************************************************************/
+    managed_recv_buffer::sptr get_recv_buff(double){
+        return managed_recv_buffer::sptr();
+    }
+
+    size_t get_num_recv_frames(void) const {return 0;}
+    size_t get_recv_frame_size(void) const {return 0;}
+
+    /*******************************************************************
+     * Send implementation:
+     * Wait until the send buffer has room, then claim the next frame.
+     ******************************************************************/
+    managed_send_buffer::sptr get_send_buff(double timeout){
+        managed_send_buffer::sptr buff = this->get_next_send_buff(timeout);
+        count_send_buff(_counters, buff);
+        return buff;
+    }
+
+    managed_send_buffer::sptr get_next_send_buff(const double timeout){
+        const time_spec_t exit_time = time_spec_t::get_system_time() + time_spec_t(timeout);
+        while (true){
+            const double wait_time = this->get_time_to_room();
+            if (wait_time <= 0.0) break;
+            const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+            if (remaining <= 0.0) return managed_send_buffer::sptr();
+            counted_wait wait(_counters.send_wait_time);
+            boost::this_thread::sleep(to_duration(std::min(wait_time, remaining)));
+        }
+
+        const double remaining = (exit_time - time_spec_t::get_system_time()).get_real_secs();
+        if (_next_send_buff_index == _num_send_frames) _next_send_buff_index = 0;
+        return _msb_pool[_next_send_buff_index]->get_new(std::max(remaining, 0.0), _next_send_buff_index);
+    }
+
+    size_t get_num_send_frames(void) const {return _num_send_frames;}
+    size_t get_send_frame_size(void) const {return _send_frame_size;}
+
+    zero_copy_counters get_counters(void) const {return _counters.snapshot();}
+
+    /*******************************************************************
+     * Deframer controls
+     ******************************************************************/
+    void set_tick_rate(const double rate){
+        boost::mutex::scoped_lock lock(_mutex);
+        _tick_rate = rate;
+        _ticks_per_samp = get_ticks_per_samp(_tick_rate, _samp_rate);
+    }
+
+    void set_samp_rate(const double rate){
+        boost::mutex::scoped_lock lock(_mutex);
+        _samp_rate = rate;
+        _ticks_per_samp = get_ticks_per_samp(_tick_rate, _samp_rate);
+    }
+
+    void set_async_handler(const async_handler_type &handler){
+        boost::mutex::scoped_lock lock(_mutex);
+        _async_handler = handler;
+    }
+
+private:
+    sim_clock::sptr _clock;
+    const size_t _send_frame_size, _num_send_frames;
+    buffer_pool::sptr _buffer_pool;
+    std::vector<boost::shared_ptr<sim_tx_msb> > _msb_pool;
+    size_t _next_send_buff_index;
+    atomic_zero_copy_counters _counters;
+
+    boost::mutex _mutex;
+    double _tick_rate, _samp_rate;
+    boost::int64_t _ticks_per_samp;
+    const size_t _buff_samps;
+    async_handler_type _async_handler;
+
+    //playback state
+    size_t _seq;
+    bool _in_burst, _late;
+    boost::int64_t _start_ticks, _end_ticks; //the samples in the send buffer
+
+    //! Get the seconds until the send buffer has room for another frame
+    double get_time_to_room(void){
+        boost::mutex::scoped_lock lock(_mutex);
+        const boost::int64_t now_ticks = _clock->get_time_now().to_ticks(_tick_rate);
+        const boost::int64_t buffered_ticks = _end_ticks - std::max(now_ticks, _start_ticks);
+        return double(buffered_ticks - boost::int64_t(_buff_samps)*_ticks_per_samp)/_tick_rate;
+    }
+
+    void report(const async_metadata_t::event_code_t event_code, const boost::int64_t event_ticks, const boost::int64_t release_ticks){
+        if (not _async_handler) return;
+        async_metadata_t metadata;
+        metadata.channel = 0;
+        metadata.has_time_spec = true;
+        metadata.time_spec = time_spec_t::from_ticks(event_ticks, _tick_rate);
+        metadata.event_code = event_code;
+        std::fill(metadata.user_payload, metadata.user_payload + 4, 0);
+        _async_handler(metadata, time_spec_t::from_ticks(release_ticks, _tick_rate));
+    }
+
+    /*!
+     * Validate and play out a committed packet:
+     * The sequence has to follow the previous packet,
+     * a timed burst has to start in the future and
+     * the send buffer must not run dry within a burst.
+     */
+    void consume(const boost::uint32_t *pkt, const size_t len){
+        boost::mutex::scoped_lock lock(_mutex);
+        vrt::if_packet_info_t if_packet_info;
+        if_packet_info.num_packet_words32 = len/sizeof(boost::uint32_t);
+        try{
+            vrt::chdr::if_hdr_unpack_be(pkt, if_packet_info);
+        }
+        catch(const std::exception &ex){
+            UHD_MSG(error) << "Error parsing a transmitted packet: " << ex.what() << std::endl;
+            return;
+        }
+        const boost::int64_t now_ticks = _clock->get_time_now().to_ticks(_tick_rate);
+
+        if (if_packet_info.packet_count != _seq) this->report(_in_burst?
+            async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST : async_metadata_t::EVENT_CODE_SEQ_ERROR,
+            now_ticks, now_ticks
+        );
+        _seq = (if_packet_info.packet_count + 1) & 0xfff;
+        if (if_packet_info.packet_type != vrt::if_packet_info_t::PACKET_TYPE_DATA) return;
+
+        if (not _in_burst){
+            _in_burst = true;
+            const boost::int64_t free_ticks = std::max(now_ticks, _end_ticks);
+            _late = if_packet_info.has_tsf and boost::int64_t(if_packet_info.tsf) < free_ticks;
+            if (_late) this->report(async_metadata_t::EVENT_CODE_TIME_ERROR, now_ticks, now_ticks);
+            else if (if_packet_info.has_tsf) _start_ticks = _end_ticks = boost::int64_t(if_packet_info.tsf);
+            else if (_end_ticks < now_ticks) _start_ticks = _end_ticks = now_ticks;
+        }
+        else if (not _late and now_ticks > _end_ticks){
+            this->report(async_metadata_t::EVENT_CODE_UNDERFLOW, _end_ticks, now_ticks);
+            _start_ticks = _end_ticks = now_ticks;
+        }
+
+        if (not _late) _end_ticks += boost::int64_t(if_packet_info.num_payload_words32)*_ticks_per_samp;
+
+        //the ack goes out once the burst was played
+        if (if_packet_info.eob){
+            _in_burst = false;
+            if (not _late) this->report(async_metadata_t::EVENT_CODE_BURST_ACK, _end_ticks, _end_ticks);
+        }
+    }
+};
+
+sim_tx_xport::sptr sim_tx_xport::make(
+    sim_clock::sptr clock,
+    const zero_copy_xport_params &params,
+    const device_addr_t &hints
+){
+    return sptr(new sim_tx_xport_impl(clock, params, hints));
+}
@@ -0,0 +1,132 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef INCLUDED_LIBUHD_USRP_SIM_XPORTS_HPP
+#define INCLUDED_LIBUHD_USRP_SIM_XPORTS_HPP
+
+#include <uhd/config.hpp>
+#include <uhd/transport/zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+/*!
+ * The time keeper of the simulated device:
+ * The device time follows the monotonic host clock from an offset.
+ * The PPS edges are on the whole seconds of the device time.
+ */
+class sim_clock : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<sim_clock> sptr;
+
+    static sptr make(void);
+
+    virtual uhd::time_spec_t get_time_now(void) = 0;
+
+    virtual uhd::time_spec_t get_time_last_pps(void) = 0;
+
+    virtual void set_time_now(const uhd::time_spec_t &time) = 0;
+
+    virtual void set_time_next_pps(const uhd::time_spec_t &time) = 0;
+};
+
+/*!
+ * A queue of async messages that the device reports at a given time,
+ * ex: a burst ack is handed out once the device played the burst.
+ */
+class sim_async_queue : boost::noncopyable{
+public:
+    typedef boost::shared_ptr<sim_async_queue> sptr;
+
+    static sptr make(sim_clock::sptr clock, const size_t capacity);
+
+    //! Push a message that is released when the device time reaches release_time
+    virtual void push(const uhd::async_metadata_t &metadata, const uhd::time_spec_t &release_time) = 0;
+
+    //! Pop the oldest released message, wait up to timeout for one
+    virtual bool pop_with_timed_wait(uhd::async_metadata_t &metadata, const double timeout) = 0;
+};
+
+/*!
+ * The receive side of a simulated radio:
+ * The transport acts as framer and link in one, get_recv_buff()
+ * produces big endian CHDR packets on the caller's thread, paced
+ * so that a packet is handed out once the device time passed its
+ * last sample. A consumer that falls behind by more than the
+ * receive buffer gets an overflow, as from a real device.
+ *
+ * Hints: recv_buff_size (bytes of buffering before an overflow),
+ * drop_rate and reorder_rate (probability per packet), seed.
+ */
+class sim_rx_xport : public virtual uhd::transport::zero_copy_if{
+public:
+    typedef boost::shared_ptr<sim_rx_xport> sptr;
+
+    static sptr make(
+        sim_clock::sptr clock,
+        const uhd::transport::zero_copy_xport_params &params,
+        const uhd::device_addr_t &hints
+    );
+
+    virtual void set_tick_rate(const double rate) = 0;
+
+    virtual void set_samp_rate(const double rate) = 0;
+
+    virtual void set_nsamps_per_packet(const size_t nsamps) = 0;
+
+    virtual void set_sid(const boost::uint32_t sid) = 0;
+
+    virtual void issue_stream_command(const uhd::stream_cmd_t &stream_cmd) = 0;
+
+    //! Restart a continuous stream that stopped on an overflow
+    virtual void handle_overflow(void) = 0;
+
+    virtual bool in_continuous_streaming_mode(void) = 0;
+};
+
+/*!
+ * The transmit side of a simulated radio:
+ * Committed buffers are validated as big endian CHDR packets and
+ * played out at the sample rate. get_send_buff() blocks while the
+ * send buffer holds more than send_buff_size bytes of samples.
+ * Sequence errors, late packets, underflows and burst acks are
+ * reported to the async handler with the time of their release.
+ */
+class sim_tx_xport : public virtual uhd::transport::zero_copy_if{
+public:
+    typedef boost::shared_ptr<sim_tx_xport> sptr;
+    typedef boost::function<void(const uhd::async_metadata_t &, const uhd::time_spec_t &)> async_handler_type;
+
+    static sptr make(
+        sim_clock::sptr clock,
+        const uhd::transport::zero_copy_xport_params &params,
+        const uhd::device_addr_t &hints
+    );
+
+    virtual void set_tick_rate(const double rate) = 0;
+
+    virtual void set_samp_rate(const double rate) = 0;
+
+    virtual void set_async_handler(const async_handler_type &handler) = 0;
+};
+
+#endif /* INCLUDED_LIBUHD_USRP_SIM_XPORTS_HPP */
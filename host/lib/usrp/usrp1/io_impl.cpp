@@ -339,6 +339,14 @@ public:
         return _max_num_samps;
     }
 
+    size_t get_cpu_item_size(void) const{
+        return this->get_bytes_per_cpu_item();
+    }
+
+    size_t get_alignment_drops(const size_t chan) const{
+        return sph::recv_packet_handler::get_alignment_drops(chan);
+    }
+
     size_t recv(
         const rx_streamer::buffs_type &buffs,
         const size_t nsamps_per_buff,
@@ -356,6 +364,24 @@ public:
         return _stc->recv_post(metadata, num_samps_recvd);
     }
 
+    rx_zero_copy_buffs::sptr recv_zero_copy(
+        uhd::rx_metadata_t &metadata,
+        const double timeout
+    ){
+        //interleave a "soft" inline message into the receive stream:
+        if (_stc->get_inline_queue().pop_with_haste(metadata)) return rx_zero_copy_buffs::sptr();
+
+        sph::recv_zero_copy_buffs_impl::sptr buffs = sph::recv_packet_handler::recv_zero_copy(
+            metadata, timeout
+        );
+
+        //the soft time control may end the burst within the packet
+        const size_t num_samps_recvd = _stc->recv_post(metadata, (buffs)? buffs->get_num_samps() : 0);
+        if (not buffs or num_samps_recvd == 0) return rx_zero_copy_buffs::sptr();
+        buffs->clip(num_samps_recvd);
+        return buffs;
+    }
+
     void issue_stream_cmd(const stream_cmd_t &stream_cmd)
     {
         _stc->issue_stream_cmd(stream_cmd);
@@ -652,7 +678,7 @@ rx_streamer::sptr usrp1_impl::get_rx_stream(const uhd::stream_args_t &args_){
     id.num_inputs = 1;
     id.output_format = args.cpu_format;
     id.num_outputs = args.channels.size();
-    my_streamer->set_converter(id);
+    my_streamer->set_converter(id, args.args);
 
     //special scale factor change for sc8
     if (args.otw_format == "sc8")
@@ -709,7 +735,7 @@ tx_streamer::sptr usrp1_impl::get_tx_stream(const uhd::stream_args_t &args_){
     id.num_inputs = args.channels.size();
     id.output_format = args.otw_format + "_item16_usrp1";
     id.num_outputs = 1;
-    my_streamer->set_converter(id);
+    my_streamer->set_converter(id, args.args);
 
     //save as weak ptr for update access
     _tx_streamer = my_streamer;
@@ -16,6 +16,7 @@
 //
 
 #include "usrp1_impl.hpp"
+#include "xport_counters.hpp"
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/safe_call.hpp>
 #include <uhd/transport/usb_control.hpp>
@@ -208,6 +209,7 @@ usrp1_impl::usrp1_impl(const device_addr_t &device_addr){
     _tree->create<std::string>("/name").set("USRP1 Device");
     const fs_path mb_path = "/mboards/0";
     _tree->create<std::string>(mb_path / "name").set("USRP1");
+    publish_xport_counters(_tree, mb_path / "xports" / "data", _data_transport);
     _tree->create<std::string>(mb_path / "load_eeprom")
         .subscribe(boost::bind(&fx2_ctrl::usrp_load_eeprom, _fx2_ctrl, _1));
 
@@ -18,6 +18,7 @@
 #include "usrp2_impl.hpp"
 #include "fw_common.h"
 #include "apply_corrections.hpp"
+#include "xport_counters.hpp"
 #include <uhd/utils/log.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/exception.hpp>
@@ -282,10 +283,11 @@ static zero_copy_if::sptr make_xport(
     const std::string &filter
 ){
 
-    //only copy hints that contain the filter word
+    //only copy hints that contain the filter word,
+    //and the buffer pool allocation policies
     device_addr_t filtered_hints;
     BOOST_FOREACH(const std::string &key, hints.keys()){
-        if (key.find(filter) == std::string::npos) continue;
+        if (key.find(filter) == std::string::npos and key.find("buff_") != 0) continue;
         filtered_hints[key] = hints[key];
     }
 
@@ -449,6 +451,11 @@ usrp2_impl::usrp2_impl(const device_addr_t &_device_addr) :
         _mbc[mb].fifo_ctrl_xport = make_xport(
             addr, BOOST_STRINGIZE(USRP2_UDP_FIFO_CRTL_PORT), device_addr_t(), ""
         );
+        publish_xport_counters(_tree, mb_path / "xports" / "rx0", _mbc[mb].rx_dsp_xports[0]);
+        publish_xport_counters(_tree, mb_path / "xports" / "rx1", _mbc[mb].rx_dsp_xports[1]);
+        publish_xport_counters(_tree, mb_path / "xports" / "tx0", _mbc[mb].tx_dsp_xport);
+        publish_xport_counters(_tree, mb_path / "xports" / "ctrl", _mbc[mb].fifo_ctrl_xport);
+
         //set the filter on the router to take dsp data from this port
         _mbc[mb].iface->poke32(U2_REG_ROUTER_CTRL_PORTS, (USRP2_UDP_FIFO_CRTL_PORT << 16) | USRP2_UDP_TX_DSP0_PORT);
 
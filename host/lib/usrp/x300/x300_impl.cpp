@@ -22,6 +22,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
 #include "apply_corrections.hpp"
+#include "xport_counters.hpp"
 #include <uhd/utils/static.hpp>
 #include <uhd/utils/msg.hpp>
 #include <uhd/utils/paths.hpp>
@@ -34,6 +35,7 @@
 #include <boost/assign/list_of.hpp>
 #include <fstream>
 #include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/transport/af_packet_zero_copy.hpp>
 #include <uhd/transport/udp_constants.hpp>
 #include <uhd/transport/nirio_zero_copy.hpp>
 #include <uhd/transport/nirio/niusrprio_session.h>
@@ -419,6 +421,14 @@ void x300_impl::setup_mb(const size_t mb_i, const uhd::device_addr_t &dev_addr)
     {
         if (key.find("recv") != std::string::npos) mb.recv_args[key] = dev_addr[key];
         if (key.find("send") != std::string::npos) mb.send_args[key] = dev_addr[key];
+        //buffer pool allocation policies apply to both directions
+        if (key.find("buff_") == 0) mb.recv_args[key] = mb.send_args[key] = dev_addr[key];
+    }
+
+    //the data transports can use packet rings instead of udp sockets
+    mb.data_xport = dev_addr.has_key("data_xport") ? dev_addr["data_xport"] : "udp";
+    if (mb.data_xport != "udp" and mb.data_xport != "af_packet") {
+        throw uhd::value_error("x300_impl: data_xport must be udp or af_packet, not " + mb.data_xport);
     }
 
     if (mb.xport_path == "eth" ) {
@@ -864,6 +874,7 @@ void x300_impl::setup_radio(const size_t mb_i, const std::string &slot_name)
     boost::uint32_t ctrl_sid;
     both_xports_t xport = this->make_transport(mb_i, dest, X300_RADIO_DEST_PREFIX_CTRL, device_addr_t(), ctrl_sid);
     perif.ctrl = radio_ctrl_core_3000::make(mb.if_pkt_is_big_endian, xport.recv, xport.send, ctrl_sid, slot_name);
+    publish_xport_counters(_tree, mb_path / "xports" / str(boost::format("ctrl%d") % radio_index), xport.recv);
     perif.ctrl->poke32(TOREG(SR_MISC_OUTS), (1 << 2)); //reset adc + dac
     perif.ctrl->poke32(TOREG(SR_MISC_OUTS),  (1 << 1) | (1 << 0)); //out of reset + dac enable
 
@@ -1199,11 +1210,19 @@ x300_impl::both_xports_t x300_impl::make_transport(
 
         //make a new transport - fpga has no idea how to talk to us on this yet
         udp_zero_copy::buff_params buff_params;
-        xports.recv = udp_zero_copy::make(mb.addr,
-                BOOST_STRINGIZE(X300_VITA_UDP_PORT),
-                default_buff_args,
-                buff_params,
-                xport_args);
+        if (mb.data_xport == "af_packet" and prefix != X300_RADIO_DEST_PREFIX_CTRL) {
+            xports.recv = af_packet_zero_copy::make(mb.addr,
+                    BOOST_STRINGIZE(X300_VITA_UDP_PORT),
+                    default_buff_args,
+                    buff_params,
+                    xport_args);
+        } else {
+            xports.recv = udp_zero_copy::make(mb.addr,
+                    BOOST_STRINGIZE(X300_VITA_UDP_PORT),
+                    default_buff_args,
+                    buff_params,
+                    xport_args);
+        }
 
         xports.send = xports.recv;
 
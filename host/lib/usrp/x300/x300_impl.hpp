@@ -199,6 +199,7 @@ private:
         uhd::task::sptr claimer_task;
         std::string addr;
         std::string xport_path;
+        std::string data_xport; //udp or af_packet, for eth
         int router_dst_here;
         uhd::device_addr_t send_args;
         uhd::device_addr_t recv_args;
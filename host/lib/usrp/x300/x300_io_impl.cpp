@@ -18,9 +18,11 @@
 #include "x300_regs.hpp"
 #include "x300_impl.hpp"
 #include "validate_subdev_spec.hpp"
+#include "xport_counters.hpp"
 #include "../../transport/super_recv_packet_handler.hpp"
 #include "../../transport/super_send_packet_handler.hpp"
 #include <uhd/transport/nirio_zero_copy.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
 #include "async_packet_handler.hpp"
 #include <uhd/transport/bounded_buffer.hpp>
 #include <uhd/transport/chdr.hpp>
@@ -381,6 +383,7 @@ rx_streamer::sptr x300_impl::get_rx_stream(const uhd::stream_args_t &args_)
         boost::uint32_t data_sid;
         UHD_LOG << "creating rx stream " << device_addr.to_string() << std::endl;
         both_xports_t xport = this->make_transport(mb_index, dest, X300_RADIO_DEST_PREFIX_RX, device_addr, data_sid);
+        publish_xport_counters(_tree, "/mboards/" + boost::lexical_cast<std::string>(mb_index) / "xports" / str(boost::format("rx%d") % radio_index), xport.recv);
         UHD_LOG << boost::format("data_sid = 0x%08x, actual recv_buff_size = %d\n") % data_sid % xport.recv_buff_size << std::endl;
 
 	// To calculate the max number of samples per packet, we assume the maximum header length
@@ -409,7 +412,7 @@ rx_streamer::sptr x300_impl::get_rx_stream(const uhd::stream_args_t &args_)
         id.num_inputs = 1;
         id.output_format = args.cpu_format;
         id.num_outputs = 1;
-        my_streamer->set_converter(id);
+        my_streamer->set_converter(id, args.args);
 
         perif.framer->clear();
         perif.framer->set_nsamps_per_packet(spp); //seems to be a good place to set this
@@ -546,6 +549,7 @@ tx_streamer::sptr x300_impl::get_tx_stream(const uhd::stream_args_t &args_)
         boost::uint32_t data_sid;
         UHD_LOG << "creating tx stream " << device_addr.to_string() << std::endl;
         both_xports_t xport = this->make_transport(mb_index, dest, X300_RADIO_DEST_PREFIX_TX, device_addr, data_sid);
+        publish_xport_counters(_tree, "/mboards/" + boost::lexical_cast<std::string>(mb_index) / "xports" / str(boost::format("tx%d") % radio_index), xport.send);
         UHD_LOG << boost::format("data_sid = 0x%08x\n") % data_sid << std::endl;
 
         // To calculate the max number of samples per packet, we assume the maximum header length
@@ -573,7 +577,7 @@ tx_streamer::sptr x300_impl::get_tx_stream(const uhd::stream_args_t &args_)
         id.num_inputs = 1;
         id.output_format = args.otw_format + "_item32_" + conv_endianness;
         id.num_outputs = 1;
-        my_streamer->set_converter(id);
+        my_streamer->set_converter(id, args.args);
 
         perif.deframer->clear();
         perif.deframer->setup(args);
@@ -601,6 +605,11 @@ tx_streamer::sptr x300_impl::get_tx_stream(const uhd::stream_args_t &args_)
             stream_i,
             boost::bind(&get_tx_buff_with_flowctrl, task, guts, xport.send, fc_window, _1)
         );
+        //Give the streamer a functor to flush a transport that sends in batches
+        udp_zero_copy::sptr udp_send = boost::dynamic_pointer_cast<udp_zero_copy>(xport.send);
+        if (udp_send) my_streamer->set_xport_chan_flush(
+            stream_i, boost::bind(&udp_zero_copy::flush_send_buffs, udp_send)
+        );
         //Give the streamer a functor handled received async messages
         my_streamer->set_async_receiver(
             boost::bind(&async_md_type::pop_with_timed_wait, async_md, _1, _2)
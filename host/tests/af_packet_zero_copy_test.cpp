@@ -0,0 +1,132 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/af_packet_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/exception.hpp>
+#include <boost/asio.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <fstream>
+#include <deque>
+#include <vector>
+
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/*!
+ * Frames sent from a packet socket on the loopback interface are routed
+ * like frames from the wire: the kernel drops them as martian packets,
+ * unless the interface routes and accepts local source addresses.
+ */
+static bool loopback_accepts_local_frames(void){
+    static const char *confs[] = {"all", "lo"};
+    bool route_localnet = false, accept_local = false;
+    for (size_t i = 0; i < 2; i++){
+        const std::string path = std::string("/proc/sys/net/ipv4/conf/") + confs[i] + "/";
+        int value = 0;
+        std::ifstream(std::string(path + "route_localnet").c_str()) >> value;
+        route_localnet = route_localnet or value != 0;
+        value = 0;
+        std::ifstream(std::string(path + "accept_local").c_str()) >> value;
+        accept_local = accept_local or value != 0;
+    }
+    return route_localnet and accept_local;
+}
+
+static bool wait_for_frame(asio::ip::udp::socket &socket, double timeout){
+    const boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds(long(timeout*1e6));
+    while (socket.available() == 0){
+        if (boost::get_system_time() > deadline) return false;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Loopback through localhost:
+ *    a plain socket exchanges frames of different lengths with a
+ *    packet ring transport, the test is skipped without permission
+ *    to open packet sockets (CAP_NET_RAW)
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_af_packet_zero_copy_loopback){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    af_packet_zero_copy::sptr xport;
+    try{
+        xport = af_packet_zero_copy::make("127.0.0.1", port, params, buff_params);
+    }
+    catch(const uhd::exception &e){
+        BOOST_TEST_MESSAGE("skipping the packet ring test: " << e.what());
+        return;
+    }
+    BOOST_CHECK(buff_params.recv_buff_size >= params.num_recv_frames*params.recv_frame_size);
+    const asio::ip::udp::endpoint xport_endpoint(asio::ip::address_v4::loopback(), xport->get_local_port());
+
+    //frames to the transport, some of the buffers are held
+    static const size_t num_frames = 40;
+    for (size_t i = 0; i < num_frames; i++){
+        const std::vector<boost::uint32_t> frame(i%7 + 1, boost::uint32_t(i));
+        peer.send_to(asio::buffer(frame), xport_endpoint);
+    }
+
+    std::deque<managed_recv_buffer::sptr> held_buffs;
+    for (size_t i = 0; i < num_frames; i++){
+        managed_recv_buffer::sptr recv_buff = xport->get_recv_buff(1.0);
+        BOOST_REQUIRE(recv_buff);
+        BOOST_CHECK_EQUAL(recv_buff->size(), (i%7 + 1)*sizeof(boost::uint32_t));
+        BOOST_CHECK_EQUAL(recv_buff->cast<const boost::uint32_t *>()[i%7], boost::uint32_t(i));
+        held_buffs.push_back(recv_buff);
+        if (held_buffs.size() > 5) held_buffs.pop_front();
+    }
+    held_buffs.clear();
+
+    //nothing left, frames from other ports are filtered out
+    asio::ip::udp::socket other(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    other.send_to(asio::buffer(&params, sizeof(boost::uint32_t)), xport_endpoint);
+    BOOST_CHECK(not xport->get_recv_buff(0.05));
+
+    //frames from the transport
+    if (not loopback_accepts_local_frames()){
+        BOOST_TEST_MESSAGE("skipping the send test: set route_localnet and accept_local for lo");
+        return;
+    }
+    for (size_t i = 0; i < num_frames; i++){
+        managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+        BOOST_REQUIRE(send_buff);
+        for (size_t j = 0; j <= i%7; j++) send_buff->cast<boost::uint32_t *>()[j] = boost::uint32_t(i);
+        send_buff->commit((i%7 + 1)*sizeof(boost::uint32_t));
+        send_buff.reset();
+
+        BOOST_REQUIRE(wait_for_frame(peer, 1.0));
+        std::vector<boost::uint32_t> frame(8);
+        asio::ip::udp::endpoint sender;
+        BOOST_REQUIRE_EQUAL(peer.receive_from(asio::buffer(frame), sender), (i%7 + 1)*sizeof(boost::uint32_t));
+        BOOST_CHECK(sender == xport_endpoint);
+        BOOST_CHECK_EQUAL(frame[i%7], boost::uint32_t(i));
+    }
+}
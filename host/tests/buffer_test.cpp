@@ -17,7 +17,13 @@
 
 #include <boost/test/unit_test.hpp>
 #include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/spsc_bounded_buffer.hpp>
+#include <uhd/transport/buffer_pool.hpp>
+#include <uhd/exception.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <cstring>
 
 using namespace boost::assign;
 using namespace uhd::transport;
@@ -62,3 +68,63 @@ BOOST_AUTO_TEST_CASE(test_bounded_buffer_with_pop_on_full){
     BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
     BOOST_CHECK_EQUAL(val, 3);
 }
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_with_timed_wait){
+    spsc_bounded_buffer<int> bb(3);
+
+    //push elements, check for timeout
+    BOOST_CHECK(bb.push_with_timed_wait(0, timeout));
+    BOOST_CHECK(bb.push_with_timed_wait(1, timeout));
+    BOOST_CHECK(bb.push_with_timed_wait(2, timeout));
+    BOOST_CHECK(not bb.push_with_timed_wait(3, timeout));
+    BOOST_CHECK(not bb.push_with_haste(3));
+
+    int val;
+    //pop elements, check for timeout and check values
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 0);
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 1);
+    BOOST_CHECK(bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK_EQUAL(val, 2);
+    BOOST_CHECK(not bb.pop_with_timed_wait(val, timeout));
+    BOOST_CHECK(not bb.pop_with_haste(val));
+}
+
+static void spsc_producer(spsc_bounded_buffer<int> *bb, const int num_elems){
+    for (int i = 0; i < num_elems; i++) bb->push_with_wait(i);
+}
+
+BOOST_AUTO_TEST_CASE(test_spsc_bounded_buffer_between_threads){
+    //a small buffer makes both sides block on full and empty
+    spsc_bounded_buffer<int> bb(5);
+    static const int num_elems = 100000;
+    boost::thread producer(boost::bind(&spsc_producer, &bb, num_elems));
+
+    int val;
+    for (int i = 0; i < num_elems; i++){
+        if (i % 1000 == 0) boost::this_thread::sleep(boost::posix_time::microseconds(100));
+        BOOST_REQUIRE(bb.pop_with_timed_wait(val, 1.0));
+        BOOST_REQUIRE_EQUAL(val, i);
+    }
+    producer.join();
+    BOOST_CHECK(not bb.pop_with_haste(val));
+}
+
+BOOST_AUTO_TEST_CASE(test_buffer_pool_with_policies){
+    //policies that can not be applied fall back with a warning
+    uhd::device_addr_t hints;
+    hints["buff_hugepages"] = "2M";
+    hints["buff_numa_node"] = "0";
+    hints["buff_mlock"] = "1";
+    buffer_pool::sptr pool = buffer_pool::make(100, 8000, hints, 64);
+    BOOST_REQUIRE_EQUAL(pool->size(), size_t(100));
+    for (size_t i = 0; i < pool->size(); i++){
+        BOOST_CHECK_EQUAL(size_t(pool->at(i)) % 64, size_t(0));
+        std::memset(pool->at(i), int(i), 8000);
+    }
+    BOOST_CHECK_EQUAL(static_cast<char *>(pool->at(99))[7999], char(99));
+
+    hints["buff_hugepages"] = "4k";
+    BOOST_CHECK_THROW(buffer_pool::make(100, 8000, hints), uhd::value_error);
+}
@@ -0,0 +1,95 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include "../lib/transport/convert_pool.hpp"
+#include <uhd/exception.hpp>
+#include <uhd/utils/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <stdexcept>
+#include <cstdlib>
+#include <vector>
+
+using namespace uhd::transport;
+
+static const size_t NUM_JOBS = 32;
+
+struct job_counts{
+    job_counts(void): counts(NUM_JOBS){}
+    std::vector<uhd::atomic_uint32_t> counts;
+};
+
+static void count_job(void *context, const size_t index){
+    static_cast<job_counts *>(context)->counts[index].inc();
+}
+
+static void throw_job(void *, const size_t index){
+    if (index == NUM_JOBS/2) throw std::runtime_error("job failed");
+}
+
+static void run_batches(convert_pool::sptr pool, job_counts *counts, const size_t num_batches){
+    for (size_t i = 0; i < num_batches; i++){
+        pool->run(&count_job, counts, NUM_JOBS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_pool_runs_each_job){
+    setenv("UHD_CONVERT_THREADS", "3", 1);
+    convert_pool::sptr pool = convert_pool::get_shared();
+    BOOST_CHECK_EQUAL(pool->get_num_threads(), size_t(3));
+    BOOST_CHECK(convert_pool::get_shared() == pool);
+
+    job_counts counts;
+    run_batches(pool, &counts, 100);
+    for (size_t i = 0; i < NUM_JOBS; i++){
+        BOOST_CHECK_EQUAL(counts.counts[i].read(), 100UL);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_pool_shared_by_threads){
+    setenv("UHD_CONVERT_THREADS", "2", 1);
+    convert_pool::sptr pool = convert_pool::get_shared();
+
+    //several streamers submit batches at the same time
+    std::vector<job_counts> counts(4);
+    boost::thread_group threads;
+    for (size_t i = 0; i < counts.size(); i++){
+        threads.create_thread(boost::bind(&run_batches, pool, &counts[i], 100));
+    }
+    threads.join_all();
+    for (size_t i = 0; i < counts.size(); i++){
+        for (size_t j = 0; j < NUM_JOBS; j++){
+            BOOST_CHECK_EQUAL(counts[i].counts[j].read(), 100UL);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_pool_job_error){
+    setenv("UHD_CONVERT_THREADS", "2", 1);
+    convert_pool::sptr pool = convert_pool::get_shared();
+    BOOST_CHECK_THROW(pool->run(&throw_job, NULL, NUM_JOBS), uhd::runtime_error);
+
+    //without workers the caller runs the jobs
+    pool.reset();
+    setenv("UHD_CONVERT_THREADS", "0", 1);
+    pool = convert_pool::get_shared();
+    BOOST_CHECK_EQUAL(pool->get_num_threads(), size_t(0));
+    job_counts counts;
+    run_batches(pool, &counts, 10);
+    BOOST_CHECK_EQUAL(counts.counts[NUM_JOBS-1].read(), 10UL);
+}
@@ -15,11 +15,15 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 //
 
+#include "../lib/convert/convert_common.hpp"
 #include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/utils/byteswap.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/foreach.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/assign/list_of.hpp>
+#include <algorithm>
 #include <complex>
 #include <vector>
 #include <cstdlib>
@@ -67,6 +71,20 @@ template <typename Range> static void loopback(
     c1->conv(input1, output1, nsamps);
 }
 
+/***********************************************************************
+ * Check if a converter is registered with a particular priority:
+ *    the avx converters are only registered when the cpu supports them
+ **********************************************************************/
+static bool has_converter(const convert::id_type &id, const int prio){
+    try{
+        convert::get_converter(id, prio);
+    }
+    catch(const uhd::key_error &){
+        return false;
+    }
+    return true;
+}
+
 /***********************************************************************
  * Test short conversion
  **********************************************************************/
@@ -144,6 +162,18 @@ static void test_convert_types_for_floats(
         (int_pair_t(0, -1)) (int_pair_t(-1, -1))
     ;
 
+    //add the sse2, avx2, and avx-512 converters supported on this cpu
+    std::vector<int> simd_prios(1, PRIORITY_SIMD);
+#ifndef __ARM_NEON__
+    simd_prios.push_back(PRIORITY_SIMD_AVX2);
+    simd_prios.push_back(PRIORITY_SIMD_AVX512);
+#endif
+    BOOST_FOREACH(const int prio, simd_prios){
+        if (has_converter(in_id, prio) and has_converter(out_id, prio)){
+            prios.push_back(int_pair_t(prio, prio));
+        }
+    }
+
     //loopback foreach prio combo (generic vs best)
     BOOST_FOREACH(const int_pair_t &prio, prios){
         loopback(nsamps, in_id, out_id, input, output, prio.first, prio.second);
@@ -206,6 +236,30 @@ BOOST_AUTO_TEST_CASE(test_convert_types_le_fc64){
     }
 }
 
+/***********************************************************************
+ * Test the simd converters with lengths that cover the vector loops:
+ *    the avx-512 converters process up to 16 samples per iteration
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_types_simd_lengths){
+    convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    static const char *otw_formats[] = {
+        "sc16_item32_le", "sc16_item32_be", "sc8_item32_le", "sc8_item32_be"
+    };
+    BOOST_FOREACH(const char *otw_format, otw_formats){
+        id.output_format = otw_format;
+        const double extra_scale = (id.output_format.find("sc8") == 0)? 1./256 : 1.0;
+        for (size_t nsamps = 16; nsamps < 70; nsamps++){
+            id.input_format = "fc32";
+            test_convert_types_for_floats<fc32_t>(nsamps, id, extra_scale);
+            id.input_format = "fc64";
+            test_convert_types_for_floats<fc64_t>(nsamps, id, extra_scale);
+        }
+    }
+}
+
 /***********************************************************************
  * Test float to/from sc12 conversion loopback
  **********************************************************************/
@@ -236,6 +290,367 @@ BOOST_AUTO_TEST_CASE(test_convert_types_be_sc12_with_fc32){
     }
 }
 
+/***********************************************************************
+ * Test short to/from sc12 conversion loopback:
+ *    sc16 holds the 12-bit numbers left-aligned, the low 4 bits are lost
+ **********************************************************************/
+static void test_convert_types_sc16_sc12(
+    size_t nsamps, convert::id_type &id
+){
+    //fill the input samples, the low 4 bits get masked off on the wire
+    std::vector<sc16_t> input(nsamps), output(nsamps), expected(nsamps);
+    for (size_t i = 0; i < nsamps; i++){
+        input[i] = sc16_t(short(std::rand()), short(std::rand()));
+        expected[i] = sc16_t(short(input[i].real() & 0xfff0), short(input[i].imag() & 0xfff0));
+    }
+
+    //run the loopback and test
+    convert::id_type in_id = id;
+    convert::id_type out_id = id;
+    std::swap(out_id.input_format, out_id.output_format);
+    std::swap(out_id.num_inputs, out_id.num_outputs);
+    loopback(nsamps, in_id, out_id, input, output);
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), output.begin(), output.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_types_sc16_and_sc12){
+    convert::id_type id;
+    id.input_format = "sc16";
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    //try various lengths to test edge cases
+    id.output_format = "sc12_item32_le";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++){
+        test_convert_types_sc16_sc12(nsamps, id);
+    }
+
+    //try various lengths to test edge cases
+    id.output_format = "sc12_item32_be";
+    for (size_t nsamps = 1; nsamps < 16; nsamps++){
+        test_convert_types_sc16_sc12(nsamps, id);
+    }
+}
+
+/***********************************************************************
+ * Test the simd sc12 converters against the generic converters:
+ *    the outputs must be bit exact for all lengths and for all four
+ *    positions of the first sample within a 3 line block
+ **********************************************************************/
+static void convert_with_prio(
+    const convert::id_type &id, const int prio, const double scalar,
+    const void *input, void *output, const size_t nsamps
+){
+    std::vector<const void *> inputs(1, input);
+    std::vector<void *> outputs(1, output);
+    convert::converter::sptr c = convert::get_converter(id, prio)();
+    c->set_scalar(scalar);
+    c->conv(inputs, outputs, nsamps);
+}
+
+static void test_convert_sc12_bit_exact(const convert::id_type &id, const double scalar){
+    const bool to_sc12 = (id.output_format.find("sc12") == 0);
+    const size_t in_bpi = convert::get_bytes_per_item(id.input_format);
+    const size_t out_bpi = convert::get_bytes_per_item(id.output_format);
+
+    BOOST_FOREACH(const convert::priority_type prio, convert::get_converter_priorities(id)){
+        if (prio == PRIORITY_GENERAL) continue;
+        for (size_t offset = 0; offset < 12; offset += 3){
+            const size_t in_offset = (to_sc12)? 0 : offset;
+            const size_t out_offset = (to_sc12)? offset : 0;
+            for (size_t nsamps = 1; nsamps < 40; nsamps++){
+                //fill the input with random floats or random bytes
+                std::vector<boost::uint64_t> input((in_offset + nsamps*in_bpi)/8 + 4);
+                char *in_bytes = reinterpret_cast<char *>(&input[0]);
+                if (id.input_format == "fc32"){
+                    float *in_floats = reinterpret_cast<float *>(in_bytes);
+                    for (size_t i = 0; i < nsamps*2; i++){
+                        in_floats[i] = (std::rand()/float(RAND_MAX/2)) - 1;
+                    }
+                }
+                else for (size_t i = 0; i < input.size()*8; i++) in_bytes[i] = char(std::rand());
+
+                //the whole output buffers must match, including what was not written
+                std::vector<boost::uint64_t> out_generic((out_offset + nsamps*out_bpi)/8 + 4, 0);
+                std::vector<boost::uint64_t> out_simd(out_generic.size(), 0);
+                convert_with_prio(id, PRIORITY_GENERAL, scalar, in_bytes + in_offset,
+                    reinterpret_cast<char *>(&out_generic[0]) + out_offset, nsamps);
+                convert_with_prio(id, prio, scalar, in_bytes + in_offset,
+                    reinterpret_cast<char *>(&out_simd[0]) + out_offset, nsamps);
+                BOOST_CHECK_MESSAGE(out_generic == out_simd, id.to_string()
+                    << " prio " << prio << " nsamps " << nsamps << " offset " << offset);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_sc12_simd_bit_exact){
+    convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    static const char *otw_formats[] = {"sc12_item32_le", "sc12_item32_be"};
+    static const char *cpu_formats[] = {"fc32", "sc16"};
+    BOOST_FOREACH(const char *otw_format, otw_formats){
+        BOOST_FOREACH(const char *cpu_format, cpu_formats){
+            id.input_format = cpu_format;
+            id.output_format = otw_format;
+            test_convert_sc12_bit_exact(id, 32767.);
+
+            id.input_format = otw_format;
+            id.output_format = cpu_format;
+            test_convert_sc12_bit_exact(id, 1/32767.);
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the multi-channel sc16 converters:
+ *    the simd deinterleave must match the generic converter exactly,
+ *    the simd interleave is checked with a loopback through the
+ *    generic deinterleave (the float rounding differs from generic)
+ **********************************************************************/
+template <typename data_type>
+static void test_convert_multi_chan(
+    const std::string &otw_format, const std::string &cpu_format, const size_t nchan
+){
+    convert::id_type rx_id;
+    rx_id.input_format = otw_format;
+    rx_id.num_inputs = 1;
+    rx_id.output_format = cpu_format;
+    rx_id.num_outputs = nchan;
+
+    convert::id_type tx_id = rx_id;
+    std::swap(tx_id.input_format, tx_id.output_format);
+    std::swap(tx_id.num_inputs, tx_id.num_outputs);
+
+    if (not has_converter(rx_id, PRIORITY_SIMD) or not has_converter(tx_id, PRIORITY_SIMD)) return;
+    const bool is_float = (cpu_format == "fc32");
+
+    for (size_t nsamps = 1; nsamps < 40; nsamps++){
+        //deinterleave random items with both converters
+        std::vector<boost::uint32_t> items(nsamps*nchan);
+        BOOST_FOREACH(boost::uint32_t &item, items) item = (boost::uint32_t(std::rand()) << 16) ^ std::rand();
+
+        std::vector<std::vector<data_type> > out_generic(nchan, std::vector<data_type>(nsamps));
+        std::vector<std::vector<data_type> > out_simd(nchan, std::vector<data_type>(nsamps));
+        std::vector<const void *> rx_inputs(1, &items[0]);
+        std::vector<void *> generic_outputs, simd_outputs;
+        for (size_t ch = 0; ch < nchan; ch++){
+            generic_outputs.push_back(&out_generic[ch][0]);
+            simd_outputs.push_back(&out_simd[ch][0]);
+        }
+
+        convert::converter::sptr c0 = convert::get_converter(rx_id, PRIORITY_GENERAL)();
+        c0->set_scalar(1/32767.);
+        c0->conv(rx_inputs, generic_outputs, nsamps);
+        convert::converter::sptr c1 = convert::get_converter(rx_id, PRIORITY_SIMD)();
+        c1->set_scalar(1/32767.);
+        c1->conv(rx_inputs, simd_outputs, nsamps);
+        for (size_t ch = 0; ch < nchan; ch++){
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                out_generic[ch].begin(), out_generic[ch].end(),
+                out_simd[ch].begin(), out_simd[ch].end());
+        }
+
+        //interleave the samples again, then deinterleave them with the generic converter
+        std::vector<boost::uint32_t> tx_items(nsamps*nchan);
+        std::vector<const void *> tx_inputs(simd_outputs.begin(), simd_outputs.end());
+        std::vector<void *> tx_outputs(1, &tx_items[0]);
+        convert::converter::sptr c2 = convert::get_converter(tx_id, PRIORITY_SIMD)();
+        c2->set_scalar(32767.);
+        c2->conv(tx_inputs, tx_outputs, nsamps);
+
+        std::vector<const void *> loop_inputs(1, &tx_items[0]);
+        c0->conv(loop_inputs, generic_outputs, nsamps);
+        for (size_t ch = 0; ch < nchan; ch++){
+            for (size_t i = 0; i < nsamps; i++){
+                if (is_float){
+                    MY_CHECK_CLOSE(out_simd[ch][i].real(), out_generic[ch][i].real(), 1./(1 << 14));
+                    MY_CHECK_CLOSE(out_simd[ch][i].imag(), out_generic[ch][i].imag(), 1./(1 << 14));
+                }
+                else BOOST_CHECK(out_simd[ch][i] == out_generic[ch][i]);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_multi_chan_simd){
+    static const char *otw_formats[] = {"sc16_item32_le", "sc16_item32_be", "sc16_item16_usrp1"};
+    BOOST_FOREACH(const char *otw_format, otw_formats){
+        for (size_t nchan = 2; nchan <= 4; nchan += 2){
+            test_convert_multi_chan<fc32_t>(otw_format, "fc32", nchan);
+            test_convert_multi_chan<sc16_t>(otw_format, "sc16", nchan);
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the non-temporal store converters against the generic converters:
+ *    the outputs must be bit exact for all lengths and for outputs that
+ *    are aligned, can be aligned, and can never be aligned to 16 bytes
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_nt_stores_bit_exact){
+    convert::id_type id;
+    id.num_inputs = 1;
+    id.num_outputs = 1;
+
+    static const char *otw_formats[] = {"sc16_item32_le", "sc16_item32_be"};
+    static const char *cpu_formats[] = {"fc32", "sc16"};
+    BOOST_FOREACH(const char *otw_format, otw_formats){
+        BOOST_FOREACH(const char *cpu_format, cpu_formats){
+            id.input_format = otw_format;
+            id.output_format = cpu_format;
+            if (not has_converter(id, convert::PRIORITY_NON_TEMPORAL)) continue;
+            const size_t out_bpi = convert::get_bytes_per_item(id.output_format);
+
+            for (size_t out_offset = 0; out_offset < 16; out_offset += 4){
+                for (size_t nsamps = 1; nsamps < 40; nsamps++){
+                    std::vector<boost::uint32_t> input(nsamps);
+                    BOOST_FOREACH(boost::uint32_t &item, input) item = (boost::uint32_t(std::rand()) << 16) ^ std::rand();
+
+                    //the whole output buffers must match, including what was not written
+                    std::vector<boost::uint64_t> out_generic((out_offset + nsamps*out_bpi)/8 + 4, 0);
+                    std::vector<boost::uint64_t> out_nt(out_generic.size(), 0);
+                    convert_with_prio(id, PRIORITY_GENERAL, 1/32767., &input[0],
+                        reinterpret_cast<char *>(&out_generic[0]) + out_offset, nsamps);
+                    convert_with_prio(id, convert::PRIORITY_NON_TEMPORAL, 1/32767., &input[0],
+                        reinterpret_cast<char *>(&out_nt[0]) + out_offset, nsamps);
+                    BOOST_CHECK_MESSAGE(out_generic == out_nt, id.to_string()
+                        << " nsamps " << nsamps << " offset " << out_offset);
+                }
+            }
+        }
+    }
+}
+
+/***********************************************************************
+ * Test the IQ and DC correcting converters:
+ *    the outputs are compared against the correction applied in double
+ *    precision, for two channels with different corrections, and with
+ *    large enough offsets to saturate the sc16 values on TX
+ **********************************************************************/
+static const std::string correction_args("iq_matrix=1.02:0.01:-0.03:0.98,dc_offset=0.01:-0.02,dc_offset1=0.5:0.25");
+
+static void test_convert_correction(const std::string &otw_format, const bool rx){
+    convert::id_type id;
+    id.input_format = (rx)? otw_format : "fc32";
+    id.num_inputs = 1;
+    id.output_format = (rx)? "fc32" : otw_format;
+    id.num_outputs = 1;
+
+    const uhd::device_addr_t args(correction_args);
+    std::vector<convert::converter::sptr> converters = convert::make_correcting_converters(id, args, 2);
+    BOOST_REQUIRE_EQUAL(converters.size(), size_t(2));
+
+    const bool swap = (otw_format == "sc16_item32_be");
+    const double scalar = (rx)? 1/32767. : 32767.;
+    for (size_t chan = 0; chan < converters.size(); chan++){
+        const convert::correction_type c = convert::correction_type::from_args(args, chan);
+        converters[chan]->set_scalar(scalar);
+
+        for (size_t nsamps = 1; nsamps < 40; nsamps++){
+            std::vector<boost::uint32_t> items(nsamps);
+            std::vector<fc32_t> samps(nsamps);
+            std::vector<const void *> inputs(1, (rx)? (const void *)&items[0] : (const void *)&samps[0]);
+            std::vector<void *> outputs(1, (rx)? (void *)&samps[0] : (void *)&items[0]);
+
+            if (rx){
+                BOOST_FOREACH(boost::uint32_t &item, items) item = (boost::uint32_t(std::rand()) << 16) ^ std::rand();
+                converters[chan]->conv(inputs, outputs, nsamps);
+                for (size_t i = 0; i < nsamps; i++){
+                    const boost::uint32_t item = (swap)? uhd::ntohx(items[i]) : uhd::wtohx(items[i]);
+                    const double re = boost::int16_t(item >> 16)*scalar, im = boost::int16_t(item)*scalar;
+                    MY_CHECK_CLOSE(samps[i].real(), c.matrix[0]*re + c.matrix[1]*im + c.offset.real(), 1e-5);
+                    MY_CHECK_CLOSE(samps[i].imag(), c.matrix[2]*re + c.matrix[3]*im + c.offset.imag(), 1e-5);
+                }
+            }
+            else{
+                BOOST_FOREACH(fc32_t &samp, samps) samp = fc32_t(
+                    (std::rand()/float(RAND_MAX/2)) - 1, (std::rand()/float(RAND_MAX/2)) - 1);
+                converters[chan]->conv(inputs, outputs, nsamps);
+                for (size_t i = 0; i < nsamps; i++){
+                    const boost::uint32_t item = (swap)? uhd::ntohx(items[i]) : uhd::wtohx(items[i]);
+                    const double re = samps[i].real(), im = samps[i].imag();
+                    const double out_re = (c.matrix[0]*re + c.matrix[1]*im + c.offset.real())*scalar;
+                    const double out_im = (c.matrix[2]*re + c.matrix[3]*im + c.offset.imag())*scalar;
+                    MY_CHECK_CLOSE(boost::int16_t(item >> 16), std::max(-32768.0, std::min(32767.0, out_re)), 1.01);
+                    MY_CHECK_CLOSE(boost::int16_t(item), std::max(-32768.0, std::min(32767.0, out_im)), 1.01);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_correction_sc16){
+    static const char *otw_formats[] = {"sc16_item32_le", "sc16_item32_be"};
+    BOOST_FOREACH(const char *otw_format, otw_formats){
+        test_convert_correction(otw_format, true);
+        test_convert_correction(otw_format, false);
+    }
+}
+
+/***********************************************************************
+ * Test the SIMD correcting converters against the generic ones:
+ *    halfway values round to even on every path, so the outputs match
+ *    exactly, also where they saturate
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_convert_correction_rounding){
+    convert::id_type id;
+    id.input_format = "fc32";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_le";
+    id.num_outputs = 1;
+
+    static const size_t nsamps = 1000;
+    std::vector<fc32_t> samps(nsamps);
+    for (size_t i = 0; i < nsamps; i++){
+        samps[i] = fc32_t(float(i) - 500.5f, (i%2)? 32767.5f + i : -32768.5f - i);
+    }
+    std::vector<boost::uint32_t> items_general(nsamps), items_best(nsamps);
+    std::vector<const void *> inputs(1, &samps[0]);
+
+    convert::converter::sptr c_general = convert::get_converter(id, PRIORITY_CORRECTION_GENERAL)();
+    c_general->set_scalar(1.0);
+    std::vector<void *> outputs(1, &items_general[0]);
+    c_general->conv(inputs, outputs, nsamps);
+
+    convert::converter::sptr c_best = convert::get_converter(id, convert::PRIORITY_CORRECTION)();
+    c_best->set_scalar(1.0);
+    outputs[0] = &items_best[0];
+    c_best->conv(inputs, outputs, nsamps);
+
+    for (size_t i = 0; i < nsamps; i++){
+        BOOST_CHECK_EQUAL(items_general[i], items_best[i]);
+        const boost::int16_t re = boost::int16_t(items_general[i] >> 16);
+        BOOST_CHECK_EQUAL(re % 2, 0);
+        BOOST_CHECK_EQUAL(boost::int16_t(items_general[i]), (i%2)? 32767 : -32768);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_convert_correction_args){
+    convert::id_type id;
+    id.input_format = "sc8_item32_le";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    //no corrections, no correcting converters
+    BOOST_CHECK(convert::make_correcting_converters(id, uhd::device_addr_t("spp=100"), 2).empty());
+    BOOST_CHECK(convert::correction_type().is_identity());
+
+    //per channel override
+    const uhd::device_addr_t args(correction_args);
+    BOOST_CHECK_EQUAL(convert::correction_type::from_args(args, 0).offset, std::complex<double>(0.01, -0.02));
+    BOOST_CHECK_EQUAL(convert::correction_type::from_args(args, 1).offset, std::complex<double>(0.5, 0.25));
+    BOOST_CHECK_EQUAL(convert::correction_type::from_args(args, 1).matrix[2], -0.03);
+
+    //not supported for sc8, and values that do not parse
+    BOOST_CHECK_THROW(convert::make_correcting_converters(id, args, 2), uhd::value_error);
+    BOOST_CHECK_THROW(convert::correction_type::from_args(uhd::device_addr_t("dc_offset=0.1"), 0), uhd::value_error);
+    BOOST_CHECK_THROW(convert::correction_type::from_args(uhd::device_addr_t("iq_matrix=1:0:0:x"), 0), uhd::value_error);
+}
+
 /***********************************************************************
  * Test float to/from fc32 conversion loopback
  **********************************************************************/
@@ -0,0 +1,168 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+#include <uhd/types/metadata.hpp>
+#include <uhd/types/stream_cmd.hpp>
+#include <complex>
+#include <vector>
+#include <cmath>
+
+using namespace uhd;
+
+static const double RATE = 1e6;
+
+static rx_streamer::sptr make_rx_stream(usrp::multi_usrp::sptr usrp, const size_t num_chans){
+    stream_args_t stream_args("fc32", "sc16");
+    for (size_t i = 0; i < num_chans; i++) stream_args.channels.push_back(i);
+    return usrp->get_rx_stream(stream_args);
+}
+
+/***********************************************************************
+ * Timed receive:
+ *    the samples start at the commanded time and the
+ *    burst ends after the number of samples
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_sim_device_rx_timed_burst){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim"));
+    BOOST_CHECK_EQUAL(usrp->get_rx_num_channels(), size_t(2));
+    usrp->set_rx_rate(RATE);
+    BOOST_CHECK_CLOSE(usrp->get_rx_rate(), RATE, 1e-6);
+    rx_streamer::sptr rx_stream = make_rx_stream(usrp, 2);
+    usrp->set_time_now(time_spec_t(0.0));
+
+    static const size_t num_samps = 10000;
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = num_samps;
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec = time_spec_t(0.05);
+    rx_stream->issue_stream_cmd(stream_cmd);
+
+    std::vector<std::complex<float> > buff0(num_samps), buff1(num_samps);
+    std::vector<std::complex<float> *> buffs;
+    buffs.push_back(&buff0.front());
+    buffs.push_back(&buff1.front());
+
+    rx_metadata_t md;
+    size_t num_accum_samps = 0;
+    while (num_accum_samps < num_samps){
+        std::vector<std::complex<float> *> offset_buffs;
+        offset_buffs.push_back(buffs[0] + num_accum_samps);
+        offset_buffs.push_back(buffs[1] + num_accum_samps);
+        const size_t num_rx_samps = rx_stream->recv(offset_buffs, num_samps - num_accum_samps, md, 1.0, true);
+        BOOST_REQUIRE_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_REQUIRE(md.has_time_spec);
+        BOOST_CHECK_EQUAL(md.time_spec.to_ticks(RATE), (time_spec_t(0.05) + time_spec_t::from_ticks(num_accum_samps, RATE)).to_ticks(RATE));
+        num_accum_samps += num_rx_samps;
+    }
+    BOOST_CHECK_EQUAL(num_accum_samps, num_samps);
+    BOOST_CHECK(md.end_of_burst);
+    BOOST_CHECK(usrp->get_time_now() >= time_spec_t(0.05) + time_spec_t::from_ticks(num_samps, RATE));
+
+    //the samples are a quarter rate tone
+    for (size_t i = 0; i < 4; i++){
+        BOOST_CHECK_CLOSE(std::abs(buff0[i]), 0x2000/32767., 1e-3);
+        BOOST_CHECK_EQUAL(buff0[i], buff1[i]);
+    }
+
+    //nothing follows the burst
+    BOOST_CHECK_EQUAL(rx_stream->recv(buffs, num_samps, md, 0.05), size_t(0));
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+/***********************************************************************
+ * A command for a time in the past is late
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_sim_device_rx_late_command){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim,num_chans=1"));
+    usrp->set_rx_rate(RATE);
+    rx_streamer::sptr rx_stream = make_rx_stream(usrp, 1);
+    usrp->set_time_now(time_spec_t(1.0));
+
+    stream_cmd_t stream_cmd(stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    stream_cmd.num_samps = 1000;
+    stream_cmd.stream_now = false;
+    stream_cmd.time_spec = time_spec_t(0.5);
+    rx_stream->issue_stream_cmd(stream_cmd);
+
+    std::vector<std::complex<float> > buff(1000);
+    rx_metadata_t md;
+    rx_stream->recv(&buff.front(), buff.size(), md, 1.0);
+    BOOST_CHECK_EQUAL(md.error_code, rx_metadata_t::ERROR_CODE_LATE_COMMAND);
+}
+
+/***********************************************************************
+ * Injected drops show up as sequence errors
+ **********************************************************************/
+BOOST_AUTO_TEST_CASE(test_sim_device_rx_drops){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim,num_chans=1,drop_rate=0.25,seed=7"));
+    usrp->set_rx_rate(RATE);
+    rx_streamer::sptr rx_stream = make_rx_stream(usrp, 1);
+    rx_stream->issue_stream_cmd(stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+
+    std::vector<std::complex<float> > buff(rx_stream->get_max_num_samps());
+    rx_metadata_t md;
+    size_t num_seq_errors = 0, num_good = 0;
+    for (size_t i = 0; i < 100; i++){
+        rx_stream->recv(&buff.front(), buff.size(), md, 1.0);
+        if (md.error_code == rx_metadata_t::ERROR_CODE_OVERFLOW and md.out_of_sequence) num_seq_errors++;
+        else if (md.error_code == rx_metadata_t::ERROR_CODE_NONE) num_good++;
+    }
+    rx_stream->issue_stream_cmd(stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS);
+    BOOST_CHECK(num_seq_errors > 0);
+    BOOST_CHECK(num_good > num_seq_errors);
+}
+
+/***********************************************************************
+ * Transmit:
+ *    a timed burst is acked once played,
+ *    a burst for a time in the past is late
+ **********************************************************************/
+static bool recv_event(tx_streamer::sptr tx_stream, async_metadata_t &md, async_metadata_t::event_code_t event_code){
+    while (tx_stream->recv_async_msg(md, 1.0)){
+        if (md.event_code == event_code) return true;
+    }
+    return false;
+}
+
+BOOST_AUTO_TEST_CASE(test_sim_device_tx_bursts){
+    usrp::multi_usrp::sptr usrp = usrp::multi_usrp::make(device_addr_t("type=sim,num_chans=1"));
+    usrp->set_tx_rate(RATE);
+    tx_streamer::sptr tx_stream = usrp->get_tx_stream(stream_args_t("fc32", "sc16"));
+    usrp->set_time_now(time_spec_t(0.0));
+
+    static const size_t num_samps = 5000;
+    std::vector<std::complex<float> > buff(num_samps);
+    tx_metadata_t md;
+    md.start_of_burst = true;
+    md.end_of_burst = true;
+    md.has_time_spec = true;
+    md.time_spec = time_spec_t(0.05);
+    BOOST_CHECK_EQUAL(tx_stream->send(&buff.front(), buff.size(), md, 1.0), num_samps);
+
+    async_metadata_t async_md;
+    BOOST_REQUIRE(recv_event(tx_stream, async_md, async_metadata_t::EVENT_CODE_BURST_ACK));
+    BOOST_CHECK_EQUAL(async_md.channel, size_t(0));
+    BOOST_CHECK(async_md.has_time_spec);
+    BOOST_CHECK_EQUAL(async_md.time_spec.to_ticks(RATE), (md.time_spec + time_spec_t::from_ticks(num_samps, RATE)).to_ticks(RATE));
+    BOOST_CHECK(usrp->get_time_now() >= async_md.time_spec);
+
+    md.time_spec = usrp->get_time_now() - time_spec_t(0.01);
+    tx_stream->send(&buff.front(), buff.size(), md, 1.0);
+    BOOST_CHECK(recv_event(tx_stream, async_md, async_metadata_t::EVENT_CODE_TIME_ERROR));
+}
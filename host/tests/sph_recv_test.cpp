@@ -508,6 +508,16 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_sequence_error){
             BOOST_CHECK_EQUAL(num_samps_ret, 10 + i%10);
             num_accum_samps += num_samps_ret;
         }
+
+        //the other channels discarded the packet that channel 2 lost,
+        //the channels before it with the overflow, the ones after it next
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            const size_t drops = (
+                (i == NUM_PKTS_TO_TEST/2 and ch < 2) or
+                (i == NUM_PKTS_TO_TEST/2 + 1 and ch > 2)
+            )? 1 : 0;
+            BOOST_CHECK_EQUAL(handler.get_alignment_drops(ch), drops);
+        }
     }
 
     //subsequent receives should be a timeout
@@ -608,6 +618,257 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_time_error){
     }
 }
 
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_alignment_drops){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 100;
+    ifpi.sob = false;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 100;
+    static const size_t NUM_SAMPS_PER_BUFF = 100;
+    static const size_t NCHANNELS = 32;
+    static const size_t MAX_STALE_PKTS = 3;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate the packets, each channel starts with a few stale packets,
+    //the lower channels with the most so the alignment has to restart
+    const size_t ticks_per_pkt = ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        const size_t num_stale_pkts = MAX_STALE_PKTS - ch%(MAX_STALE_PKTS + 1);
+        ifpi.packet_count = 0;
+        for (size_t i = MAX_STALE_PKTS - num_stale_pkts; i < MAX_STALE_PKTS + NUM_PKTS_TO_TEST; i++){
+            ifpi.tsf = i*ticks_per_pkt;
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+            ifpi.packet_count++;
+        }
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //receive every aligned packet
+    std::vector<std::complex<float> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS);
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        size_t num_samps_ret = handler.recv(
+            buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+        );
+        BOOST_REQUIRE_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK_EQUAL(num_samps_ret, NUM_SAMPS_PER_BUFF);
+        BOOST_CHECK_EQUAL(metadata.time_spec.to_ticks(TICK_RATE), boost::int64_t((MAX_STALE_PKTS + i)*ticks_per_pkt));
+        //every stale packet was discarded, and counted on its channel
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            const size_t drops = (i == 0)? MAX_STALE_PKTS - ch%(MAX_STALE_PKTS + 1) : 0;
+            BOOST_CHECK_EQUAL(handler.get_alignment_drops(ch), drops);
+        }
+    }
+
+    //subsequent receives should be a timeout
+    handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true);
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+/***********************************************************************
+ * Time the alignment of synthetic 32-channel streams:
+ *    the first channels lag, they repeat the previous packet before
+ *    each packet, so every alignment settles on the stale time first;
+ *    the more channels lag, the more are thrown out when the next
+ *    channel shows the newer time (all but the last is the worst case)
+ *    run with --log_level=message to see the times
+ **********************************************************************/
+static void benchmark_sph_recv_alignment(const size_t num_lagging){
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 100;
+    ifpi.sob = false;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 1000;
+    static const size_t NUM_SAMPS_PER_BUFF = 100;
+    static const size_t NCHANNELS = 32;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate the packets, the lagging channels repeat the previous one
+    const size_t ticks_per_pkt = ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        ifpi.packet_count = 0;
+        for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+            if (ch < num_lagging and i > 0){
+                ifpi.tsf = (i - 1)*ticks_per_pkt;
+                dummy_recv_xports[ch].push_back_packet(ifpi);
+                ifpi.packet_count++;
+            }
+            ifpi.tsf = i*ticks_per_pkt;
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+            ifpi.packet_count++;
+        }
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //receive every aligned packet and time it
+    std::vector<std::complex<float> > mem(NUM_SAMPS_PER_BUFF*NCHANNELS);
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    size_t num_drops = 0;
+    const uhd::time_spec_t start_time = uhd::time_spec_t::get_system_time();
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        handler.recv(buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true);
+        BOOST_REQUIRE_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        for (size_t ch = 0; ch < NCHANNELS; ch++) num_drops += handler.get_alignment_drops(ch);
+    }
+    const double elapsed = (uhd::time_spec_t::get_system_time() - start_time).get_real_secs();
+    BOOST_CHECK_EQUAL(num_drops, num_lagging*(NUM_PKTS_TO_TEST - 1));
+    BOOST_TEST_MESSAGE(boost::format(
+        "aligned %u packets on %u channels with %u lagging in %f ms (%f us per packet)"
+    ) % NUM_PKTS_TO_TEST % NCHANNELS % num_lagging % (elapsed*1e3) % (elapsed*1e6/NUM_PKTS_TO_TEST));
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_alignment_benchmark){
+////////////////////////////////////////////////////////////////////////
+    benchmark_sph_recv_alignment(0);
+    benchmark_sph_recv_alignment(1);
+    benchmark_sph_recv_alignment(31);
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_alignment_drops_full_buff){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "fc32";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 10;
+    ifpi.sob = false;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate the packets, channel 1 repeats an old packet once
+    //and channel 3 twice, in the middle of the stream
+    const size_t ticks_per_pkt = ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        ifpi.packet_count = 0;
+        for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+            if ((ch == 1 and i == 10) or (ch == 3 and (i == 5 or i == 20))){
+                ifpi.tsf = (i - 1)*ticks_per_pkt;
+                dummy_recv_xports[ch].push_back_packet(ifpi);
+                ifpi.packet_count++;
+            }
+            ifpi.tsf = i*ticks_per_pkt;
+            dummy_recv_xports[ch].push_back_packet(ifpi);
+            ifpi.packet_count++;
+        }
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //receive all packets in one call, the drops of every packet count
+    const size_t num_samps = NUM_PKTS_TO_TEST*ifpi.num_payload_words32;
+    std::vector<std::complex<float> > mem(num_samps*NCHANNELS);
+    std::vector<std::complex<float> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*num_samps];
+    }
+    uhd::rx_metadata_t metadata;
+    size_t num_samps_ret = handler.recv(
+        buffs, num_samps, metadata, 1.0, false
+    );
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+    BOOST_CHECK_EQUAL(num_samps_ret, num_samps);
+    BOOST_CHECK_EQUAL(metadata.time_spec.to_ticks(TICK_RATE), 0);
+    BOOST_CHECK_EQUAL(handler.get_alignment_drops(0), 0UL);
+    BOOST_CHECK_EQUAL(handler.get_alignment_drops(1), 1UL);
+    BOOST_CHECK_EQUAL(handler.get_alignment_drops(2), 0UL);
+    BOOST_CHECK_EQUAL(handler.get_alignment_drops(3), 2UL);
+
+    //subsequent receives should be a timeout, without drops
+    handler.recv(buffs, num_samps, metadata, 1.0, true);
+    BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        BOOST_CHECK_EQUAL(handler.get_alignment_drops(ch), 0UL);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////
 BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_fragment){
 ////////////////////////////////////////////////////////////////////////
@@ -702,3 +963,102 @@ BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_fragment){
     }
 
 }
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_recv_multi_channel_zero_copy){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16_item32_be";
+    id.num_inputs = 1;
+    id.output_format = "sc16";
+    id.num_outputs = 1;
+
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    ifpi.packet_type = uhd::transport::vrt::if_packet_info_t::PACKET_TYPE_DATA;
+    ifpi.num_payload_words32 = 0;
+    ifpi.packet_count = 0;
+    ifpi.sob = true;
+    ifpi.eob = false;
+    ifpi.has_sid = false;
+    ifpi.has_cid = false;
+    ifpi.has_tsi = true;
+    ifpi.has_tsf = true;
+    ifpi.tsi = 0;
+    ifpi.tsf = 0;
+    ifpi.has_tlr = false;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 30;
+    static const size_t NUM_SAMPS_PER_BUFF = 10;
+    static const size_t NCHANNELS = 4;
+
+    std::vector<dummy_recv_xport_class> dummy_recv_xports(NCHANNELS, dummy_recv_xport_class("big"));
+
+    //generate a bunch of packets, the first word tells the channel
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        ifpi.num_payload_words32 = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            dummy_recv_xports[ch].push_back_packet(ifpi, ch + 1);
+        }
+        ifpi.packet_count++;
+        ifpi.tsf += ifpi.num_payload_words32*size_t(TICK_RATE/SAMP_RATE);
+    }
+
+    //create the super receive packet handler
+    uhd::transport::sph::recv_packet_handler handler(NCHANNELS);
+    handler.set_vrt_unpacker(&uhd::transport::vrt::if_hdr_unpack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_recv_xport_class::get_recv_buff, &dummy_recv_xports[ch], _1));
+    }
+    handler.set_converter(id);
+
+    //lend every other packet, copy the first samples of the others
+    size_t num_accum_samps = 0;
+    std::complex<short> mem[NUM_SAMPS_PER_BUFF*NCHANNELS];
+    std::vector<std::complex<short> *> buffs(NCHANNELS);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        buffs[ch] = &mem[ch*NUM_SAMPS_PER_BUFF];
+    }
+    uhd::rx_metadata_t metadata;
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        std::cout << "data check " << i << std::endl;
+        size_t fragment_offset = 0;
+        if (i%2 == 1){
+            fragment_offset = handler.recv(
+                buffs, NUM_SAMPS_PER_BUFF, metadata, 1.0, true
+            );
+            BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+            BOOST_CHECK_EQUAL(fragment_offset, 10UL);
+            num_accum_samps += fragment_offset;
+            if (not metadata.more_fragments) continue;
+        }
+
+        uhd::rx_zero_copy_buffs::sptr zc_buffs = handler.recv_zero_copy(metadata, 1.0);
+        BOOST_REQUIRE(zc_buffs);
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_NONE);
+        BOOST_CHECK(not metadata.more_fragments);
+        BOOST_CHECK_EQUAL(metadata.fragment_offset, fragment_offset);
+        BOOST_CHECK(metadata.has_time_spec);
+        BOOST_CHECK_TS_CLOSE(metadata.time_spec, uhd::time_spec_t::from_ticks(num_accum_samps, SAMP_RATE));
+        BOOST_CHECK_EQUAL(zc_buffs->get_num_channels(), NCHANNELS);
+        BOOST_CHECK_EQUAL(zc_buffs->get_num_samps(), 10 + i%10 - fragment_offset);
+        if (fragment_offset == 0) for (size_t ch = 0; ch < NCHANNELS; ch++){
+            const boost::uint32_t word = boost::uint32_t(ch + 1);
+            BOOST_CHECK_EQUAL(static_cast<const boost::uint32_t *>(zc_buffs->get(ch))[0], word | uhd::byteswap(word));
+        }
+        num_accum_samps += zc_buffs->get_num_samps();
+        zc_buffs->release();
+        BOOST_CHECK(zc_buffs->get(0) == NULL);
+    }
+
+    //subsequent receives should be a timeout
+    for (size_t i = 0; i < 3; i++){
+        std::cout << "timeout check " << i << std::endl;
+        BOOST_CHECK(not handler.recv_zero_copy(metadata, 1.0));
+        BOOST_CHECK_EQUAL(metadata.error_code, uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    }
+
+}
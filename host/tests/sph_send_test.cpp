@@ -67,6 +67,10 @@ public:
         _lens.pop_front();
     }
 
+    const boost::uint32_t *front_packet(void){
+        return reinterpret_cast<const boost::uint32_t *>(_mems.front().get());
+    }
+
     uhd::transport::managed_send_buffer::sptr get_send_buff(double){
         _msbs.push_back(boost::shared_ptr<dummy_msb>(new dummy_msb()));
         _mems.push_back(boost::shared_array<char>(new char[1000]));
@@ -190,3 +194,194 @@ BOOST_AUTO_TEST_CASE(test_sph_send_one_channel_full_buffer_mode){
         num_accum_samps += ifpi.num_payload_words32;
     }
 }
+
+////////////////////////////////////////////////////////////////////////
+static void count_flush(size_t *num_flushes){
+    (*num_flushes)++;
+}
+
+BOOST_AUTO_TEST_CASE(test_sph_send_flush_end_of_burst){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "fc32";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_be";
+    id.num_outputs = 1;
+
+    dummy_send_xport_class dummy_send_xport("big");
+    size_t num_flushes = 0;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(100e6);
+    handler.set_samp_rate(10e6);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_xport_chan_flush(0, boost::bind(&count_flush, &num_flushes));
+    handler.set_converter(id);
+    handler.set_max_samples_per_packet(20);
+
+    std::vector<std::complex<float> > buff(50);
+    uhd::tx_metadata_t metadata;
+
+    //continuous streaming is not flushed
+    metadata.start_of_burst = true;
+    handler.send(&buff.front(), buff.size(), metadata, 1.0);
+    metadata.start_of_burst = false;
+    handler.send(&buff.front(), buff.size(), metadata, 1.0);
+    BOOST_CHECK_EQUAL(num_flushes, size_t(0));
+
+    //timed sends are flushed
+    metadata.has_time_spec = true;
+    handler.send(&buff.front(), buff.size(), metadata, 1.0);
+    BOOST_CHECK_EQUAL(num_flushes, size_t(1));
+
+    //the end of a burst is flushed
+    metadata.has_time_spec = false;
+    metadata.end_of_burst = true;
+    handler.send(&buff.front(), 0, metadata, 1.0);
+    BOOST_CHECK_EQUAL(num_flushes, size_t(2));
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_zero_copy){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_be";
+    id.num_outputs = 1;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_PKTS_TO_TEST = 10;
+    static const size_t NCHANNELS = 2;
+
+    std::vector<dummy_send_xport_class> dummy_send_xports(NCHANNELS, dummy_send_xport_class("big"));
+    size_t num_flushes = 0;
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(NCHANNELS);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        handler.set_xport_chan_get_buff(ch, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xports[ch], _1));
+    }
+    handler.set_xport_chan_flush(0, boost::bind(&count_flush, &num_flushes));
+    handler.set_converter(id);
+    handler.set_max_samples_per_packet(20);
+
+    //fill the packets in place, the first one is timed
+    uhd::tx_metadata_t metadata;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(0.0);
+    for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+        metadata.start_of_burst = (i == 0);
+        metadata.end_of_burst = (i == NUM_PKTS_TO_TEST-1);
+        uhd::tx_zero_copy_buffs::sptr buffs = handler.acquire_send_buffs(1.0);
+        BOOST_REQUIRE(buffs);
+        BOOST_CHECK_EQUAL(buffs->get_num_channels(), NCHANNELS);
+        BOOST_CHECK_EQUAL(buffs->get_num_samps(), 20UL);
+        const size_t nsamps = 10 + i%10;
+        for (size_t ch = 0; ch < NCHANNELS; ch++){
+            boost::uint32_t *payload = static_cast<boost::uint32_t *>(buffs->get(ch));
+            for (size_t n = 0; n < nsamps; n++) payload[n] = boost::uint32_t(ch*1000 + i*100 + n);
+        }
+        BOOST_CHECK_EQUAL(handler.commit_send_buffs(buffs, nsamps, metadata), nsamps);
+        BOOST_CHECK(buffs->get(0) == NULL);
+        BOOST_CHECK_THROW(handler.commit_send_buffs(buffs, nsamps, metadata), uhd::runtime_error);
+        metadata.has_time_spec = false;
+    }
+    BOOST_CHECK_EQUAL(num_flushes, size_t(2));
+
+    //check the sent packets
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    for (size_t ch = 0; ch < NCHANNELS; ch++){
+        for (size_t i = 0; i < NUM_PKTS_TO_TEST; i++){
+            std::cout << "data check " << ch << " " << i << std::endl;
+            const boost::uint32_t *packet = dummy_send_xports[ch].front_packet();
+            dummy_send_xports[ch].pop_front_packet(ifpi);
+            BOOST_CHECK_EQUAL(ifpi.num_payload_words32, 10+i%10);
+            BOOST_CHECK_EQUAL(ifpi.packet_count, i);
+            BOOST_CHECK_EQUAL(ifpi.has_tsf, i == 0);
+            BOOST_CHECK_EQUAL(ifpi.sob, i == 0);
+            BOOST_CHECK_EQUAL(ifpi.eob, i == NUM_PKTS_TO_TEST-1);
+            BOOST_CHECK_EQUAL(packet[ifpi.num_header_words32], boost::uint32_t(ch*1000 + i*100));
+            BOOST_CHECK_EQUAL(packet[ifpi.num_header_words32 + ifpi.num_payload_words32 - 1], boost::uint32_t(ch*1000 + i*100 + 9 + i%10));
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(test_sph_send_zero_copy_start_of_burst){
+////////////////////////////////////////////////////////////////////////
+    uhd::convert::id_type id;
+    id.input_format = "sc16";
+    id.num_inputs = 1;
+    id.output_format = "sc16_item32_be";
+    id.num_outputs = 1;
+
+    static const double TICK_RATE = 100e6;
+    static const double SAMP_RATE = 10e6;
+    static const size_t NUM_SAMPS = 15;
+
+    dummy_send_xport_class dummy_send_xport("big");
+
+    //create the super send packet handler
+    uhd::transport::sph::send_packet_handler handler(1);
+    handler.set_vrt_packer(&uhd::transport::vrt::if_hdr_pack_be);
+    handler.set_tick_rate(TICK_RATE);
+    handler.set_samp_rate(SAMP_RATE);
+    handler.set_xport_chan_get_buff(0, boost::bind(&dummy_send_xport_class::get_send_buff, &dummy_send_xport, _1));
+    handler.set_converter(id);
+    handler.set_max_samples_per_packet(20);
+
+    //a timed start of burst without samples is held for the next commit
+    uhd::tx_metadata_t metadata;
+    metadata.start_of_burst = true;
+    metadata.has_time_spec = true;
+    metadata.time_spec = uhd::time_spec_t(1.5);
+    uhd::tx_zero_copy_buffs::sptr buffs = handler.acquire_send_buffs(1.0);
+    BOOST_REQUIRE(buffs);
+    BOOST_CHECK_EQUAL(handler.commit_send_buffs(buffs, 0, metadata), 0UL);
+    BOOST_CHECK(buffs->get(0) != NULL);
+
+    //the samples follow in the same buffer
+    BOOST_CHECK(handler.acquire_send_buffs(1.0) == buffs);
+    boost::uint32_t *payload = static_cast<boost::uint32_t *>(buffs->get(0));
+    for (size_t n = 0; n < NUM_SAMPS; n++) payload[n] = boost::uint32_t(100 + n);
+    metadata.start_of_burst = false;
+    metadata.has_time_spec = false;
+    BOOST_CHECK_EQUAL(handler.commit_send_buffs(buffs, NUM_SAMPS, metadata), NUM_SAMPS);
+
+    //the end of burst goes with the next packet
+    buffs = handler.acquire_send_buffs(1.0);
+    BOOST_REQUIRE(buffs);
+    payload = static_cast<boost::uint32_t *>(buffs->get(0));
+    for (size_t n = 0; n < NUM_SAMPS; n++) payload[n] = boost::uint32_t(200 + n);
+    metadata.end_of_burst = true;
+    BOOST_CHECK_EQUAL(handler.commit_send_buffs(buffs, NUM_SAMPS, metadata), NUM_SAMPS);
+
+    //the first packet has the time of the start of burst and no padding
+    uhd::transport::vrt::if_packet_info_t ifpi;
+    const boost::uint32_t *packet = dummy_send_xport.front_packet();
+    dummy_send_xport.pop_front_packet(ifpi);
+    BOOST_CHECK_EQUAL(ifpi.num_payload_words32, NUM_SAMPS);
+    BOOST_CHECK_EQUAL(ifpi.packet_count, 0UL);
+    BOOST_CHECK(ifpi.has_tsf);
+    BOOST_CHECK_EQUAL(ifpi.tsf, boost::uint64_t(uhd::time_spec_t(1.5).to_ticks(TICK_RATE)));
+    BOOST_CHECK(ifpi.sob);
+    BOOST_CHECK(not ifpi.eob);
+    BOOST_CHECK_EQUAL(packet[ifpi.num_header_words32], boost::uint32_t(100));
+    BOOST_CHECK_EQUAL(packet[ifpi.num_header_words32 + NUM_SAMPS - 1], boost::uint32_t(100 + NUM_SAMPS - 1));
+
+    packet = dummy_send_xport.front_packet();
+    dummy_send_xport.pop_front_packet(ifpi);
+    BOOST_CHECK_EQUAL(ifpi.num_payload_words32, NUM_SAMPS);
+    BOOST_CHECK_EQUAL(ifpi.packet_count, 1UL);
+    BOOST_CHECK(not ifpi.has_tsf);
+    BOOST_CHECK(not ifpi.sob);
+    BOOST_CHECK(ifpi.eob);
+    BOOST_CHECK_EQUAL(packet[ifpi.num_header_words32], boost::uint32_t(200));
+}
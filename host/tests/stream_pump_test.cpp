@@ -0,0 +1,189 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/stream_pump.hpp>
+#include <uhd/exception.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+#include <complex>
+#include <vector>
+
+using namespace uhd;
+
+static const size_t NUM_BATCHES = 50;
+static const double SAMP_RATE = 1e6;
+
+/***********************************************************************
+ * A dummy rx streamer that counts up the samples of two channels
+ **********************************************************************/
+class dummy_rx_streamer : public rx_streamer{
+public:
+    dummy_rx_streamer(void): _num_samps(0), _num_batches(0){}
+
+    size_t get_num_channels(void) const{
+        return 2;
+    }
+
+    size_t get_max_num_samps(void) const{
+        return 100;
+    }
+
+    size_t get_cpu_item_size(void) const{
+        return sizeof(std::complex<short>);
+    }
+
+    size_t recv(
+        const buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        rx_metadata_t &metadata,
+        const double timeout,
+        const bool
+    ){
+        metadata.reset();
+        if (_num_batches == NUM_BATCHES){
+            boost::this_thread::sleep(boost::posix_time::microseconds(long(timeout*1e6)));
+            metadata.error_code = rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        for (size_t ch = 0; ch < buffs.size(); ch++){
+            std::complex<short> *buff = reinterpret_cast<std::complex<short> *>(buffs[ch]);
+            for (size_t i = 0; i < nsamps_per_buff; i++){
+                buff[i] = std::complex<short>(short(_num_samps + i), short(ch));
+            }
+        }
+        metadata.has_time_spec = true;
+        metadata.time_spec = time_spec_t::from_ticks(_num_samps, SAMP_RATE);
+        _num_samps += nsamps_per_buff;
+        _num_batches++;
+        return nsamps_per_buff;
+    }
+
+    void issue_stream_cmd(const stream_cmd_t &){}
+
+private:
+    size_t _num_samps, _num_batches;
+};
+
+/***********************************************************************
+ * A sink that checks the batches for gaps
+ **********************************************************************/
+struct dummy_sink{
+    dummy_sink(const size_t busy_every = 0):
+        busy_every(busy_every), num_calls(0), num_batches(0), num_samps(0), errors(0){}
+
+    rx_stream_pump::sink_result_t sink(
+        const rx_stream_pump::buffs_type &buffs,
+        const size_t nsamps_per_buff,
+        const rx_metadata_t &metadata
+    ){
+        boost::mutex::scoped_lock lock(mutex);
+        if (busy_every != 0 and ++num_calls % busy_every != 0) return rx_stream_pump::SINK_BUSY;
+        const std::complex<short> *buff0 = reinterpret_cast<const std::complex<short> *>(buffs[0]);
+        const std::complex<short> *buff1 = reinterpret_cast<const std::complex<short> *>(buffs[1]);
+        if (buff0[0].real() != short(num_samps)) errors++;
+        if (buff1[nsamps_per_buff-1] != std::complex<short>(short(num_samps + nsamps_per_buff - 1), 1)) errors++;
+        if (metadata.time_spec.to_ticks(SAMP_RATE) != (long long)(num_samps)) errors++;
+        num_samps += nsamps_per_buff;
+        num_batches++;
+        return rx_stream_pump::SINK_CONSUMED;
+    }
+
+    size_t get_num_batches(void){
+        boost::mutex::scoped_lock lock(mutex);
+        return num_batches;
+    }
+
+    boost::mutex mutex;
+    const size_t busy_every;
+    size_t num_calls, num_batches, num_samps, errors;
+};
+
+static rx_stream_pump::sink_result_t detach_sink(size_t *num_calls){
+    (*num_calls)++;
+    return rx_stream_pump::SINK_DETACH;
+}
+
+static void wait_for_batches(dummy_sink &sink){
+    for (size_t i = 0; i < 1000 and sink.get_num_batches() < NUM_BATCHES; i++){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_stream_pump_fan_out){
+    stream_args_t stream_args("sc16", "sc16");
+    stream_args.args["pump_batch_nsamps"] = "64";
+    stream_args.args["pump_recv_timeout"] = "0.01";
+    rx_stream_pump::sptr pump = rx_stream_pump::make(rx_streamer::sptr(new dummy_rx_streamer()), stream_args);
+
+    dummy_sink sink0, sink1;
+    size_t num_detach_calls = 0;
+    pump->add_sink(boost::bind(&dummy_sink::sink, &sink0, _1, _2, _3));
+    pump->add_sink(boost::bind(&dummy_sink::sink, &sink1, _1, _2, _3));
+    pump->add_sink(boost::bind(&detach_sink, &num_detach_calls));
+    pump->start();
+    wait_for_batches(sink0);
+    wait_for_batches(sink1);
+    pump->stop();
+
+    BOOST_CHECK_EQUAL(sink0.num_batches, NUM_BATCHES);
+    BOOST_CHECK_EQUAL(sink1.num_batches, NUM_BATCHES);
+    BOOST_CHECK_EQUAL(sink0.num_samps, NUM_BATCHES*64);
+    BOOST_CHECK_EQUAL(sink0.errors, size_t(0));
+    BOOST_CHECK_EQUAL(sink1.errors, size_t(0));
+    BOOST_CHECK_EQUAL(num_detach_calls, size_t(1));
+    BOOST_CHECK_EQUAL(pump->get_num_stalls(), size_t(0));
+}
+
+BOOST_AUTO_TEST_CASE(test_stream_pump_back_pressure){
+    stream_args_t stream_args("sc16", "sc16");
+    stream_args.args["pump_recv_timeout"] = "0.01";
+    stream_args.args["pump_busy_retry_us"] = "10";
+    rx_stream_pump::sptr pump = rx_stream_pump::make(rx_streamer::sptr(new dummy_rx_streamer()), stream_args);
+
+    //the slow sink takes every third offer, yet no batch is lost
+    dummy_sink fast_sink, slow_sink(3);
+    pump->add_sink(boost::bind(&dummy_sink::sink, &fast_sink, _1, _2, _3));
+    const size_t slow_id = pump->add_sink(boost::bind(&dummy_sink::sink, &slow_sink, _1, _2, _3));
+    pump->start();
+    wait_for_batches(slow_sink);
+    pump->stop();
+
+    BOOST_CHECK_EQUAL(fast_sink.num_batches, NUM_BATCHES);
+    BOOST_CHECK_EQUAL(slow_sink.num_batches, NUM_BATCHES);
+    BOOST_CHECK_EQUAL(slow_sink.num_samps, NUM_BATCHES*100);
+    BOOST_CHECK_EQUAL(fast_sink.errors, size_t(0));
+    BOOST_CHECK_EQUAL(slow_sink.errors, size_t(0));
+    BOOST_CHECK_EQUAL(pump->get_num_stalls(), 2*NUM_BATCHES);
+
+    //a removed sink is not called anymore
+    pump->remove_sink(slow_id);
+    pump->start();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    pump->stop();
+    BOOST_CHECK_EQUAL(slow_sink.num_calls, 3*NUM_BATCHES);
+}
+
+BOOST_AUTO_TEST_CASE(test_stream_pump_format_mismatch){
+    //the buffers would be too small for the samples of the streamer
+    stream_args_t stream_args("sc8", "sc16");
+    BOOST_CHECK_THROW(
+        rx_stream_pump::make(rx_streamer::sptr(new dummy_rx_streamer()), stream_args),
+        uhd::value_error
+    );
+}
@@ -0,0 +1,107 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/tcp_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <uhd/utils/byteswap.hpp>
+#include <uhd/exception.hpp>
+#include <boost/asio.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <deque>
+#include <vector>
+
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * Loopback through localhost:
+ *    a plain socket writes a stream of packets in chunks that do not
+ *    line up with the packets, the transport must split the stream into
+ *    the packets again, also across the end of its small receive ring,
+ *    while the caller holds on to a few of the previous buffers
+ **********************************************************************/
+static void test_tcp_zero_copy_framing(const std::string &framing){
+    const bool len_in_words = framing.find("vrt") == 0;
+    const bool little_endian = framing.find("_le") != std::string::npos;
+
+    asio::io_service io_service;
+    asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(acceptor.local_endpoint().port());
+    zero_copy_if::sptr xport = tcp_zero_copy::make("127.0.0.1", port, uhd::device_addr_t(
+        "framing=" + framing + ",recv_ring_size=4096,recv_frame_size=1024,num_recv_frames=8"
+    ));
+    asio::ip::tcp::socket peer(io_service);
+    acceptor.accept(peer);
+
+    //packets of 2 to 256 words, the first word is the header with the length
+    static const size_t num_packets = 200;
+    std::vector<boost::uint32_t> stream;
+    for (size_t i = 0; i < num_packets; i++){
+        const size_t num_words = i%255 + 2;
+        const boost::uint32_t len = boost::uint32_t((len_in_words)? num_words : num_words*sizeof(boost::uint32_t));
+        stream.push_back((little_endian)? uhd::htowx(len) : uhd::htonx(len));
+        stream.insert(stream.end(), num_words - 1, boost::uint32_t(i));
+    }
+    const size_t num_bytes = stream.size()*sizeof(boost::uint32_t);
+    for (size_t offset = 0; offset < num_bytes; offset += 1000){
+        asio::write(peer, asio::buffer(reinterpret_cast<const char *>(&stream.front()) + offset, std::min<size_t>(1000, num_bytes - offset)));
+    }
+
+    std::deque<managed_recv_buffer::sptr> held_buffs;
+    for (size_t i = 0; i < num_packets; i++){
+        const size_t num_words = i%255 + 2;
+        managed_recv_buffer::sptr recv_buff = xport->get_recv_buff(1.0);
+        BOOST_REQUIRE(recv_buff);
+        BOOST_REQUIRE_EQUAL(recv_buff->size(), num_words*sizeof(boost::uint32_t));
+        BOOST_CHECK_EQUAL(recv_buff->cast<const boost::uint32_t *>()[1], boost::uint32_t(i));
+        BOOST_CHECK_EQUAL(recv_buff->cast<const boost::uint32_t *>()[num_words - 1], boost::uint32_t(i));
+        held_buffs.push_back(recv_buff);
+        if (held_buffs.size() > 5) held_buffs.pop_front();
+    }
+    held_buffs.clear();
+
+    //nothing left, must time out
+    BOOST_CHECK(not xport->get_recv_buff(0.01));
+
+    //frames are sent with the committed length
+    for (size_t i = 0; i < 3; i++){
+        managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+        BOOST_REQUIRE(send_buff);
+        send_buff->cast<boost::uint32_t *>()[0] = boost::uint32_t(i);
+        send_buff->commit(sizeof(boost::uint32_t));
+    }
+    boost::uint32_t frames[3];
+    asio::read(peer, asio::buffer(frames, sizeof(frames)));
+    for (size_t i = 0; i < 3; i++) BOOST_CHECK_EQUAL(frames[i], boost::uint32_t(i));
+
+    //a length beyond the frame size means the stream is out of sync
+    const boost::uint32_t bad_header = (little_endian)? uhd::htowx(boost::uint32_t(0xffff)) : uhd::htonx(boost::uint32_t(0xffff));
+    asio::write(peer, asio::buffer(&bad_header, sizeof(bad_header)));
+    BOOST_CHECK_THROW(xport->get_recv_buff(1.0), uhd::io_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_tcp_zero_copy_framing_chdr){
+    test_tcp_zero_copy_framing("chdr");
+    test_tcp_zero_copy_framing("chdr_le");
+}
+
+BOOST_AUTO_TEST_CASE(test_tcp_zero_copy_framing_vrt){
+    test_tcp_zero_copy_framing("vrt");
+    test_tcp_zero_copy_framing("vrt_le");
+}
@@ -0,0 +1,423 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <boost/test/unit_test.hpp>
+#include <uhd/transport/udp_zero_copy.hpp>
+#include <uhd/types/device_addr.hpp>
+#include <boost/asio.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <vector>
+#include <ctime>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/udp.h> //UDP_SEGMENT
+#include <cstring>
+#endif
+
+using namespace uhd::transport;
+namespace asio = boost::asio;
+
+/***********************************************************************
+ * Loopback through localhost:
+ *    a plain socket sends frames of different lengths to a udp zero
+ *    copy transport, which must hand them out in order and unchanged,
+ *    while the caller holds on to a few of the previous buffers,
+ *    the transport counters must add up to the exchanged frames,
+ *    with receive timestamps every frame has its arrival time
+ **********************************************************************/
+static void test_udp_zero_copy_recv(const std::string &hints, const size_t num_frames){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    zero_copy_if::sptr xport = udp_zero_copy::make("127.0.0.1", port, params, buff_params, uhd::device_addr_t(hints));
+    const zero_copy_counters start = xport->get_counters();
+
+    //let the peer learn the transport's address
+    managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+    BOOST_REQUIRE(send_buff);
+    send_buff->commit(4);
+    send_buff.reset();
+    char hello[16];
+    asio::ip::udp::endpoint xport_endpoint;
+    BOOST_REQUIRE_EQUAL(peer.receive_from(asio::buffer(hello), xport_endpoint), size_t(4));
+
+    #ifdef __linux__
+    const bool timestamps = uhd::device_addr_t(hints).get("recv_timestamps", "0") != "0";
+    #else
+    const bool timestamps = false;
+    #endif
+    const std::time_t send_time = std::time(NULL);
+    for (size_t i = 0; i < num_frames; i++){
+        const std::vector<boost::uint32_t> frame(i%7 + 1, boost::uint32_t(i));
+        peer.send_to(asio::buffer(frame), xport_endpoint);
+    }
+
+    std::deque<managed_recv_buffer::sptr> held_buffs;
+    size_t num_bytes = 0;
+    for (size_t i = 0; i < num_frames; i++){
+        managed_recv_buffer::sptr recv_buff = xport->get_recv_buff(1.0);
+        BOOST_REQUIRE(recv_buff);
+        BOOST_CHECK_EQUAL(recv_buff->size(), (i%7 + 1)*sizeof(boost::uint32_t));
+        BOOST_CHECK_EQUAL(recv_buff->cast<const boost::uint32_t *>()[i%7], boost::uint32_t(i));
+        BOOST_CHECK_EQUAL(recv_buff->has_recv_time(), timestamps);
+        if (timestamps){
+            BOOST_CHECK(recv_buff->get_recv_time().get_full_secs() >= send_time);
+            BOOST_CHECK(recv_buff->get_recv_time().get_full_secs() <= std::time(NULL));
+        }
+        num_bytes += recv_buff->size();
+        held_buffs.push_back(recv_buff);
+        if (held_buffs.size() > 5) held_buffs.pop_front();
+    }
+    held_buffs.clear();
+
+    //nothing left, must time out
+    BOOST_CHECK(not xport->get_recv_buff(0.01));
+
+    const zero_copy_counters counters = xport->get_counters();
+    BOOST_CHECK_EQUAL(counters.recv_packets - start.recv_packets, boost::uint64_t(num_frames));
+    BOOST_CHECK_EQUAL(counters.recv_bytes - start.recv_bytes, boost::uint64_t(num_bytes));
+    BOOST_CHECK_EQUAL(counters.recv_timeouts - start.recv_timeouts, boost::uint64_t(1));
+    BOOST_CHECK_EQUAL(counters.recv_frames_released, counters.recv_packets);
+    BOOST_CHECK_EQUAL(counters.recv_frames_in_use_max, size_t(6));
+    BOOST_CHECK(counters.recv_wait_time > start.recv_wait_time);
+    BOOST_CHECK_EQUAL(counters.send_packets - start.send_packets, boost::uint64_t(1));
+    BOOST_CHECK_EQUAL(counters.send_bytes - start.send_bytes, boost::uint64_t(4));
+    BOOST_CHECK_EQUAL(counters.send_frames_in_use_max, size_t(1));
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_default){
+    test_udp_zero_copy_recv("", 40);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_batch){
+    test_udp_zero_copy_recv("recv_batch=4", 40);
+    test_udp_zero_copy_recv("recv_batch=16", 40);
+    test_udp_zero_copy_recv("recv_batch=100", 40); //limited to num_recv_frames
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_spin){
+    test_udp_zero_copy_recv("recv_spin_us=100", 40);
+    test_udp_zero_copy_recv("recv_spin_us=100,recv_batch=4", 40);
+    test_udp_zero_copy_recv("recv_spin_us=20000", 40); //longer than the timeout
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_thread){
+    test_udp_zero_copy_recv("recv_thread=1", 40);
+    test_udp_zero_copy_recv("recv_thread=1,recv_spin_us=100", 40);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_timestamps){
+    test_udp_zero_copy_recv("recv_timestamps=1", 40);
+    test_udp_zero_copy_recv("recv_timestamps=1,recv_batch=4", 40);
+    test_udp_zero_copy_recv("recv_timestamps=1,recv_thread=1", 40);
+    test_udp_zero_copy_recv("recv_timestamps=hw", 40); //loopback has software times only
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_io_uring){
+    //falls back to recv and send calls when io_uring is not available
+    test_udp_zero_copy_recv("recv_io_uring=1,send_io_uring=1", 100);
+}
+
+/***********************************************************************
+ * Loopback to a closed port:
+ *    the frame sent while the caller waits comes back as a refused
+ *    connection, the receive returns a null buffer within the timeout
+ **********************************************************************/
+static void send_late(zero_copy_if::sptr xport){
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+    if (send_buff) send_buff->commit(4);
+}
+
+static void test_udp_zero_copy_refused(const std::string &hints){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+    peer.close();
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    zero_copy_if::sptr xport = udp_zero_copy::make("127.0.0.1", port, params, buff_params, uhd::device_addr_t(hints));
+
+    boost::thread sender(&send_late, xport);
+    const boost::system_time start = boost::get_system_time();
+    managed_recv_buffer::sptr recv_buff;
+    BOOST_CHECK_NO_THROW(recv_buff = xport->get_recv_buff(0.5));
+    BOOST_CHECK(not recv_buff);
+    BOOST_CHECK((boost::get_system_time() - start).total_milliseconds() < 1000);
+    sender.join();
+
+    //the error is gone, the next receive times out
+    BOOST_CHECK(not xport->get_recv_buff(0.01));
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_refused){
+    test_udp_zero_copy_refused("recv_batch=4");
+    test_udp_zero_copy_refused("recv_thread=1");
+    #ifdef __linux__
+    test_udp_zero_copy_refused("recv_gro=1");
+    #endif
+}
+
+/***********************************************************************
+ * Loopback through localhost:
+ *    a udp zero copy transport sends committed frames in batches,
+ *    when a batch is full, on flush, or after the batch timeout
+ **********************************************************************/
+static bool wait_for_frame(asio::ip::udp::socket &peer){
+    for (size_t i = 0; i < 100 and peer.available() == 0; i++){
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    return peer.available() != 0;
+}
+
+static void send_frames(zero_copy_if::sptr xport, size_t &seq, const size_t num_frames){
+    for (size_t i = 0; i < num_frames; i++){
+        managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+        BOOST_REQUIRE(send_buff);
+        send_buff->cast<boost::uint32_t *>()[0] = boost::uint32_t(seq++);
+        send_buff->commit(sizeof(boost::uint32_t));
+    }
+}
+
+static void check_frames(asio::ip::udp::socket &peer, size_t &seq, const size_t num_frames){
+    for (size_t i = 0; i < num_frames; i++){
+        boost::uint32_t frame = 0;
+        BOOST_REQUIRE(wait_for_frame(peer));
+        BOOST_REQUIRE_EQUAL(peer.receive(asio::buffer(&frame, sizeof(frame))), sizeof(frame));
+        BOOST_CHECK_EQUAL(frame, boost::uint32_t(seq++));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_send_batch){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    udp_zero_copy::sptr xport = udp_zero_copy::make(
+        "127.0.0.1", port, params, buff_params, uhd::device_addr_t("send_batch=4,send_batch_timeout=100")
+    );
+    size_t send_seq = 0, recv_seq = 0;
+
+    //a partial batch is held back, the full batch is sent
+    send_frames(xport, send_seq, 3);
+    BOOST_CHECK(not wait_for_frame(peer));
+    send_frames(xport, send_seq, 1);
+    check_frames(peer, recv_seq, 4);
+
+    //more frames than buffers, in full batches
+    send_frames(xport, send_seq, 40);
+    check_frames(peer, recv_seq, 40);
+
+    //a flush sends a partial batch
+    send_frames(xport, send_seq, 2);
+    xport->flush_send_buffs();
+    check_frames(peer, recv_seq, 2);
+
+    //the frames of a partial batch are sent when the transport goes away
+    send_frames(xport, send_seq, 1);
+    xport.reset();
+    check_frames(peer, recv_seq, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_send_batch_timeout){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    udp_zero_copy::sptr xport = udp_zero_copy::make(
+        "127.0.0.1", port, params, buff_params, uhd::device_addr_t("send_batch=8,send_batch_timeout=0.005")
+    );
+    size_t send_seq = 0, recv_seq = 0;
+
+    //a partial batch is sent after the timeout
+    send_frames(xport, send_seq, 3);
+    check_frames(peer, recv_seq, 3);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_send_io_uring){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    udp_zero_copy::sptr xport = udp_zero_copy::make(
+        "127.0.0.1", port, params, buff_params, uhd::device_addr_t("send_io_uring=1")
+    );
+    size_t send_seq = 0, recv_seq = 0;
+
+    //more frames than buffers, the frames are reused in order
+    send_frames(xport, send_seq, 100);
+    check_frames(peer, recv_seq, 100);
+
+    //the last frame is sent when the transport goes away
+    send_frames(xport, send_seq, 1);
+    xport.reset();
+    check_frames(peer, recv_seq, 1);
+}
+
+#ifdef UDP_SEGMENT
+/***********************************************************************
+ * Loopback through localhost with segmentation offload:
+ *    frames of the same size are sent as one datagram and split up
+ *    again by the kernel (send) or by the transport (receive)
+ **********************************************************************/
+static void send_frame(zero_copy_if::sptr xport, const boost::uint32_t seq, const size_t len){
+    managed_send_buffer::sptr send_buff = xport->get_send_buff(1.0);
+    BOOST_REQUIRE(send_buff);
+    std::memset(send_buff->cast<void *>(), 0, len);
+    send_buff->cast<boost::uint32_t *>()[0] = seq;
+    send_buff->commit(len);
+}
+
+static void check_frame(asio::ip::udp::socket &peer, const boost::uint32_t seq, const size_t len){
+    std::vector<boost::uint32_t> frame(1472/sizeof(boost::uint32_t));
+    BOOST_REQUIRE(wait_for_frame(peer));
+    BOOST_REQUIRE_EQUAL(peer.receive(asio::buffer(frame)), len);
+    BOOST_CHECK_EQUAL(frame[0], seq);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_send_gso){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    udp_zero_copy::sptr xport = udp_zero_copy::make(
+        "127.0.0.1", port, params, buff_params, uhd::device_addr_t("send_gso=1,send_batch=8,send_batch_timeout=100")
+    );
+
+    //a run of equal frames with a short frame at the end, then runs of different sizes
+    static const size_t lens[] = {
+        1000, 1000, 1000, 1000, 1000, 1000, 1000, 40,
+        100, 200, 200, 300, 300, 300, 8, 8,
+        1472, 1472, 1472, 1472
+    };
+    static const size_t num_frames = sizeof(lens)/sizeof(lens[0]);
+    for (size_t i = 0; i < num_frames; i++) send_frame(xport, boost::uint32_t(i), lens[i]);
+    xport->flush_send_buffs();
+    for (size_t i = 0; i < num_frames; i++) check_frame(peer, boost::uint32_t(i), lens[i]);
+}
+
+BOOST_AUTO_TEST_CASE(test_udp_zero_copy_recv_gro){
+    asio::io_service io_service;
+    asio::ip::udp::socket peer(io_service, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0));
+    const std::string port = boost::lexical_cast<std::string>(peer.local_endpoint().port());
+
+    zero_copy_xport_params params;
+    params.recv_frame_size = 1472;
+    params.send_frame_size = 1472;
+    params.num_recv_frames = 16;
+    params.num_send_frames = 16;
+    udp_zero_copy::buff_params buff_params;
+    zero_copy_if::sptr xport = udp_zero_copy::make("127.0.0.1", port, params, buff_params, uhd::device_addr_t("recv_gro=1,recv_timestamps=1"));
+
+    //let the peer learn the transport's address
+    send_frame(xport, 0, 4);
+    char hello[16];
+    asio::ip::udp::endpoint xport_endpoint;
+    BOOST_REQUIRE_EQUAL(peer.receive_from(asio::buffer(hello), xport_endpoint), size_t(4));
+    peer.connect(xport_endpoint);
+
+    //each datagram is sent by the peer as num_segs segments of seg_size bytes,
+    //the last segment is short, the transport must hand out every segment
+    static const size_t num_datagrams = 12;
+    boost::uint32_t seq = 0;
+    for (size_t i = 0; i < num_datagrams; i++){
+        const size_t num_segs = i%5 + 1, seg_size = 100*(i%3 + 1);
+        std::vector<boost::uint32_t> datagram(num_segs*seg_size/sizeof(boost::uint32_t));
+        for (size_t j = 0; j < num_segs; j++) datagram[j*seg_size/sizeof(boost::uint32_t)] = seq++;
+
+        iovec iov;
+        iov.iov_base = &datagram.front();
+        iov.iov_len = datagram.size()*sizeof(boost::uint32_t) - seg_size/2;
+        union{
+            cmsghdr hdr;
+            char buff[CMSG_SPACE(sizeof(boost::uint16_t))];
+        } control;
+        msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buff;
+        msg.msg_controllen = sizeof(control.buff);
+        cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(boost::uint16_t));
+        const boost::uint16_t gso_size = boost::uint16_t(seg_size);
+        std::memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+        BOOST_REQUIRE_EQUAL(::sendmsg(peer.native_handle(), &msg, 0), ssize_t(iov.iov_len));
+    }
+
+    //the frames are released out of order while the next ones are received
+    std::deque<managed_recv_buffer::sptr> held_buffs;
+    seq = 0;
+    for (size_t i = 0; i < num_datagrams; i++){
+        const size_t num_segs = i%5 + 1, seg_size = 100*(i%3 + 1);
+        for (size_t j = 0; j < num_segs; j++){
+            managed_recv_buffer::sptr recv_buff = xport->get_recv_buff(1.0);
+            BOOST_REQUIRE(recv_buff);
+            BOOST_CHECK_EQUAL(recv_buff->size(), (j == num_segs-1)? seg_size/2 : seg_size);
+            BOOST_CHECK_EQUAL(recv_buff->cast<const boost::uint32_t *>()[0], seq++);
+            BOOST_CHECK(recv_buff->has_recv_time());
+            held_buffs.push_back(recv_buff);
+            if (held_buffs.size() > 7) held_buffs.erase(held_buffs.begin() + held_buffs.size()/2);
+        }
+    }
+
+    //nothing left, must time out
+    BOOST_CHECK(not xport->get_recv_buff(0.01));
+}
+#endif /*UDP_SEGMENT*/
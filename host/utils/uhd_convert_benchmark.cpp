@@ -0,0 +1,282 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/convert.hpp>
+#include <uhd/exception.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/foreach.hpp>
+#include <boost/format.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+
+namespace po = boost::program_options;
+
+/***********************************************************************
+ * Parse a buffer size such as 4096, 32k, or 64M into bytes
+ **********************************************************************/
+static size_t parse_size(std::string size){
+    boost::algorithm::trim(size);
+    size_t multiplier = 1;
+    if (not size.empty()){
+        switch (size[size.size()-1]){
+        case 'k': case 'K': multiplier = 1 << 10; break;
+        case 'm': case 'M': multiplier = 1 << 20; break;
+        case 'g': case 'G': multiplier = 1 << 30; break;
+        }
+    }
+    if (multiplier != 1) size.erase(size.size()-1);
+    return boost::lexical_cast<size_t>(size)*multiplier;
+}
+
+/***********************************************************************
+ * Fill a buffer with data that makes sense for the given format:
+ * random values in [-1, 1) for host floating point types,
+ * random bytes for everything else (integer and over the wire types)
+ **********************************************************************/
+template <typename T> static void fill_floats(std::vector<char> &buff){
+    T *p = reinterpret_cast<T *>(&buff[0]);
+    for (size_t i = 0; i < buff.size()/sizeof(T); i++){
+        p[i] = (std::rand()/T(RAND_MAX/2)) - 1;
+    }
+}
+
+static void fill_buffer(std::vector<char> &buff, const std::string &format){
+    if (format == "fc32" or format == "f32") fill_floats<float>(buff);
+    else if (format == "fc64" or format == "f64") fill_floats<double>(buff);
+    else for (size_t i = 0; i < buff.size(); i++) buff[i] = char(std::rand());
+}
+
+/***********************************************************************
+ * Run one converter on one buffer size
+ **********************************************************************/
+struct benchmark_result{
+    size_t nsamps;
+    size_t bytes;
+    double ns_per_samp;
+    double gbytes_per_sec;
+    double hot_ns_per_line;
+};
+
+/***********************************************************************
+ * Read one byte of every cache line of the hot set:
+ * stands in for the packet buffers and application data that a
+ * converter evicts from the cache when it writes a large output.
+ * The time per line goes up with the number of lines that were evicted.
+ **********************************************************************/
+static const size_t CACHE_LINE_SIZE = 64;
+
+static double touch_hot_set(const std::vector<char> &hot_set, volatile char &sink){
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    char sum = 0;
+    for (size_t i = 0; i < hot_set.size(); i += CACHE_LINE_SIZE) sum ^= hot_set[i];
+    sink = sum;
+    return (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+}
+
+static benchmark_result run_benchmark(
+    const uhd::convert::id_type &id,
+    const uhd::convert::priority_type prio,
+    const size_t buff_size,
+    const double duration,
+    const size_t hot_set_size
+){
+    //split the buffer size between all inputs and outputs,
+    //a single buffer on one side holds the samples of all channels
+    //(for interleaving converters, nsamps is the number of samples per channel)
+    const size_t nchan = std::max(id.num_inputs, id.num_outputs);
+    const size_t in_bpi = uhd::convert::get_bytes_per_item(id.input_format)*nchan/id.num_inputs;
+    const size_t out_bpi = uhd::convert::get_bytes_per_item(id.output_format)*nchan/id.num_outputs;
+    const size_t bytes_per_samp = in_bpi*id.num_inputs + out_bpi*id.num_outputs;
+    const size_t nsamps = std::max<size_t>(buff_size/bytes_per_samp, 1);
+
+    //allocate and fill the buffers, with some headroom for converters that
+    //write whole items past the last sample (packed formats like sc12)
+    std::vector<std::vector<char> > in_buffs(id.num_inputs), out_buffs(id.num_outputs);
+    std::vector<const void *> inputs;
+    std::vector<void *> outputs;
+    for (size_t i = 0; i < id.num_inputs; i++){
+        in_buffs[i].resize(nsamps*in_bpi + 16);
+        fill_buffer(in_buffs[i], id.input_format);
+        inputs.push_back(&in_buffs[i].front());
+    }
+    for (size_t i = 0; i < id.num_outputs; i++){
+        out_buffs[i].resize(nsamps*out_bpi + 16);
+        outputs.push_back(&out_buffs[i].front());
+    }
+
+    uhd::convert::converter::sptr conv = uhd::convert::get_converter(id, prio)();
+    conv->set_scalar(32767.);
+
+    //the hot set is read after every conversion when requested
+    std::vector<char> hot_set(hot_set_size, 1);
+    volatile char sink = 0;
+    double hot_elapsed = 0.0;
+
+    //warm up the caches, then convert in batches of about 1M samples
+    conv->conv(inputs, outputs, nsamps);
+    const size_t batch = std::max<size_t>((1 << 20)/nsamps, 1);
+    size_t iterations = 0;
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    double elapsed = 0.0;
+    do{
+        for (size_t i = 0; i < batch; i++){
+            conv->conv(inputs, outputs, nsamps);
+            if (hot_set_size != 0) hot_elapsed += touch_hot_set(hot_set, sink);
+        }
+        iterations += batch;
+        elapsed = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+    } while (elapsed < duration);
+    elapsed -= hot_elapsed;
+
+    benchmark_result result;
+    result.nsamps = nsamps;
+    result.bytes = nsamps*bytes_per_samp;
+    result.ns_per_samp = elapsed*1e9/(double(iterations)*nsamps);
+    result.gbytes_per_sec = double(iterations)*result.bytes/elapsed/1e9;
+    result.hot_ns_per_line = (hot_set_size == 0)? 0.0 :
+        hot_elapsed*1e9/(double(iterations)*((hot_set_size + CACHE_LINE_SIZE - 1)/CACHE_LINE_SIZE));
+    return result;
+}
+
+/***********************************************************************
+ * Main
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    std::string sizes, filter, format, file, hot_set;
+    double duration;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("sizes", po::value<std::string>(&sizes)->default_value("16k,256k,4M,64M"), "comma separated list of buffer sizes in bytes (k, M, G suffixes allowed), input and output combined")
+        ("duration", po::value<double>(&duration)->default_value(0.1), "minimum time in seconds to run each measurement")
+        ("filter", po::value<std::string>(&filter)->default_value(""), "only run conversions whose ID contains this string, ex: sc16_item32_le")
+        ("format", po::value<std::string>(&format)->default_value("text"), "output format: text, csv, or json")
+        ("file", po::value<std::string>(&file)->default_value(""), "write the results to this file instead of stdout")
+        ("hot-set", po::value<std::string>(&hot_set)->default_value("0"), "size of a buffer to read back after every conversion, the time per cache line shows how much of it the converter evicted")
+        ("list", "list the registered conversions and priorities, then exit")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Convert Benchmark %s") % desc << std::endl;
+        std::cout
+            << "    Measures the throughput of every registered converter" << std::endl
+            << "    and priority for a range of buffer sizes." << std::endl
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (format != "text" and format != "csv" and format != "json"){
+        throw uhd::value_error("unknown output format: " + format);
+    }
+
+    const size_t hot_set_size = parse_size(hot_set);
+
+    std::vector<size_t> buff_sizes;
+    std::vector<std::string> size_strs;
+    boost::split(size_strs, sizes, boost::is_any_of(","));
+    BOOST_FOREACH(const std::string &size_str, size_strs){
+        buff_sizes.push_back(parse_size(size_str));
+    }
+
+    std::ofstream outfile;
+    if (not file.empty()){
+        outfile.open(file.c_str(), std::ofstream::out);
+        if (not outfile.is_open()) throw uhd::io_error("cannot open output file: " + file);
+    }
+    std::ostream &out = (file.empty())? std::cout : outfile;
+
+    //collect the conversions to run
+    std::vector<uhd::convert::id_type> ids;
+    BOOST_FOREACH(const uhd::convert::id_type &id, uhd::convert::get_converter_ids()){
+        if (id.to_string().find(filter) != std::string::npos) ids.push_back(id);
+    }
+
+    if (vm.count("list")){
+        BOOST_FOREACH(const uhd::convert::id_type &id, ids){
+            std::cout << id.to_string() << ":";
+            BOOST_FOREACH(const uhd::convert::priority_type prio, uhd::convert::get_converter_priorities(id)){
+                std::cout << " " << prio;
+            }
+            std::cout << std::endl;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (format == "text"){
+        out << boost::format("%-50s %5s %10s %10s %12s %10s %12s")
+            % "conversion" % "prio" % "bytes" % "nsamps" % "ns/sample" % "GB/s" % "hot ns/line" << std::endl;
+    }
+    else if (format == "csv"){
+        out << "input_format,num_inputs,output_format,num_outputs,prio,bytes,nsamps,ns_per_sample,gbytes_per_sec,hot_ns_per_line" << std::endl;
+    }
+    else if (format == "json"){
+        out << "[" << std::endl;
+    }
+
+    bool first = true;
+    BOOST_FOREACH(const uhd::convert::id_type &id, ids){
+        std::vector<uhd::convert::priority_type> prios = uhd::convert::get_converter_priorities(id);
+        std::sort(prios.begin(), prios.end());
+        BOOST_FOREACH(const uhd::convert::priority_type prio, prios){
+            BOOST_FOREACH(const size_t buff_size, buff_sizes){
+                benchmark_result r;
+                try{
+                    r = run_benchmark(id, prio, buff_size, duration, hot_set_size);
+                }
+                catch(const uhd::exception &){
+                    continue; //formats without a known item size cannot be benchmarked
+                }
+
+                if (format == "text"){
+                    out << boost::format("%-50s %5d %10d %10d %12.3f %10.3f %12.3f")
+                        % id.to_string() % prio % r.bytes % r.nsamps % r.ns_per_samp % r.gbytes_per_sec % r.hot_ns_per_line << std::endl;
+                }
+                else if (format == "csv"){
+                    out << boost::format("%s,%d,%s,%d,%d,%d,%d,%.4f,%.4f,%.4f")
+                        % id.input_format % id.num_inputs % id.output_format % id.num_outputs
+                        % prio % r.bytes % r.nsamps % r.ns_per_samp % r.gbytes_per_sec % r.hot_ns_per_line << std::endl;
+                }
+                else if (format == "json"){
+                    out << (first? "" : ",\n") << boost::format(
+                        "  {\"input_format\": \"%s\", \"num_inputs\": %d, \"output_format\": \"%s\", \"num_outputs\": %d, "
+                        "\"prio\": %d, \"bytes\": %d, \"nsamps\": %d, \"ns_per_sample\": %.4f, \"gbytes_per_sec\": %.4f, "
+                        "\"hot_ns_per_line\": %.4f}")
+                        % id.input_format % id.num_inputs % id.output_format % id.num_outputs
+                        % prio % r.bytes % r.nsamps % r.ns_per_samp % r.gbytes_per_sec % r.hot_ns_per_line;
+                }
+                first = false;
+            }
+        }
+    }
+
+    if (format == "json") out << std::endl << "]" << std::endl;
+
+    return EXIT_SUCCESS;
+}
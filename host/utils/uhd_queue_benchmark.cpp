@@ -0,0 +1,126 @@
+//
+// Copyright 2015 Ettus Research LLC
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+#include <uhd/utils/safe_main.hpp>
+#include <uhd/transport/bounded_buffer.hpp>
+#include <uhd/transport/spsc_bounded_buffer.hpp>
+#include <uhd/types/time_spec.hpp>
+#include <uhd/exception.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+namespace po = boost::program_options;
+using namespace uhd::transport;
+
+/***********************************************************************
+ * Throughput: one thread pushes, the other pops, both wait when the
+ * queue is full or empty, which is how the driver threads use them
+ **********************************************************************/
+template <typename queue_type> static void push_all(queue_type *queue, const size_t num_elems){
+    for (size_t i = 0; i < num_elems; i++) queue->push_with_wait(i);
+}
+
+template <typename queue_type> static double run_throughput(const size_t capacity, const size_t num_elems){
+    queue_type queue(capacity);
+    const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+    boost::thread producer(boost::bind(&push_all<queue_type>, &queue, num_elems));
+    size_t elem = 0;
+    for (size_t i = 0; i < num_elems; i++){
+        queue.pop_with_wait(elem);
+        if (elem != i) throw uhd::runtime_error("elements out of order");
+    }
+    producer.join();
+    return num_elems/(uhd::time_spec_t::get_system_time() - start).get_real_secs();
+}
+
+/***********************************************************************
+ * Latency: an element goes back and forth between two threads,
+ * every hand-off finds the queue empty and wakes up the other side
+ **********************************************************************/
+template <typename queue_type> static void echo_all(queue_type *ping, queue_type *pong, const size_t num_elems){
+    size_t elem = 0;
+    for (size_t i = 0; i < num_elems; i++){
+        ping->pop_with_wait(elem);
+        pong->push_with_wait(elem);
+    }
+}
+
+template <typename queue_type> static std::vector<double> run_latency(const size_t num_elems){
+    queue_type ping(1), pong(1);
+    boost::thread echo(boost::bind(&echo_all<queue_type>, &ping, &pong, num_elems));
+    std::vector<double> round_trips(num_elems);
+    size_t elem = 0;
+    for (size_t i = 0; i < num_elems; i++){
+        const uhd::time_spec_t start = uhd::time_spec_t::get_system_time();
+        ping.push_with_wait(i);
+        pong.pop_with_wait(elem);
+        round_trips[i] = (uhd::time_spec_t::get_system_time() - start).get_real_secs();
+    }
+    echo.join();
+    std::sort(round_trips.begin(), round_trips.end());
+    return round_trips;
+}
+
+template <typename queue_type> static void run_benchmark(
+    const std::string &name, const size_t capacity, const size_t num_elems
+){
+    const double rate = run_throughput<queue_type>(capacity, num_elems);
+    const std::vector<double> round_trips = run_latency<queue_type>(num_elems/100 + 1);
+    std::cout << boost::format("%-20s %8.2f Mitems/s   round trip: median %6.2f us, 99%% %6.2f us")
+        % name % (rate/1e6)
+        % (round_trips[round_trips.size()/2]*1e6)
+        % (round_trips[size_t(round_trips.size()*0.99)]*1e6)
+    << std::endl;
+}
+
+/***********************************************************************
+ * Main
+ **********************************************************************/
+int UHD_SAFE_MAIN(int argc, char *argv[]){
+    size_t capacity, num_elems;
+
+    po::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "help message")
+        ("capacity", po::value<size_t>(&capacity)->default_value(128), "number of elements that fit in the queue for the throughput test")
+        ("nelems", po::value<size_t>(&num_elems)->default_value(10000000), "number of elements to pass between the threads")
+    ;
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    //print the help message
+    if (vm.count("help")){
+        std::cout << boost::format("UHD Queue Benchmark %s") % desc << std::endl;
+        std::cout
+            << "    Compares the mutex based bounded_buffer with the lock-free" << std::endl
+            << "    spsc_bounded_buffer: the element rate between two threads," << std::endl
+            << "    and the round trip time of one element between two threads." << std::endl
+            << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    run_benchmark<bounded_buffer<size_t> >("bounded_buffer", capacity, num_elems);
+    run_benchmark<spsc_bounded_buffer<size_t> >("spsc_bounded_buffer", capacity, num_elems);
+
+    return EXIT_SUCCESS;
+}